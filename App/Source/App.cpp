@@ -2,6 +2,7 @@
 #include "Widgets/EncyclopediaWidget.h"
 #include "Widgets/Interpolation/ExponentialDecayWidget.h"
 #include "Widgets/Interpolation/SecondOrderDynamicsWidget.h"
+#include "Widgets/Solvers/ODEBenchmarkWidget.h"
 #include "Widgets/Solvers/ODEWidget.h"
 #include "Widgets/Solvers/RootFindingWidget.h"
 #include <chrono>
@@ -213,6 +214,10 @@ void App::OnMessage(const MessageType& message)
         {
             CreateUniqueWidget<ODEWidget>();
         }
+        else if (windowType == "ODEBenchmarks")
+        {
+            CreateUniqueWidget<ODEBenchmarkWidget>();
+        }
         else if (windowType == "RootFinding")
         {
             CreateUniqueWidget<RootFindingWidget>();
@@ -263,6 +268,9 @@ void App::MainMenu()
                 if (ImGui::MenuItem("Ordinary Differential Equations"))
                     SendMessage("OpenWindow OrdinaryDifferentialEquations");
 
+                if (ImGui::MenuItem("ODE Benchmarks"))
+                    SendMessage("OpenWindow ODEBenchmarks");
+
                 if (ImGui::MenuItem("Root Finding"))
                     SendMessage("OpenWindow RootFinding");
 
@@ -1,11 +1,72 @@
 #include "App.h"
 #include "MessageBus.h"
+#include "Widgets/Solvers/ODEConvergence.h"
 #include <memory>
+#include <stdio.h>
+#include <string.h>
+#include <string>
 
 
 
+// Runs the convergence suite without opening a window and writes convergence.json, convergence.csv and
+// work_precision.svg to the directory.  Given a baseline CSV from an earlier run, any regression against
+// it is printed and the exit code is 1.
+static int RunConvergence(const char* pDirectory, const char* pBaselineFileName)
+{
+    std::vector<ODESystem::ConvergenceSeries> series;
+    ODESystem::RunConvergenceSuite(ODESystem::ConvergenceSettings(), series);
+
+    printf("%-28s %-28s %8s %12s %12s %10s\n", "System", "Method", "Order", "Error", "ns/Step", "Evals/Step");
+    for (const ODESystem::ConvergenceSeries& methodSeries : series)
+    {
+        // the middle of the ladder, 1/120 s or a tolerance of 1e-4 by default
+        const ODESystem::ConvergenceRun& run = methodSeries.m_runs[methodSeries.m_runs.size() / 2];
+        printf("%-28s %-28s %8.2f %12.3e %12.1f %10.2f\n", methodSeries.m_systemName.c_str(), methodSeries.m_methodName.c_str(),
+            methodSeries.m_order, run.m_maxError, run.m_nanosecondsPerStep, run.m_evaluationsPerStep);
+    }
+
+    const std::string directory = pDirectory;
+    const bool isWritten = ODESystem::WriteConvergenceJson((directory + "/convergence.json").c_str(), series)
+        && ODESystem::WriteConvergenceCsv((directory + "/convergence.csv").c_str(), series)
+        && ODESystem::WriteWorkPrecisionSvg((directory + "/work_precision.svg").c_str(), series);
+    if (!isWritten)
+    {
+        fprintf(stderr, "Failed to write the results to %s\n", pDirectory);
+        return 1;
+    }
+
+    if (!pBaselineFileName)
+        return 0;
+
+    std::vector<ODESystem::ConvergenceSeries> baseline;
+    if (!ODESystem::ReadConvergenceCsv(pBaselineFileName, baseline))
+    {
+        fprintf(stderr, "Failed to read the baseline %s\n", pBaselineFileName);
+        return 1;
+    }
+
+    const std::vector<std::string> regressions = ODESystem::CompareConvergence(baseline, series, ODESystem::RegressionTolerances());
+    for (const std::string& regression : regressions)
+        printf("REGRESSION %s\n", regression.c_str());
+    printf("%zu regressions against %s\n", regressions.size(), pBaselineFileName);
+    return regressions.empty() ? 0 : 1;
+}
+
+
 int main(int argc, char* argv[])
 {
+    const char* pConvergenceDirectory = nullptr;
+    const char* pBaselineFileName = nullptr;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (strcmp(argv[i], "--convergence") == 0)
+            pConvergenceDirectory = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0)
+            pBaselineFileName = argv[++i];
+    }
+    if (pConvergenceDirectory)
+        return RunConvergence(pConvergenceDirectory, pBaselineFileName);
+
     // create message bus
     std::shared_ptr<MessageBus> pMessageBus = std::make_shared<MessageBus>();
 
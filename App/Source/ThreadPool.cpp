@@ -0,0 +1,147 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+	numThreads = std::max(numThreads, 1u);
+
+	m_queues.reserve(numThreads);
+	for (unsigned int i = 0; i < numThreads; ++i)
+		m_queues.push_back(std::make_unique<WorkQueue>());
+
+	m_threads.reserve(numThreads);
+	for (unsigned int i = 0; i < numThreads; ++i)
+		m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStopping = true;
+	}
+	m_workAvailable.notify_all();
+
+	for (std::thread& thread : m_threads)
+		thread.join();
+}
+
+
+void ThreadPool::ParallelFor(size_t count, const ParallelFunc& func, size_t grainSize)
+{
+	if (count == 0)
+		return;
+
+	std::lock_guard<std::mutex> runLock(m_runMutex);
+	m_pFunc = &func;
+	m_grainSize = std::max<size_t>(grainSize, 1);
+	m_numRemaining = count;
+
+	// deal out one contiguous range per worker, stealing evens out whatever imbalance is left
+	const size_t numThreads = m_threads.size();
+	for (size_t i = 0; i < numThreads; ++i)
+	{
+		const Range range = { count * i / numThreads, count * (i + 1) / numThreads };
+		if (range.m_begin < range.m_end)
+			PushRange(static_cast<unsigned int>(i), range);
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_workDone.wait(lock, [this]() { return m_numRemaining == 0; });
+	m_pFunc = nullptr;
+}
+
+
+void ThreadPool::WorkerLoop(unsigned int workerIndex)
+{
+	while (true)
+	{
+		Range range;
+		if (PopRange(workerIndex, range))
+		{
+			RunRange(workerIndex, range);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workAvailable.wait(lock, [this]() { return m_isStopping || m_numQueuedRanges > 0; });
+		if (m_isStopping)
+			return;
+	}
+}
+
+
+void ThreadPool::PushRange(unsigned int workerIndex, const Range& range)
+{
+	WorkQueue& queue = *m_queues[workerIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue.m_mutex);
+		queue.m_ranges.push_back(range);
+	}
+
+	// counted under the pool mutex so a worker can't miss the wake up between checking and waiting
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_numQueuedRanges;
+	}
+	m_workAvailable.notify_one();
+}
+
+
+bool ThreadPool::PopRange(unsigned int workerIndex, Range& range)
+{
+	// own queue from the back, which is the most recently split and so most likely still in cache
+	{
+		WorkQueue& queue = *m_queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.m_mutex);
+		if (!queue.m_ranges.empty())
+		{
+			range = queue.m_ranges.back();
+			queue.m_ranges.pop_back();
+			--m_numQueuedRanges;
+			return true;
+		}
+	}
+
+	// steal from the front of the other queues, which hold the largest ranges
+	const unsigned int numQueues = static_cast<unsigned int>(m_queues.size());
+	for (unsigned int offset = 1; offset < numQueues; ++offset)
+	{
+		WorkQueue& queue = *m_queues[(workerIndex + offset) % numQueues];
+		std::lock_guard<std::mutex> lock(queue.m_mutex);
+		if (!queue.m_ranges.empty())
+		{
+			range = queue.m_ranges.front();
+			queue.m_ranges.pop_front();
+			--m_numQueuedRanges;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void ThreadPool::RunRange(unsigned int workerIndex, Range range)
+{
+	// keep splitting off the upper half for others to steal until the range is down to the grain size
+	while (range.m_end - range.m_begin > m_grainSize)
+	{
+		const size_t middle = range.m_begin + (range.m_end - range.m_begin) / 2;
+		PushRange(workerIndex, { middle, range.m_end });
+		range.m_end = middle;
+	}
+
+	for (size_t index = range.m_begin; index < range.m_end; ++index)
+		(*m_pFunc)(index);
+
+	const size_t numCompleted = range.m_end - range.m_begin;
+	if (m_numRemaining.fetch_sub(numCompleted) == numCompleted)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_workDone.notify_all();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+
+// Work stealing pool for data parallel loops.  Each worker owns a queue of index ranges and works through
+// its own queue from the back, splitting large ranges in half as it goes so there's always something left
+// for others to take.  Workers that run dry steal from the front of another worker's queue, which holds the
+// largest ranges, so uneven work per index balances itself out without any tuning.
+class ThreadPool
+{
+public:
+	typedef std::function<void(size_t index)> ParallelFunc;
+
+	ThreadPool(unsigned int numThreads = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator = (const ThreadPool&) = delete;
+
+	// runs func for every index in [0, count) and returns once they have all finished, grainSize is the
+	// smallest range a worker will split off
+	void ParallelFor(size_t count, const ParallelFunc& func, size_t grainSize = 1);
+	unsigned int GetNumThreads() const { return static_cast<unsigned int>(m_threads.size()); }
+
+private:
+	struct Range
+	{
+		size_t m_begin = 0;
+		size_t m_end = 0;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex m_mutex;
+		std::deque<Range> m_ranges;
+	};
+
+	void WorkerLoop(unsigned int workerIndex);
+	void PushRange(unsigned int workerIndex, const Range& range);
+	bool PopRange(unsigned int workerIndex, Range& range);
+	void RunRange(unsigned int workerIndex, Range range);
+
+	std::vector<std::unique_ptr<WorkQueue>> m_queues;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_runMutex;				// one parallel loop at a time
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_workDone;
+	std::atomic<size_t> m_numQueuedRanges = 0;
+	std::atomic<size_t> m_numRemaining = 0;
+	const ParallelFunc* m_pFunc = nullptr;
+	size_t m_grainSize = 1;
+	bool m_isStopping = false;
+};
\ No newline at end of file
@@ -0,0 +1,2481 @@
+#include "Widgets/Solvers/ODEBenchmarkWidget.h"
+#include "Widgets/Solvers/ODECheckpoint.h"
+#include "Widgets/Solvers/ODENBody.h"
+#include "Widgets/Solvers/ODEParameterSweep.h"
+#include "Widgets/Solvers/ODESpringLattice.h"
+#include "Widgets/Solvers/ODESpringNetwork.h"
+#include "Widgets/Solvers/ODEStochastic.h"
+#include "Widgets/Solvers/ODETrajectoryCache.h"
+#include "Widgets/Solvers/ODETrajectoryFile.h"
+#include "Widgets/Solvers/ODEWidget.h"
+#include "Functions/Random.h"
+#include "Functions/VectorMath.h"
+#include "Solvers/ODEParareal.h"
+#include "Solvers/XPBD.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <imgui.h>
+#include <limits>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+
+
+namespace
+{
+	typedef ODEBenchmarkWidget::ResultTable ResultTable;
+
+
+	template<typename Func>
+	double MeasureSeconds(const Func& func)
+	{
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+
+	std::string Format(const char* format, double value)
+	{
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), format, value);
+		return buffer;
+	}
+
+
+	void BatchedSpringMassBenchmark(ResultTable& results)
+	{
+		constexpr size_t numSystems = 50000;
+		constexpr unsigned int numSteps = 60;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+
+		typedef void(*SystemMethod)(ODE::IState<float, 2>&, float);
+		typedef void(*BatchMethod)(ODEBatch::IState<float, 2>&, float);
+
+		struct Method
+		{
+			const char* m_name;
+			SystemMethod m_systemMethod;
+			BatchMethod m_batchMethod;
+		};
+
+		const Method methods[] = {
+			{ "Explicit Euler", ODE::ExplicitEuler<float, 2>, ODEBatch::ExplicitEuler<float, 2> },
+			{ "Explicit Midpoint", ODE::ExplicitMidpoint<float, 2>, ODEBatch::ExplicitMidpoint<float, 2> },
+			{ "Explicit RK4", ODE::ExplicitRK4<float, 2>, ODEBatch::ExplicitRK4<float, 2> },
+			{ "Semi-Implicit Euler", ODE::SemiImplicitEuler<float, 2>, ODEBatch::SemiImplicitEuler<float, 2> },
+			{ "Velocity Verlet", ODE::VelocityVerlet<float>, ODEBatch::VelocityVerlet<float> },
+			{ "Ruth 4", ODE::Ruth4<float>, ODEBatch::Ruth4<float> } };
+
+		results.m_columns = { "Method", "Per System (ns/step)", "Batched (ns/step)", "Speedup", "Max Difference" };
+
+		std::vector<ODESystem::SingleSpringMassSystem> systems(numSystems);
+		ODESystem::SingleSpringMassBatch batch;
+
+		for (const Method& method : methods)
+		{
+			for (ODESystem::SingleSpringMassSystem& system : systems)
+				system.Reset(springConstant, damping);
+
+			const double systemTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					for (ODESystem::SingleSpringMassSystem& system : systems)
+						method.m_systemMethod(system, stepSize);
+			});
+
+			batch.Reset(numSystems, springConstant, damping);
+			const double batchTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					method.m_batchMethod(batch, stepSize);
+			});
+
+			float maxDifference = 0.0f;
+			const float* batchPositions = batch.GetDerivatives((int)ODESystem::EStateDerivative::Position);
+			for (size_t i = 0; i < numSystems; ++i)
+				maxDifference = std::max(maxDifference, fabsf(batchPositions[i] - systems[i].m_massPos));
+
+			const double numSystemSteps = static_cast<double>(numSystems) * numSteps;
+			results.AddRow({
+				method.m_name,
+				Format("%.2f", 1.0e9 * systemTime / numSystemSteps),
+				Format("%.2f", 1.0e9 * batchTime / numSystemSteps),
+				Format("%.1fx", systemTime / batchTime),
+				Format("%.2e", maxDifference) });
+		}
+	}
+
+
+	void AdaptiveStepSizeBenchmark(ResultTable& results)
+	{
+		constexpr float springConstant = 1000.0f;
+		constexpr float damping = 0.1f;
+		constexpr float duration = 10.0f;
+		constexpr float sampleStepSize = 1.0f / 60.0f;
+		const unsigned int numSamples = static_cast<unsigned int>(duration / sampleStepSize);
+
+		std::vector<float> timeData;
+		for (unsigned int i = 0; i <= numSamples; ++i)
+			timeData.push_back(i * sampleStepSize);
+
+		ODESystem::SingleSpringMassSystem system;
+		system.Reset(springConstant, damping);
+
+		std::vector<float> analyticalData;
+		system.SolveAnalytical(timeData, analyticalData);
+
+		// advances the system one sample interval at a time and records the worst error against the analytical solution
+		const auto run = [&](const std::function<void(ODESystem::SingleSpringMassSystem&)>& advance, float& maxError) -> double
+		{
+			system.Reset(springConstant, damping);
+			maxError = 0.0f;
+			return MeasureSeconds([&]()
+			{
+				for (unsigned int i = 0; i <= numSamples; ++i)
+				{
+					maxError = std::max(maxError, fabsf(system.m_massPos - analyticalData[i]));
+					advance(system);
+				}
+			});
+		};
+
+		results.m_columns = { "Method", "Setting", "RHS Evaluations", "Rejected Steps", "Max Error", "Time (us)" };
+
+		for (unsigned int numSubSteps : { 1, 2, 4, 8, 16 })
+		{
+			const float stepSize = sampleStepSize / numSubSteps;
+			float maxError = 0.0f;
+			const double time = run([stepSize, numSubSteps](ODESystem::SingleSpringMassSystem& system)
+			{
+				for (unsigned int i = 0; i < numSubSteps; ++i)
+					ODE::ExplicitRK4<float, 2>(system, stepSize);
+			}, maxError);
+
+			results.AddRow({ "Explicit RK4", Format("h = %.2e", stepSize), Format("%.0f", 4.0 * numSubSteps * (numSamples + 1)), "-", Format("%.2e", maxError), Format("%.0f", 1.0e6 * time) });
+		}
+
+		const auto addAdaptiveRows = [&](const char* name, auto integrator)
+		{
+			for (float tolerance : { 1.0e-3f, 1.0e-4f, 1.0e-5f, 1.0e-6f })
+			{
+				ODE::AdaptiveSettings settings;
+				settings.m_absTolerance = tolerance;
+				settings.m_relTolerance = tolerance;
+				integrator = decltype(integrator)(settings);
+
+				float maxError = 0.0f;
+				const double time = run([&integrator](ODESystem::SingleSpringMassSystem& system) { integrator.Integrate(system, sampleStepSize); }, maxError);
+
+				const ODE::AdaptiveStats& stats = integrator.GetStats();
+				results.AddRow({ name, Format("tol = %.0e", tolerance), Format("%.0f", stats.m_numEvaluations), Format("%.0f", stats.m_numRejectedSteps), Format("%.2e", maxError), Format("%.0f", 1.0e6 * time) });
+			}
+		};
+
+		addAdaptiveRows("Bogacki-Shampine 3(2)", ODE::AdaptiveRungeKutta<ODE::BogackiShampine32, float, 2>());
+		addAdaptiveRows("Dormand-Prince 5(4)", ODE::AdaptiveRungeKutta<ODE::DormandPrince54, float, 2>());
+	}
+
+
+	void ImplicitStiffBenchmark(ResultTable& results)
+	{
+		// heavy damping splits each mode into slow and fast decaying parts over 1000x apart
+		typedef ODESystem::StateData<float, 2> StateData;
+		constexpr float springConstant = 1000.0f;
+		constexpr float damping = 2000.0f;
+		constexpr float duration = 10.0f;
+		constexpr float sampleStepSize = 0.1f;
+		const unsigned int numSamples = static_cast<unsigned int>(duration / sampleStepSize);
+
+		// reference trajectory from RK4 at a tiny step size
+		constexpr unsigned int numReferenceSubSteps = 4000;
+		ODESystem::CoupledSpringMassSystem system;
+		system.Reset(springConstant, damping);
+		std::vector<std::array<float, 2>> referenceData;
+		for (unsigned int i = 0; i <= numSamples; ++i)
+		{
+			referenceData.push_back({ system.m_massPos[0], system.m_massPos[1] });
+			for (unsigned int j = 0; j < numReferenceSubSteps; ++j)
+				ODE::ExplicitRK4<StateData, 2>(system, sampleStepSize / numReferenceSubSteps);
+		}
+
+		results.m_columns = { "Method", "Step Size", "RHS Evaluations", "Jacobian Updates", "Max Error", "Time (us)" };
+
+		const auto addRow = [&](const char* name, unsigned int numSubSteps, auto step, auto getStats)
+		{
+			const float stepSize = sampleStepSize / numSubSteps;
+			system.Reset(springConstant, damping);
+
+			float maxError = 0.0f;
+			const double time = MeasureSeconds([&]()
+			{
+				for (unsigned int i = 0; i <= numSamples; ++i)
+				{
+					maxError = std::max(maxError, std::max(fabsf(system.m_massPos[0] - referenceData[i][0]), fabsf(system.m_massPos[1] - referenceData[i][1])));
+					for (unsigned int j = 0; j < numSubSteps; ++j)
+						step(system, stepSize);
+				}
+			});
+
+			const ODE::ImplicitStats stats = getStats();
+			results.AddRow({ name, Format("%.2e", stepSize), Format("%.0f", stats.m_numEvaluations), Format("%.0f", stats.m_numJacobianUpdates),
+				isfinite(maxError) ? Format("%.2e", maxError) : "unstable", Format("%.0f", 1.0e6 * time) });
+		};
+
+		const auto addImplicitRows = [&](const char* name, auto integrator)
+		{
+			for (unsigned int numSubSteps : { 1, 4, 16, 64 })
+			{
+				decltype(integrator) stepper;
+				addRow(name, numSubSteps, [&stepper](ODESystem::CoupledSpringMassSystem& system, float stepSize) { stepper.Step(system, stepSize); }, [&stepper]() { return stepper.GetStats(); });
+			}
+		};
+
+		for (unsigned int numSubSteps : { 64, 128, 256, 512 })
+		{
+			const unsigned int numEvaluations = 4 * numSubSteps * (numSamples + 1);
+			addRow("Explicit RK4", numSubSteps, ODE::ExplicitRK4<StateData, 2>, [numEvaluations]()
+			{
+				ODE::ImplicitStats stats;
+				stats.m_numEvaluations = numEvaluations;
+				return stats;
+			});
+		}
+
+		addImplicitRows("Backward Euler", ODE::BackwardEuler<StateData, 2>());
+		addImplicitRows("Implicit Midpoint", ODE::ImplicitMidpoint<StateData, 2>());
+		addImplicitRows("Trapezoidal", ODE::Trapezoidal<StateData, 2>());
+		addImplicitRows("BDF 4", ODE::BDF<StateData, 2>());
+	}
+
+
+	// both paths are called through function pointers so the only difference is how each method reaches the derivative function
+	template<typename System, typename T>
+	void AddDispatchRows(ResultTable& results, const char* systemName)
+	{
+		constexpr size_t numSystems = 10000;
+		constexpr unsigned int numSteps = 100;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+
+		typedef void(*VirtualMethod)(ODE::IState<T, 2>&, float);
+		typedef void(*StaticMethod)(System&, float);
+
+		struct Method
+		{
+			const char* m_name;
+			VirtualMethod m_virtualMethod;
+			StaticMethod m_staticMethod;
+		};
+
+		const Method methods[] = {
+			{ "Explicit Euler", ODE::ExplicitEuler<T, 2>, ODE::ExplicitEuler<T, 2, System> },
+			{ "Explicit Midpoint", ODE::ExplicitMidpoint<T, 2>, ODE::ExplicitMidpoint<T, 2, System> },
+			{ "Explicit RK4", ODE::ExplicitRK4<T, 2>, ODE::ExplicitRK4<T, 2, System> },
+			{ "Semi-Implicit Euler", ODE::SemiImplicitEuler<T, 2>, ODE::SemiImplicitEuler<T, 2, System> },
+			{ "Velocity Verlet", ODE::VelocityVerlet<T>, ODE::VelocityVerlet<T, System> },
+			{ "Ruth 4", ODE::Ruth4<T>, ODE::Ruth4<T, System> } };
+
+		std::vector<System> virtualSystems(numSystems);
+		std::vector<System> staticSystems(numSystems);
+
+		for (const Method& method : methods)
+		{
+			for (System& system : virtualSystems)
+				system.Reset(springConstant, damping);
+			for (System& system : staticSystems)
+				system.Reset(springConstant, damping);
+
+			const double virtualTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					for (System& system : virtualSystems)
+						method.m_virtualMethod(system, stepSize);
+			});
+
+			const double staticTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					for (System& system : staticSystems)
+						method.m_staticMethod(system, stepSize);
+			});
+
+			using ODE::GetNumComponents;
+			using ODE::GetComponent;
+			float maxDifference = 0.0f;
+			for (size_t i = 0; i < numSystems; ++i)
+			{
+				std::array<T, 2> virtualDerivatives;
+				std::array<T, 2> staticDerivatives;
+				virtualSystems[i].GetDerivatives(virtualDerivatives);
+				staticSystems[i].GetDerivatives(staticDerivatives);
+				for (unsigned int j = 0; j < 2; ++j)
+					for (unsigned int k = 0; k < GetNumComponents(virtualDerivatives[j]); ++k)
+						maxDifference = std::max(maxDifference, fabsf(GetComponent(virtualDerivatives[j], k) - GetComponent(staticDerivatives[j], k)));
+			}
+
+			const double numSystemSteps = static_cast<double>(numSystems) * numSteps;
+			results.AddRow({
+				systemName,
+				method.m_name,
+				Format("%.2f", 1.0e9 * virtualTime / numSystemSteps),
+				Format("%.2f", 1.0e9 * staticTime / numSystemSteps),
+				Format("%.1fx", virtualTime / staticTime),
+				Format("%.2e", maxDifference) });
+		}
+	}
+
+
+	// steps every system with the given method and returns the time taken
+	template<typename System, typename Method>
+	double StepSystems(std::vector<System>& systems, const Method& method, unsigned int numSteps, float stepSize)
+	{
+		return MeasureSeconds([&]()
+		{
+			for (unsigned int step = 0; step < numSteps; ++step)
+				for (System& system : systems)
+					method(system, stepSize);
+		});
+	}
+
+
+	template<typename System>
+	bool IsBitwiseEqual(const std::vector<System>& systems0, const std::vector<System>& systems1)
+	{
+		for (size_t i = 0; i < systems0.size(); ++i)
+		{
+			if (memcmp(&systems0[i].m_massPos, &systems1[i].m_massPos, sizeof(systems0[i].m_massPos)) != 0
+				|| memcmp(&systems0[i].m_massSpeed, &systems1[i].m_massSpeed, sizeof(systems0[i].m_massSpeed)) != 0)
+				return false;
+		}
+		return true;
+	}
+
+
+	// The same systems stepped by RK4 and by their transition matrix, one at a time and as a batch.  The error
+	// is the first mass against the analytical solution at the end, which the matrix should only miss by
+	// float rounding.
+	template<typename System, typename T, typename Batch, typename GetPosition, typename SolveAnalytical>
+	void AddTransitionMatrixRows(ResultTable& results, const char* systemName, const GetPosition& getPosition, const SolveAnalytical& solveAnalytical)
+	{
+		constexpr size_t numSystems = 10000;
+		constexpr unsigned int numSteps = 600;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+
+		System analyticalSystem;
+		analyticalSystem.Reset(springConstant, damping);
+		const float analyticalPosition = solveAnalytical(analyticalSystem, numSteps * stepSize);
+
+		std::vector<System> systems(numSystems);
+		const auto addRow = [&](const char* methodName, double time, float position)
+		{
+			results.AddRow({
+				systemName,
+				methodName,
+				Format("%.2f", 1.0e9 * time / (static_cast<double>(numSystems) * numSteps)),
+				Format("%.2e", fabsf(position - analyticalPosition)) });
+		};
+
+		for (System& system : systems)
+			system.Reset(springConstant, damping);
+		const double rk4Time = StepSystems(systems, ODE::ExplicitRK4<T, 2, System>, numSteps, stepSize);
+		addRow("Explicit RK4", rk4Time, getPosition(systems[0]));
+
+		// every system owns its matrix like the implicit methods own their newton solvers
+		std::vector<ODE::TransitionMatrix<T, 2>> transitionMatrices(numSystems);
+		for (System& system : systems)
+			system.Reset(springConstant, damping);
+		const double transitionTime = MeasureSeconds([&]()
+		{
+			for (unsigned int step = 0; step < numSteps; ++step)
+				for (size_t i = 0; i < numSystems; ++i)
+					transitionMatrices[i].Step(systems[i], stepSize);
+		});
+		addRow("Transition Matrix", transitionTime, getPosition(systems[0]));
+
+		Batch batch;
+		batch.Reset(numSystems, springConstant, damping);
+		const double batchRK4Time = MeasureSeconds([&]()
+		{
+			for (unsigned int step = 0; step < numSteps; ++step)
+				ODEBatch::ExplicitRK4<float, 2>(batch, stepSize);
+		});
+		addRow("Batched RK4", batchRK4Time, batch.GetDerivatives((int)ODESystem::EStateDerivative::Position)[0]);
+
+		// the batch shares one matrix, the time includes building it
+		batch.Reset(numSystems, springConstant, damping);
+		const double batchTransitionTime = MeasureSeconds([&]()
+		{
+			ODE::TransitionMatrix<T, 2> transitionMatrix;
+			std::array<T, 2> derivatives;
+			analyticalSystem.GetDerivatives(derivatives);
+			transitionMatrix.Update(analyticalSystem, derivatives, stepSize);
+
+			const unsigned int numComponents = transitionMatrix.GetSize() / 2;
+			for (unsigned int step = 0; step < numSteps; ++step)
+				ODEBatch::TransitionMatrixStep<float, 2>(batch, transitionMatrix.GetMatrix().data(), numComponents);
+		});
+		addRow("Batched Transition Matrix", batchTransitionTime, batch.GetDerivatives((int)ODESystem::EStateDerivative::Position)[0]);
+	}
+
+
+	void TableauEngineBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::SingleSpringMassSystem SingleSystem;
+		typedef ODESystem::CoupledSpringMassSystem CoupledSystem;
+		typedef ODESystem::StateData<float, 2> StateData;
+		typedef void(*SingleMethod)(SingleSystem&, float);
+		typedef void(*CoupledMethod)(CoupledSystem&, float);
+
+		constexpr size_t numSystems = 10000;
+		constexpr unsigned int numSteps = 100;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+		constexpr float errorDuration = 10.0f;
+
+		struct Method
+		{
+			const char* m_name;
+			SingleMethod m_tableauSingle;
+			CoupledMethod m_tableauCoupled;
+			SingleMethod m_handWrittenSingle;
+			CoupledMethod m_handWrittenCoupled;
+		};
+
+		const Method methods[] = {
+			{ "Explicit Euler", ODE::ExplicitRungeKutta<ODE::Euler1, float, 2, SingleSystem>, ODE::ExplicitRungeKutta<ODE::Euler1, StateData, 2, CoupledSystem>,
+				ODE::ExplicitEuler<float, 2, SingleSystem>, ODE::ExplicitEuler<StateData, 2, CoupledSystem> },
+			{ "Explicit Midpoint", ODE::ExplicitRungeKutta<ODE::Midpoint2, float, 2, SingleSystem>, ODE::ExplicitRungeKutta<ODE::Midpoint2, StateData, 2, CoupledSystem>,
+				ODE::ExplicitMidpoint<float, 2, SingleSystem>, ODE::ExplicitMidpoint<StateData, 2, CoupledSystem> },
+			{ "Explicit RK4", ODE::ExplicitRungeKutta<ODE::ClassicRK4, float, 2, SingleSystem>, ODE::ExplicitRungeKutta<ODE::ClassicRK4, StateData, 2, CoupledSystem>,
+				ODE::ExplicitRK4<float, 2, SingleSystem>, ODE::ExplicitRK4<StateData, 2, CoupledSystem> },
+			{ "Kutta 3", ODE::ExplicitRungeKutta<ODE::Kutta3, float, 2, SingleSystem>, ODE::ExplicitRungeKutta<ODE::Kutta3, StateData, 2, CoupledSystem>, nullptr, nullptr },
+			{ "SSP RK3", ODE::ExplicitRungeKutta<ODE::SSPRK3, float, 2, SingleSystem>, ODE::ExplicitRungeKutta<ODE::SSPRK3, StateData, 2, CoupledSystem>, nullptr, nullptr },
+			{ "RK4 3/8 Rule", ODE::ExplicitRungeKutta<ODE::ThreeEighthsRK4, float, 2, SingleSystem>, ODE::ExplicitRungeKutta<ODE::ThreeEighthsRK4, StateData, 2, CoupledSystem>, nullptr, nullptr },
+			{ "Dormand-Prince 5", ODE::ExplicitRungeKutta<ODE::DormandPrince5, float, 2, SingleSystem>, ODE::ExplicitRungeKutta<ODE::DormandPrince5, StateData, 2, CoupledSystem>, nullptr, nullptr },
+			{ "Runge-Kutta-Nystrom 4", ODE::RungeKuttaNystrom<ODE::Nystrom4, float, SingleSystem>, ODE::RungeKuttaNystrom<ODE::Nystrom4, StateData, CoupledSystem>, nullptr, nullptr } };
+
+		results.m_columns = { "Method", "Tableau Single (ns/step)", "Hand Written Single (ns/step)", "Tableau Coupled (ns/step)", "Hand Written Coupled (ns/step)", "Bitwise Match", "Max Error" };
+
+		// error against the single spring analytical solution
+		const unsigned int numErrorSamples = static_cast<unsigned int>(errorDuration / stepSize);
+		std::vector<float> timeData;
+		for (unsigned int i = 0; i <= numErrorSamples; ++i)
+			timeData.push_back(i * stepSize);
+
+		SingleSystem errorSystem;
+		errorSystem.Reset(springConstant, damping);
+		std::vector<float> analyticalData;
+		errorSystem.SolveAnalytical(timeData, analyticalData);
+
+		std::vector<SingleSystem> singleSystems(numSystems);
+		std::vector<SingleSystem> handWrittenSingleSystems(numSystems);
+		std::vector<CoupledSystem> coupledSystems(numSystems);
+		std::vector<CoupledSystem> handWrittenCoupledSystems(numSystems);
+
+		for (const Method& method : methods)
+		{
+			const auto reset = [](auto& systems)
+			{
+				for (auto& system : systems)
+					system.Reset(springConstant, damping);
+			};
+
+			reset(singleSystems);
+			reset(coupledSystems);
+			const double singleTime = StepSystems(singleSystems, method.m_tableauSingle, numSteps, stepSize);
+			const double coupledTime = StepSystems(coupledSystems, method.m_tableauCoupled, numSteps, stepSize);
+
+			std::string handWrittenSingle = "-";
+			std::string handWrittenCoupled = "-";
+			std::string bitwiseMatch = "-";
+			if (method.m_handWrittenSingle)
+			{
+				reset(handWrittenSingleSystems);
+				reset(handWrittenCoupledSystems);
+				handWrittenSingle = Format("%.2f", 1.0e9 * StepSystems(handWrittenSingleSystems, method.m_handWrittenSingle, numSteps, stepSize) / (numSystems * numSteps));
+				handWrittenCoupled = Format("%.2f", 1.0e9 * StepSystems(handWrittenCoupledSystems, method.m_handWrittenCoupled, numSteps, stepSize) / (numSystems * numSteps));
+				bitwiseMatch = (IsBitwiseEqual(singleSystems, handWrittenSingleSystems) && IsBitwiseEqual(coupledSystems, handWrittenCoupledSystems)) ? "Yes" : "No";
+			}
+
+			errorSystem.Reset(springConstant, damping);
+			float maxError = 0.0f;
+			for (unsigned int i = 0; i <= numErrorSamples; ++i)
+			{
+				maxError = std::max(maxError, fabsf(errorSystem.m_massPos - analyticalData[i]));
+				method.m_tableauSingle(errorSystem, stepSize);
+			}
+
+			results.AddRow({
+				method.m_name,
+				Format("%.2f", 1.0e9 * singleTime / (numSystems * numSteps)),
+				handWrittenSingle,
+				Format("%.2f", 1.0e9 * coupledTime / (numSystems * numSteps)),
+				handWrittenCoupled,
+				bitwiseMatch,
+				Format("%.2e", maxError) });
+		}
+	}
+
+
+	void DenseOutputBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::SingleSpringMassSystem System;
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+		constexpr float duration = 10.0f;
+		constexpr float frameStepSize = 1.0f / 60.0f;
+		constexpr float sampleStepSize = 1.0f / 1200.0f;
+		constexpr unsigned int numSubSteps = 20;
+		const unsigned int numFrames = static_cast<unsigned int>(duration / frameStepSize);
+		const unsigned int numSamples = numFrames * numSubSteps;
+
+		std::vector<float> timeData;
+		for (unsigned int i = 0; i <= numSamples; ++i)
+			timeData.push_back(i * sampleStepSize);
+
+		System system;
+		system.Reset(springConstant, damping);
+		std::vector<float> analyticalData;
+		system.SolveAnalytical(timeData, analyticalData);
+
+		results.m_columns = { "Method", "RHS Evaluations", "Integrate (us)", "Resample (us)", "Max Error" };
+
+		const auto addRow = [&](const char* name, unsigned int numEvaluations, double integrateTime, double resampleTime, const std::vector<float>& positions)
+		{
+			float maxError = 0.0f;
+			for (unsigned int i = 0; i <= numSamples; ++i)
+				maxError = std::max(maxError, fabsf(positions[i] - analyticalData[i]));
+			results.AddRow({ name, Format("%.0f", numEvaluations), Format("%.0f", 1.0e6 * integrateTime), resampleTime > 0.0 ? Format("%.0f", 1.0e6 * resampleTime) : "-", Format("%.2e", maxError) });
+		};
+
+		const auto resample = [&](const ODE::DenseOutput<float, 2>& denseOutput, std::vector<float>& positions)
+		{
+			return MeasureSeconds([&]()
+			{
+				size_t hint = 0;
+				ODESystem::FixedSpringDerivatives derivatives;
+				for (float time : timeData)
+				{
+					denseOutput.Evaluate(time, derivatives, hint);
+					positions.push_back(derivatives[(int)ODESystem::EStateDerivative::Position]);
+				}
+			});
+		};
+
+		// re-running the solver at the sample rate is the cost dense output avoids
+		{
+			std::vector<float> positions;
+			system.Reset(springConstant, damping);
+			const double integrateTime = MeasureSeconds([&]()
+			{
+				for (unsigned int i = 0; i <= numSamples; ++i)
+				{
+					positions.push_back(system.m_massPos);
+					ODE::ExplicitRungeKutta<ODE::ClassicRK4, float, 2>(system, sampleStepSize);
+				}
+			});
+			addRow("RK4 at 1200 Hz", 4 * (numSamples + 1), integrateTime, 0.0, positions);
+		}
+
+		{
+			std::vector<float> positions;
+			ODE::DenseOutput<float, 2> denseOutput;
+			system.Reset(springConstant, damping);
+			const double integrateTime = MeasureSeconds([&]()
+			{
+				for (unsigned int i = 0; i <= numFrames; ++i)
+					ODE::ExplicitRungeKuttaDense<ODE::ClassicRK4, float, 2>(system, frameStepSize, denseOutput, i * frameStepSize);
+			});
+			addRow("RK4 at 60 Hz + Hermite", 4 * (numFrames + 1), integrateTime, resample(denseOutput, positions), positions);
+		}
+
+		for (float tolerance : { 1.0e-4f, 1.0e-6f })
+		{
+			std::vector<float> positions;
+			ODE::DenseOutput<float, 2> denseOutput;
+			ODE::AdaptiveSettings settings;
+			settings.m_absTolerance = tolerance;
+			settings.m_relTolerance = tolerance;
+			ODE::AdaptiveRungeKutta<ODE::DormandPrince54, float, 2> integrator(settings);
+			system.Reset(springConstant, damping);
+			const double integrateTime = MeasureSeconds([&]() { integrator.Integrate(system, duration, &denseOutput); });
+
+			const std::string name = Format("Dormand-Prince 5(4) tol = %.0e + Hermite", tolerance);
+			addRow(name.c_str(), integrator.GetStats().m_numEvaluations, integrateTime, resample(denseOutput, positions), positions);
+		}
+	}
+
+
+	// steps the state from the analytical start and compares every step against the double precision solution
+	template<typename T, typename State, typename Method>
+	void AddPrecisionRow(ResultTable& results, const char* methodName, const char* precisionName, State& state, const Method& method,
+		const std::vector<double>& analyticalData, T stepSize)
+	{
+		const unsigned int numSteps = static_cast<unsigned int>(analyticalData.size()) - 1;
+		std::vector<T> positions(numSteps + 1);
+		std::array<T, 2> derivatives;
+
+		const double time = MeasureSeconds([&]()
+		{
+			for (unsigned int i = 0; i < numSteps; ++i)
+			{
+				state.GetDerivatives(derivatives);
+				positions[i] = derivatives[(int)ODESystem::EStateDerivative::Position];
+				method(state, stepSize);
+			}
+			state.GetDerivatives(derivatives);
+			positions[numSteps] = derivatives[(int)ODESystem::EStateDerivative::Position];
+		});
+
+		double maxError = 0.0;
+		for (unsigned int i = 0; i <= numSteps; ++i)
+			maxError = std::max(maxError, fabs(static_cast<double>(positions[i]) - analyticalData[i]));
+		const double finalError = fabs(static_cast<double>(positions[numSteps]) - analyticalData[numSteps]);
+
+		results.AddRow({ methodName, precisionName, Format("%.2f", 1.0e9 * time / numSteps), Format("%.2e", maxError), Format("%.2e", finalError) });
+	}
+
+
+	void MixedPrecisionBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::SingleSpringMassSystem FloatSystem;
+		typedef ODESystem::SingleSpringMassSystemDouble DoubleSystem;
+		typedef ODE::MixedPrecisionState<double, float, 2, FloatSystem> MixedSystem;
+		constexpr double springConstant = 1.0;
+		constexpr double damping = 0.0;
+		constexpr double duration = 600.0;
+		constexpr double stepSize = 1.0 / 60.0;
+		const unsigned int numSteps = static_cast<unsigned int>(duration / stepSize + 0.5);
+
+		std::vector<double> timeData;
+		for (unsigned int i = 0; i <= numSteps; ++i)
+			timeData.push_back(i * stepSize);
+
+		DoubleSystem doubleSystem;
+		doubleSystem.Reset(springConstant, damping);
+		std::vector<double> analyticalData;
+		doubleSystem.SolveAnalytical(timeData, analyticalData);
+
+		results.m_columns = { "Method", "State / Forces", "ns/step", "Max Error", "Final Error" };
+
+		const auto addRows = [&](const char* methodName, const auto& floatMethod, const auto& mixedMethod, const auto& doubleMethod)
+		{
+			FloatSystem floatSystem;
+			floatSystem.Reset(static_cast<float>(springConstant), static_cast<float>(damping));
+			AddPrecisionRow<float>(results, methodName, "float / float", floatSystem, floatMethod, analyticalData, static_cast<float>(stepSize));
+
+			floatSystem.Reset(static_cast<float>(springConstant), static_cast<float>(damping));
+			MixedSystem mixedSystem(floatSystem);
+			AddPrecisionRow<double>(results, methodName, "double / float", mixedSystem, mixedMethod, analyticalData, stepSize);
+
+			doubleSystem.Reset(springConstant, damping);
+			AddPrecisionRow<double>(results, methodName, "double / double", doubleSystem, doubleMethod, analyticalData, stepSize);
+		};
+
+		addRows("Explicit RK4",
+			ODE::ExplicitRungeKutta<ODE::ClassicRK4, float, 2, FloatSystem>,
+			ODE::ExplicitRungeKutta<ODE::ClassicRK4, double, 2, MixedSystem>,
+			ODE::ExplicitRungeKutta<ODE::ClassicRK4, double, 2, DoubleSystem>);
+		addRows("Ruth 4",
+			ODE::Ruth4<float, FloatSystem>,
+			ODE::Ruth4<double, MixedSystem>,
+			ODE::Ruth4<double, DoubleSystem>);
+	}
+
+	// spring constants spread logarithmically and dampings kept under critical for the softest spring so
+	// every cell has an analytical solution
+	ODESystem::SweepGrid MakeSweepGrid()
+	{
+		constexpr unsigned int numSpringConstants = 100;
+		constexpr unsigned int numDampings = 100;
+
+		ODESystem::SweepGrid grid;
+		for (unsigned int i = 0; i < numSpringConstants; ++i)
+			grid.m_springConstants.push_back(powf(100.0f, i / (numSpringConstants - 1.0f)));
+		for (unsigned int i = 0; i < numDampings; ++i)
+			grid.m_dampings.push_back(1.9f * i / (numDampings - 1.0f));
+		grid.m_stepSizes = { 1.0f / 60.0f };
+		grid.m_methods = {
+			{ "Explicit Euler", ODE::ExplicitEuler<float, 2> },
+			{ "Explicit Midpoint", ODE::ExplicitMidpoint<float, 2> },
+			{ "Explicit RK4", ODE::ExplicitRK4<float, 2> },
+			{ "Semi-Implicit Euler", ODE::SemiImplicitEuler<float, 2> },
+			{ "Velocity Verlet", ODE::VelocityVerlet<float> },
+			{ "Ruth 4", ODE::Ruth4<float> } };
+		grid.m_duration = 10.0f;
+		return grid;
+	}
+
+
+	void ParameterSweepScalingBenchmark(ResultTable& results)
+	{
+		const ODESystem::SweepGrid grid = MakeSweepGrid();
+		std::vector<ODESystem::SweepCell> cells;
+
+		std::vector<unsigned int> threadCounts;
+		const unsigned int maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		for (unsigned int numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+			threadCounts.push_back(numThreads);
+		threadCounts.push_back(maxThreads);
+
+		results.m_columns = { "Threads", "Cells", "Wall Time (s)", "Speedup", "Efficiency", "Cell Time (us)" };
+
+		double serialTime = 0.0;
+		for (unsigned int numThreads : threadCounts)
+		{
+			ThreadPool threadPool(numThreads);
+			const double time = MeasureSeconds([&]() { ODESystem::RunParameterSweep(grid, threadPool, cells); });
+			if (numThreads == 1)
+				serialTime = time;
+
+			double cellTime = 0.0;
+			for (const ODESystem::SweepCell& cell : cells)
+				cellTime += cell.m_seconds;
+
+			const double speedup = serialTime / time;
+			results.AddRow({
+				Format("%.0f", numThreads),
+				Format("%.0f", static_cast<double>(cells.size())),
+				Format("%.3f", time),
+				Format("%.2fx", speedup),
+				Format("%.0f%%", 100.0 * speedup / numThreads),
+				Format("%.1f", 1.0e6 * cellTime / cells.size()) });
+		}
+	}
+
+
+	void ParameterSweepErrorBenchmark(ResultTable& results)
+	{
+		const ODESystem::SweepGrid grid = MakeSweepGrid();
+		std::vector<ODESystem::SweepCell> cells;
+		ThreadPool threadPool;
+		ODESystem::RunParameterSweep(grid, threadPool, cells);
+
+		results.m_columns = { "Method", "Median RMS Error", "Max Error", "Worst k", "Worst Damping", "Diverged Cells", "Cell Time (us)" };
+
+		const size_t numCellsPerMethod = cells.size() / grid.m_methods.size();
+		for (size_t methodIndex = 0; methodIndex < grid.m_methods.size(); ++methodIndex)
+		{
+			const ODESystem::SweepCell* pCells = cells.data() + methodIndex * numCellsPerMethod;
+			const ODESystem::SweepCell* pWorstCell = nullptr;
+			std::vector<float> rmsErrors;
+			unsigned int numDiverged = 0;
+			double cellTime = 0.0;
+			for (size_t i = 0; i < numCellsPerMethod; ++i)
+			{
+				const ODESystem::SweepCell& cell = pCells[i];
+				cellTime += cell.m_seconds;
+				if (!isfinite(cell.m_maxError) || cell.m_maxError > 1.0e3f)
+				{
+					++numDiverged;
+					continue;
+				}
+
+				rmsErrors.push_back(cell.m_rmsError);
+				if (!pWorstCell || cell.m_maxError > pWorstCell->m_maxError)
+					pWorstCell = &cell;
+			}
+
+			float medianError = NAN;
+			if (!rmsErrors.empty())
+			{
+				std::nth_element(rmsErrors.begin(), rmsErrors.begin() + rmsErrors.size() / 2, rmsErrors.end());
+				medianError = rmsErrors[rmsErrors.size() / 2];
+			}
+
+			results.AddRow({
+				grid.m_methods[methodIndex].m_name,
+				Format("%.2e", medianError),
+				pWorstCell ? Format("%.2e", pWorstCell->m_maxError) : "-",
+				pWorstCell ? Format("%.1f", pWorstCell->m_springConstant) : "-",
+				pWorstCell ? Format("%.2f", pWorstCell->m_damping) : "-",
+				Format("%.0f", numDiverged),
+				Format("%.1f", 1.0e6 * cellTime / numCellsPerMethod) });
+		}
+	}
+
+	void SymplecticCompositionBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::SingleSpringMassSystemDouble System;
+		typedef void(*Method)(System&, double);
+		constexpr double springConstant = 10.0;
+		constexpr double duration = 1000.0;
+		constexpr double stepSize = 1.0 / 60.0;
+		constexpr unsigned int ruthEvaluations = 3;
+
+		struct SymplecticMethod
+		{
+			const char* m_name;
+			unsigned int m_order;
+			unsigned int m_numEvaluations;
+			Method m_method;
+		};
+
+		const SymplecticMethod methods[] = {
+			{ "Ruth 4", 4, ruthEvaluations, ODE::Ruth4<double, System> },
+			{ "Forest-Ruth 4 (splitting)", 4, ODE::ForestRuth4::numKicks, ODE::SymplecticSplitting<ODE::ForestRuth4, double, System> },
+			{ "PEFRL 4", 4, ODE::PEFRL4::numKicks, ODE::SymplecticSplitting<ODE::PEFRL4, double, System> },
+			{ "Blanes-Moan 4", 4, ODE::BlanesMoan4::numKicks, ODE::SymplecticSplitting<ODE::BlanesMoan4, double, System> },
+			{ "Yoshida 6", 6, ODE::Yoshida6::numSubSteps, ODE::SymplecticSplitting<ODE::LeapfrogComposition<ODE::Yoshida6>, double, System> },
+			{ "Yoshida 8", 8, ODE::Yoshida8::numSubSteps, ODE::SymplecticSplitting<ODE::LeapfrogComposition<ODE::Yoshida8>, double, System> },
+			{ "Explicit RK4 (not symplectic)", 4, 4, ODE::ExplicitRK4<double, 2, System> } };
+
+		// energy of the undamped spring, which the exact solution conserves
+		const auto getEnergy = [](const System& system)
+		{
+			return 0.5 * system.m_massSpeed * system.m_massSpeed + 0.5 * system.m_springConstant * system.m_massPos * system.m_massPos;
+		};
+
+		const auto run = [&](const SymplecticMethod& method, double methodStepSize, double& maxEnergyError, double& positionError)
+		{
+			const unsigned int numSteps = static_cast<unsigned int>(duration / methodStepSize + 0.5);
+			System system;
+			system.Reset(springConstant, 0.0);
+			const double initialEnergy = getEnergy(system);
+
+			maxEnergyError = 0.0;
+			for (unsigned int i = 0; i < numSteps; ++i)
+			{
+				method.m_method(system, methodStepSize);
+				maxEnergyError = std::max(maxEnergyError, fabs(getEnergy(system) - initialEnergy) / initialEnergy);
+			}
+
+			std::vector<double> analyticalData;
+			System analyticalSystem;
+			analyticalSystem.Reset(springConstant, 0.0);
+			analyticalSystem.SolveAnalytical({ numSteps * methodStepSize }, analyticalData);
+			positionError = fabs(system.m_massPos - analyticalData[0]);
+		};
+
+		// best of a few runs without the energy tracking so the first method doesn't pay for a cold cache
+		const auto measureStepTime = [&](const SymplecticMethod& method)
+		{
+			constexpr unsigned int numRuns = 5;
+			constexpr unsigned int numSteps = 10000;
+			double bestTime = 0.0;
+			for (unsigned int run = 0; run < numRuns; ++run)
+			{
+				System system;
+				system.Reset(springConstant, 0.0);
+				const double time = MeasureSeconds([&]()
+				{
+					for (unsigned int i = 0; i < numSteps; ++i)
+						method.m_method(system, stepSize);
+				});
+				bestTime = (run == 0) ? time : std::min(bestTime, time);
+			}
+			return bestTime / numSteps;
+		};
+
+		results.m_columns = { "Method", "Order", "Evals/Step", "ns/step", "Cost vs Ruth 4", "Energy Error (dt = 1/60)", "Position Error (dt = 1/60)",
+			"Energy Error (equal work)", "Position Error (equal work)" };
+
+		double ruthStepTime = 0.0;
+		for (const SymplecticMethod& method : methods)
+		{
+			double energyError = 0.0;
+			double positionError = 0.0;
+			run(method, stepSize, energyError, positionError);
+
+			const double stepTime = measureStepTime(method);
+			if (method.m_method == methods[0].m_method)
+				ruthStepTime = stepTime;
+
+			// equal work gives every method the same number of evaluations per second as Ruth 4 at 60 Hz
+			double equalWorkEnergyError = 0.0;
+			double equalWorkPositionError = 0.0;
+			run(method, stepSize * method.m_numEvaluations / ruthEvaluations, equalWorkEnergyError, equalWorkPositionError);
+
+			results.AddRow({
+				method.m_name,
+				Format("%.0f", method.m_order),
+				Format("%.0f", method.m_numEvaluations),
+				Format("%.1f", 1.0e9 * stepTime),
+				Format("%.2fx", stepTime / ruthStepTime),
+				Format("%.2e", energyError),
+				Format("%.2e", positionError),
+				Format("%.2e", equalWorkEnergyError),
+				Format("%.2e", equalWorkPositionError) });
+		}
+	}
+
+	void SpringLatticeBenchmark(ResultTable& results)
+	{
+		constexpr unsigned int numSteps = 20;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr float springConstant = 100.0f;
+		constexpr float damping = 0.1f;
+
+		typedef ODESystem::DynamicStateData<float> State;
+		typedef ODESystem::SpringLatticeSystem System;
+
+		struct Size
+		{
+			const char* m_name;
+			unsigned int m_width;
+			unsigned int m_height;
+		};
+
+		const Size sizes[] = {
+			{ "Chain", 1 << 10, 1 },
+			{ "Chain", 1 << 14, 1 },
+			{ "Chain", 1 << 18, 1 },
+			{ "Chain", 1 << 20, 1 },
+			{ "Lattice", 32, 32 },
+			{ "Lattice", 256, 256 },
+			{ "Lattice", 512, 512 },
+			{ "Lattice", 1024, 1024 } };
+
+		results.m_columns = { "System", "Masses", "Semi-Implicit Euler (steps/s)", "RK4 (steps/s)", "Batched RK4 (steps/s)",
+			"Batched RK4 (M masses/s)", "RK4 Max Error", "Batched RK4 Max Error" };
+
+		// the standing wave is a sixteenth of the width so its frequency stays the same as the lattice grows
+		const auto getMode = [](unsigned int size) { return std::max(size / 16, 1u); };
+
+		std::vector<float> analyticalData;
+		const auto getMaxError = [&](const ODESystem::SpringLattice& lattice, const float* positions)
+		{
+			analyticalData.resize(lattice.GetNumMasses());
+			lattice.SolveAnalytical(numSteps * stepSize, analyticalData.data());
+			float maxError = 0.0f;
+			for (size_t i = 0; i < analyticalData.size(); ++i)
+				maxError = std::max(maxError, fabsf(positions[i] - analyticalData[i]));
+			return maxError;
+		};
+
+		for (const Size& size : sizes)
+		{
+			const unsigned int modeX = getMode(size.m_width);
+			const unsigned int modeY = getMode(size.m_height);
+
+			System system;
+			system.Reset(size.m_width, size.m_height, springConstant, damping, modeX, modeY);
+			const double semiImplicitTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					ODE::SemiImplicitEuler<State, 2, System>(system, stepSize);
+			});
+
+			system.Reset(size.m_width, size.m_height, springConstant, damping, modeX, modeY);
+			const double rk4Time = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					ODE::ExplicitRK4<State, 2, System>(system, stepSize);
+			});
+			const float rk4Error = getMaxError(system.m_lattice, system.m_massPos.m_data.data());
+
+			ODESystem::SpringLatticeBatch batch;
+			batch.Reset(size.m_width, size.m_height, springConstant, damping, modeX, modeY);
+			const double batchTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					ODEBatch::ExplicitRK4<float, 2>(batch, stepSize);
+			});
+			const float batchError = getMaxError(batch.m_lattice, batch.GetDerivatives((int)ODESystem::EStateDerivative::Position));
+
+			char name[64];
+			snprintf(name, sizeof(name), (size.m_height == 1) ? "%s %u" : "%s %ux%u", size.m_name, size.m_width, size.m_height);
+
+			const double numMasses = static_cast<double>(batch.m_lattice.GetNumMasses());
+			results.AddRow({
+				name,
+				Format("%.0f", numMasses),
+				Format("%.0f", numSteps / semiImplicitTime),
+				Format("%.0f", numSteps / rk4Time),
+				Format("%.0f", numSteps / batchTime),
+				Format("%.1f", 1.0e-6 * numMasses * numSteps / batchTime),
+				Format("%.2e", rk4Error),
+				Format("%.2e", batchError) });
+		}
+	}
+
+
+	void NBodyBenchmark(ResultTable& results)
+	{
+		constexpr float stepSize = 1.0f / 128.0f;
+		constexpr unsigned int numSteps = 32;
+		constexpr size_t maxDirectBodies = 16384;			// above this only the Barnes-Hut evaluation is timed
+
+		typedef ODESystem::DynamicStateData<float> State;
+		typedef ODESystem::NBodySystem System;
+		typedef void(*Method)(System&, float);
+
+		ThreadPool threadPool;
+
+		// energies come from the direct sum so the drift isn't hidden by the error of the Barnes-Hut potential
+		const auto getEnergyDrift = [&](size_t numBodies, ODESystem::ENBodyForce force, Method method)
+		{
+			System system;
+			system.Reset(numBodies);
+			system.m_pThreadPool = &threadPool;
+			system.m_force = ODESystem::ENBodyForce::Direct;
+			const double initialEnergy = system.GetEnergy();
+
+			system.m_force = force;
+			for (unsigned int step = 0; step < numSteps; ++step)
+				method(system, stepSize);
+
+			system.m_force = ODESystem::ENBodyForce::Direct;
+			return fabs(system.GetEnergy() - initialEnergy) / fabs(initialEnergy);
+		};
+
+		results.m_columns = { "Bodies", "Force", "Evaluation (ms)", "Interactions/Body", "Interactions/s (M)", "Max Force Error",
+			"Energy Drift (Velocity Verlet)", "Energy Drift (Ruth 4)" };
+
+		std::vector<float> directAccelerations;
+		std::vector<float> accelerations;
+		for (size_t numBodies = 1024; numBodies <= (1 << 20); numBodies *= 4)
+		{
+			System system;
+			system.Reset(numBodies);
+			system.m_pThreadPool = &threadPool;
+
+			const bool isDirect = numBodies <= maxDirectBodies;
+			for (ODESystem::ENBodyForce force : { ODESystem::ENBodyForce::Direct, ODESystem::ENBodyForce::BarnesHut })
+			{
+				if (force == ODESystem::ENBodyForce::Direct && !isDirect)
+					continue;
+
+				system.m_force = force;
+				system.m_numInteractions = 0;
+				accelerations.resize(3 * numBodies);
+				const double time = MeasureSeconds([&]() { system.GetAccelerations(system.m_positions.m_data.data(), accelerations.data(), nullptr); });
+				const double numInteractions = static_cast<double>(system.m_numInteractions);
+				if (force == ODESystem::ENBodyForce::Direct)
+					directAccelerations = accelerations;
+
+				// relative to the size of each body's direct acceleration
+				double maxForceError = 0.0;
+				for (size_t i = 0; isDirect && i < numBodies; ++i)
+				{
+					double errorSquared = 0.0;
+					double accelerationSquared = 0.0;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						const double direct = directAccelerations[axis * numBodies + i];
+						errorSquared += (accelerations[axis * numBodies + i] - direct) * (accelerations[axis * numBodies + i] - direct);
+						accelerationSquared += direct * direct;
+					}
+					maxForceError = std::max(maxForceError, sqrt(errorSquared / accelerationSquared));
+				}
+
+				results.AddRow({
+					Format("%.0f", static_cast<double>(numBodies)),
+					(force == ODESystem::ENBodyForce::Direct) ? "Direct" : "Barnes-Hut",
+					Format("%.1f", 1.0e3 * time),
+					Format("%.0f", numInteractions / numBodies),
+					Format("%.1f", 1.0e-6 * numInteractions / time),
+					isDirect ? Format("%.2e", maxForceError) : "-",
+					isDirect ? Format("%.2e", getEnergyDrift(numBodies, force, ODE::VelocityVerlet<State, System>)) : "-",
+					isDirect ? Format("%.2e", getEnergyDrift(numBodies, force, ODE::Ruth4<State, System>)) : "-" });
+			}
+		}
+	}
+
+
+	void TransitionMatrixBenchmark(ResultTable& results)
+	{
+		results.m_columns = { "System", "Method", "ns/step", "Max Error (10 s)" };
+
+		AddTransitionMatrixRows<ODESystem::SingleSpringMassSystem, float, ODESystem::SingleSpringMassBatch>(results, "Single Spring",
+			[](const ODESystem::SingleSpringMassSystem& system) { return system.m_massPos; },
+			[](const ODESystem::SingleSpringMassSystem& system, float time)
+			{
+				std::vector<float> positions;
+				system.SolveAnalytical({ time }, positions);
+				return positions[0];
+			});
+
+		AddTransitionMatrixRows<ODESystem::CoupledSpringMassSystem, ODESystem::StateData<float, 2>, ODESystem::CoupledSpringMassBatch>(results, "Coupled Springs",
+			[](const ODESystem::CoupledSpringMassSystem& system) { return system.m_massPos[0]; },
+			[](const ODESystem::CoupledSpringMassSystem& system, float time)
+			{
+				std::vector<float> positions0;
+				std::vector<float> positions1;
+				system.SolveAnalytical({ time }, positions0, positions1);
+				return positions0[0];
+			});
+	}
+
+
+	void AnalyticalSolutionBenchmark(ResultTable& results)
+	{
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+		constexpr float duration = 600.0f;
+		constexpr float sampleRate = 1200.0f;
+		constexpr unsigned int numRepeats = 10;
+
+		const size_t numSamples = static_cast<size_t>(duration * sampleRate) + 1;
+		std::vector<float> timeData(numSamples);
+		for (size_t i = 0; i < numSamples; ++i)
+			timeData[i] = i / sampleRate;
+
+		ODESystem::SingleSpringMassSystem singleSystem;
+		singleSystem.Reset(springConstant, damping);
+		ODESystem::CoupledSpringMassSystem coupledSystem;
+		coupledSystem.Reset(springConstant, damping);
+
+		// the solutions as they were, calling the C library per sample
+		const auto solveSingleScalar = [&](std::vector<float>& positions)
+		{
+			positions.clear();
+			const float angularFrequency = sqrtf(springConstant - 0.25f * damping * damping);
+			for (const float time : timeData)
+				positions.push_back(expf(-0.5f * damping * time) * (cosf(angularFrequency * time) + 0.5f * damping * sinf(angularFrequency * time) / angularFrequency));
+		};
+
+		const auto solveCoupledScalar = [&](std::vector<float>& positions0, std::vector<float>& positions1)
+		{
+			positions0.clear();
+			positions1.clear();
+			const float w[2] = { sqrtf(springConstant - 0.25f * damping * damping), sqrtf(3.0f * springConstant - 0.25f * damping * damping) };
+			for (const float time : timeData)
+			{
+				const float q[2] = {
+					cosf(w[0] * time) + 0.5f * damping * sinf(w[0] * time) / w[0],
+					cosf(w[1] * time) + 0.5f * damping * sinf(w[1] * time) / w[1] };
+				const float dampingFactor = expf(-0.5f * damping * time);
+				positions0.push_back(dampingFactor * 0.5f * (q[0] + q[1]));
+				positions1.push_back(dampingFactor * 0.5f * (q[0] - q[1]));
+			}
+		};
+
+		results.m_columns = { "System", "Kernels", "ns/sample", "Speedup", "Max Difference" };
+
+		std::vector<float> scalarPositions[2];
+		std::vector<float> positions[2];
+
+		const double singleScalarTime = MeasureSeconds([&]()
+		{
+			for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+				solveSingleScalar(scalarPositions[0]);
+		});
+		results.AddRow({ "Single Spring", "C library", Format("%.2f", 1.0e9 * singleScalarTime / (numRepeats * numSamples)), "-", "-" });
+
+		const VectorMath::EInstructionSet defaultInstructionSet = VectorMath::GetInstructionSet();
+		for (unsigned int i = 0; i < static_cast<unsigned int>(VectorMath::EInstructionSet::NUM_INSTRUCTION_SETS); ++i)
+		{
+			const VectorMath::EInstructionSet instructionSet = static_cast<VectorMath::EInstructionSet>(i);
+			if (!VectorMath::IsSupported(instructionSet))
+				continue;
+
+			VectorMath::SetInstructionSet(instructionSet);
+			const double time = MeasureSeconds([&]()
+			{
+				for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+					singleSystem.SolveAnalytical(timeData, positions[0]);
+			});
+
+			float maxDifference = 0.0f;
+			for (size_t sample = 0; sample < numSamples; ++sample)
+				maxDifference = std::max(maxDifference, fabsf(positions[0][sample] - scalarPositions[0][sample]));
+
+			results.AddRow({ "Single Spring", VectorMath::GetName(instructionSet), Format("%.2f", 1.0e9 * time / (numRepeats * numSamples)),
+				Format("%.1fx", singleScalarTime / time), Format("%.2e", maxDifference) });
+		}
+
+		const double coupledScalarTime = MeasureSeconds([&]()
+		{
+			for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+				solveCoupledScalar(scalarPositions[0], scalarPositions[1]);
+		});
+		results.AddRow({ "Coupled Springs", "C library", Format("%.2f", 1.0e9 * coupledScalarTime / (numRepeats * numSamples)), "-", "-" });
+
+		for (unsigned int i = 0; i < static_cast<unsigned int>(VectorMath::EInstructionSet::NUM_INSTRUCTION_SETS); ++i)
+		{
+			const VectorMath::EInstructionSet instructionSet = static_cast<VectorMath::EInstructionSet>(i);
+			if (!VectorMath::IsSupported(instructionSet))
+				continue;
+
+			VectorMath::SetInstructionSet(instructionSet);
+			const double time = MeasureSeconds([&]()
+			{
+				for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+					coupledSystem.SolveAnalytical(timeData, positions[0], positions[1]);
+			});
+
+			float maxDifference = 0.0f;
+			for (size_t sample = 0; sample < numSamples; ++sample)
+				for (unsigned int mass = 0; mass < 2; ++mass)
+					maxDifference = std::max(maxDifference, fabsf(positions[mass][sample] - scalarPositions[mass][sample]));
+
+			results.AddRow({ "Coupled Springs", VectorMath::GetName(instructionSet), Format("%.2f", 1.0e9 * time / (numRepeats * numSamples)),
+				Format("%.1fx", coupledScalarTime / time), Format("%.2e", maxDifference) });
+		}
+
+		VectorMath::SetInstructionSet(defaultInstructionSet);
+	}
+
+
+	void EventDetectionBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::SingleSpringMassSystem System;
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+		constexpr float duration = 60.0f;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr float wallPosition = -0.5f;
+		constexpr unsigned int numRepeats = 100;
+		const unsigned int numSteps = static_cast<unsigned int>(duration / stepSize);
+
+		// the mass passes zero when tan(w t) = -2 w / c, every half period
+		const double angularFrequency = sqrt(springConstant - 0.25 * damping * damping);
+		const double halfPeriod = 3.14159265358979323846 / angularFrequency;
+		const double firstZeroTime = halfPeriod - atan(2.0 * angularFrequency / damping) / angularFrequency;
+
+		struct Method
+		{
+			const char* m_name;
+			void(*m_method)(System&, float);
+		};
+
+		const Method methods[] = {
+			{ "Explicit RK4", ODE::ExplicitRK4<float, 2, System> },
+			{ "Velocity Verlet", ODE::VelocityVerlet<float, System> } };
+
+		const auto passesZero = [](const ODESystem::FixedSpringDerivatives& derivatives)
+		{
+			return std::array<float, 1>{ derivatives[(int)ODESystem::EStateDerivative::Position] };
+		};
+
+		const auto hitsWall = [](const ODESystem::FixedSpringDerivatives& derivatives)
+		{
+			return std::array<float, 1>{ derivatives[(int)ODESystem::EStateDerivative::Position] - wallPosition };
+		};
+
+		// an elastic wall reverses the speed
+		const auto bounce = [](unsigned int index, ODESystem::FixedSpringDerivatives& derivatives)
+		{
+			derivatives[(int)ODESystem::EStateDerivative::Speed] = -derivatives[(int)ODESystem::EStateDerivative::Speed];
+		};
+
+		results.m_columns = { "Method", "Events", "ns/step", "Overhead", "Events Found", "Max Time Error" };
+
+		for (const Method& method : methods)
+		{
+			System system;
+			const double baseTime = MeasureSeconds([&]()
+			{
+				for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+				{
+					system.Reset(springConstant, damping);
+					for (unsigned int step = 0; step < numSteps; ++step)
+						method.m_method(system, stepSize);
+				}
+			});
+			results.AddRow({ method.m_name, "None", Format("%.2f", 1.0e9 * baseTime / (numRepeats * numSteps)), "-", "-", "-" });
+
+			ODE::EventLocator<float, 2, 1, decltype(passesZero)> zeroLocator(passesZero);
+			const double zeroTime = MeasureSeconds([&]()
+			{
+				for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+				{
+					system.Reset(springConstant, damping);
+					zeroLocator.Reset();
+					for (unsigned int step = 0; step < numSteps; ++step)
+						zeroLocator.Step(system, method.m_method, stepSize);
+				}
+			});
+
+			double maxTimeError = 0.0;
+			const std::vector<ODE::EventRecord<float>>& records = zeroLocator.GetRecords();
+			for (size_t i = 0; i < records.size(); ++i)
+				maxTimeError = std::max(maxTimeError, fabs(records[i].m_time - (firstZeroTime + i * halfPeriod)));
+
+			results.AddRow({ method.m_name, "Passes zero", Format("%.2f", 1.0e9 * zeroTime / (numRepeats * numSteps)), Format("%+.1f%%", 100.0 * (zeroTime / baseTime - 1.0)),
+				Format("%.0f", static_cast<double>(records.size())), Format("%.2e", maxTimeError) });
+
+			ODE::EventLocator<float, 2, 1, decltype(hitsWall)> wallLocator(hitsWall);
+			wallLocator.SetEvent(0, ODE::EEventDirection::Falling, ODE::EEventAction::Restart);
+			const double wallTime = MeasureSeconds([&]()
+			{
+				for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+				{
+					system.Reset(springConstant, damping);
+					wallLocator.Reset();
+					wallLocator.Integrate(system, method.m_method, stepSize, duration, bounce);
+				}
+			});
+
+			results.AddRow({ method.m_name, "Bounces off a wall", Format("%.2f", 1.0e9 * wallTime / (numRepeats * numSteps)), Format("%+.1f%%", 100.0 * (wallTime / baseTime - 1.0)),
+				Format("%.0f", static_cast<double>(wallLocator.GetRecords().size())), "-" });
+
+			// a restart that leaves the state alone has to find the same crossings as recording them
+			ODE::EventLocator<float, 2, 1, decltype(passesZero)> restartLocator(passesZero);
+			restartLocator.SetEvent(0, ODE::EEventDirection::Any, ODE::EEventAction::Restart);
+			const double restartTime = MeasureSeconds([&]()
+			{
+				for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+				{
+					system.Reset(springConstant, damping);
+					restartLocator.Reset();
+					restartLocator.Integrate(system, method.m_method, stepSize, duration, ODE::NoRestart());
+				}
+			});
+
+			double maxRestartTimeError = 0.0;
+			const std::vector<ODE::EventRecord<float>>& restartRecords = restartLocator.GetRecords();
+			for (size_t i = 0; i < restartRecords.size(); ++i)
+				maxRestartTimeError = std::max(maxRestartTimeError, fabs(restartRecords[i].m_time - (firstZeroTime + i * halfPeriod)));
+
+			results.AddRow({ method.m_name, "Restarts at zero, no change", Format("%.2f", 1.0e9 * restartTime / (numRepeats * numSteps)),
+				Format("%+.1f%%", 100.0 * (restartTime / baseTime - 1.0)), Format("%.0f", static_cast<double>(restartRecords.size())),
+				(restartLocator.GetTime() >= duration) ? Format("%.2e", maxRestartTimeError) : "stalled" });
+		}
+	}
+
+
+	void StochasticEnsembleBenchmark(ResultTable& results)
+	{
+		constexpr float springConstant = 10.0f;
+		constexpr float damping = 0.1f;
+		constexpr float noise = 0.5f;
+		constexpr size_t numStrongPaths = 1000;
+		constexpr float strongDuration = 2.0f;
+		constexpr float referenceStepSize = 1.0f / 1920.0f;
+		constexpr uint64_t seed = 1234;
+
+		struct Noise
+		{
+			const char* m_name;
+			float m_additiveNoise;
+			float m_multiplicativeNoise;
+		};
+
+		const Noise noises[] = {
+			{ "Additive", noise, 0.0f },
+			{ "Multiplicative", 0.0f, noise } };
+
+		struct Method
+		{
+			const char* m_name;
+			ODESystem::EStochasticMethod m_method;
+		};
+
+		const Method methods[] = {
+			{ "Euler-Maruyama", ODESystem::EStochasticMethod::EulerMaruyama },
+			{ "Milstein", ODESystem::EStochasticMethod::Milstein } };
+
+		// RMS error at the end against a fine Milstein run, with the coarse increments summed from the fine
+		// ones so both follow the same Wiener path
+		const auto measureStrongError = [&](const Noise& noise, const Method& method, unsigned int numSubSteps)
+		{
+			ODESystem::StochasticSpringMassBatch reference;
+			ODESystem::StochasticSpringMassBatch coarse;
+			reference.Reset(numStrongPaths, springConstant, damping, noise.m_additiveNoise, noise.m_multiplicativeNoise);
+			coarse.Reset(numStrongPaths, springConstant, damping, noise.m_additiveNoise, noise.m_multiplicativeNoise);
+
+			std::vector<float> referenceIncrements(numStrongPaths);
+			std::vector<float> coarseIncrements(numStrongPaths, 0.0f);
+			const unsigned int numReferenceSteps = static_cast<unsigned int>(strongDuration / referenceStepSize);
+			for (unsigned int step = 0; step < numReferenceSteps; ++step)
+			{
+				Random::FillNormals(seed, step, 0, referenceIncrements.data(), numStrongPaths);
+				for (size_t i = 0; i < numStrongPaths; ++i)
+				{
+					referenceIncrements[i] *= sqrtf(referenceStepSize);
+					coarseIncrements[i] += referenceIncrements[i];
+				}
+				SDE::Milstein(reference, referenceStepSize, referenceIncrements.data());
+
+				if ((step + 1) % numSubSteps == 0)
+				{
+					if (method.m_method == ODESystem::EStochasticMethod::Milstein)
+						SDE::Milstein(coarse, numSubSteps * referenceStepSize, coarseIncrements.data());
+					else
+						SDE::EulerMaruyama(coarse, numSubSteps * referenceStepSize, coarseIncrements.data());
+					std::fill(coarseIncrements.begin(), coarseIncrements.end(), 0.0f);
+				}
+			}
+
+			double errorSquared = 0.0;
+			const float* referencePositions = reference.GetDerivatives((int)ODESystem::EStateDerivative::Position);
+			const float* coarsePositions = coarse.GetDerivatives((int)ODESystem::EStateDerivative::Position);
+			for (size_t i = 0; i < numStrongPaths; ++i)
+				errorSquared += static_cast<double>(coarsePositions[i] - referencePositions[i]) * (coarsePositions[i] - referencePositions[i]);
+			return sqrt(errorSquared / numStrongPaths);
+		};
+
+		ODESystem::EnsembleSettings settings;
+		settings.m_springConstant = springConstant;
+		settings.m_damping = damping;
+		settings.m_stepSize = 1.0f / 60.0f;
+		settings.m_numSteps = 600;
+		settings.m_stepsPerSample = 6;
+		settings.m_numPaths = 10000;
+		settings.m_seed = seed;
+
+		// the drift is linear and the noise terms have zero mean, so the ensemble mean should follow the same
+		// method stepped without noise to within its standard error
+		ODESystem::EnsembleStatistics statistics;
+		ODESystem::EnsembleStatistics serialStatistics;
+		ODESystem::EnsembleStatistics noiseFreeStatistics;
+
+		ThreadPool threadPool;
+		results.m_columns = { "Noise", "Method", "ns/path/step", "Same on 1 Thread", "Max Mean Bias (std errors)", "Final Std Dev", "Strong Error (h = 1/30)", "Strong Order" };
+
+		for (const Noise& noise : noises)
+		{
+			for (const Method& method : methods)
+			{
+				settings.m_additiveNoise = noise.m_additiveNoise;
+				settings.m_multiplicativeNoise = noise.m_multiplicativeNoise;
+				settings.m_method = method.m_method;
+
+				const double time = MeasureSeconds([&]() { ODESystem::RunEnsemble(settings, &threadPool, statistics); });
+				ODESystem::RunEnsemble(settings, nullptr, serialStatistics);
+				const bool isSame = (statistics.m_means == serialStatistics.m_means) && (statistics.m_variances == serialStatistics.m_variances);
+
+				ODESystem::EnsembleSettings noiseFreeSettings = settings;
+				noiseFreeSettings.m_additiveNoise = 0.0f;
+				noiseFreeSettings.m_multiplicativeNoise = 0.0f;
+				noiseFreeSettings.m_numPaths = 1;
+				ODESystem::RunEnsemble(noiseFreeSettings, nullptr, noiseFreeStatistics);
+
+				double maxBias = 0.0;
+				for (size_t sample = 1; sample < statistics.m_times.size(); ++sample)
+				{
+					const double standardError = sqrt(statistics.m_variances[sample] / settings.m_numPaths);
+					maxBias = std::max(maxBias, fabs(statistics.m_means[sample] - noiseFreeStatistics.m_means[sample]) / standardError);
+				}
+
+				const double coarseError = measureStrongError(noise, method, 64);
+				const double fineError = measureStrongError(noise, method, 16);
+
+				results.AddRow({
+					noise.m_name,
+					method.m_name,
+					Format("%.2f", 1.0e9 * time / (static_cast<double>(settings.m_numPaths) * settings.m_numSteps)),
+					isSame ? "Yes" : "No",
+					Format("%.2f", maxBias),
+					Format("%.3f", sqrt(statistics.m_variances.back())),
+					Format("%.2e", coarseError),
+					Format("%.2f", log(coarseError / fineError) / log(4.0)) });
+			}
+		}
+	}
+
+
+	// StateData as it was before its arithmetic became lazy, every operator returns a new state
+	template<typename T, unsigned int N>
+	struct EagerStateData
+	{
+		std::array<T, N> m_data = {};
+
+		EagerStateData<T, N> operator * (T rhs) const
+		{
+			EagerStateData<T, N> result;
+			for (unsigned int i = 0; i < N; ++i)
+				result.m_data[i] = m_data[i] * rhs;
+			return result;
+		}
+
+		EagerStateData<T, N> operator + (const EagerStateData<T, N>& rhs) const
+		{
+			EagerStateData<T, N> result;
+			for (unsigned int i = 0; i < N; ++i)
+				result.m_data[i] = m_data[i] + rhs.m_data[i];
+			return result;
+		}
+
+		EagerStateData<T, N>& operator += (const EagerStateData<T, N>& rhs)
+		{
+			for (unsigned int i = 0; i < N; ++i)
+				m_data[i] += rhs.m_data[i];
+			return *this;
+		}
+	};
+
+
+	template<typename T, unsigned int N>
+	T GetComponent(const EagerStateData<T, N>& value, unsigned int index)
+	{
+		return value.m_data[index];
+	}
+
+
+	// N uncoupled springs in one state, so the cost of a step is all in the arithmetic of the method.  They
+	// are undamped so the long runs don't decay into denormals.
+	template<typename State>
+	struct SpringArraySystem final : ODE::IState<State, 2>
+	{
+		std::array<State, 2> m_derivatives;
+		float m_springConstant = 10.0f;
+		float m_damping = 0.0f;
+
+		virtual void GetDerivatives(std::array<State, 2>& derivatives) const override
+		{
+			derivatives = m_derivatives;
+		}
+
+		virtual State GetNthDerivative(const std::array<State, 2>& derivatives) const override
+		{
+			return derivatives[0] * -m_springConstant + derivatives[1] * -m_damping;
+		}
+
+		virtual void SetDerivatives(const std::array<State, 2>& derivatives) override
+		{
+			m_derivatives = derivatives;
+		}
+	};
+
+
+	template<unsigned int N>
+	void AddExpressionRows(ResultTable& results)
+	{
+		constexpr unsigned int numComponentSteps = 1 << 22;
+		constexpr unsigned int numSteps = numComponentSteps / N;
+		constexpr float stepSize = 1.0f / 60.0f;
+
+		typedef EagerStateData<float, N> EagerState;
+		typedef ODESystem::StateData<float, N> LazyState;
+
+		struct Method
+		{
+			const char* m_name;
+			void(*m_eagerMethod)(SpringArraySystem<EagerState>&, float);
+			void(*m_lazyMethod)(SpringArraySystem<LazyState>&, float);
+		};
+
+		const Method methods[] = {
+			{ "Explicit RK4", ODE::ExplicitRK4<EagerState, 2, SpringArraySystem<EagerState>>, ODE::ExplicitRK4<LazyState, 2, SpringArraySystem<LazyState>> },
+			{ "Dormand-Prince 5", ODE::ExplicitRungeKutta<ODE::DormandPrince5, EagerState, 2, SpringArraySystem<EagerState>>,
+				ODE::ExplicitRungeKutta<ODE::DormandPrince5, LazyState, 2, SpringArraySystem<LazyState>> } };
+
+		for (const Method& method : methods)
+		{
+			SpringArraySystem<EagerState> eagerSystem;
+			SpringArraySystem<LazyState> lazySystem;
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				eagerSystem.m_derivatives[0].m_data[i] = 1.0f + static_cast<float>(i) / N;
+				lazySystem.m_derivatives[0].m_data[i] = 1.0f + static_cast<float>(i) / N;
+			}
+
+			const double eagerTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					method.m_eagerMethod(eagerSystem, stepSize);
+			});
+
+			const double lazyTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numSteps; ++step)
+					method.m_lazyMethod(lazySystem, stepSize);
+			});
+
+			float maxDifference = 0.0f;
+			for (unsigned int j = 0; j < 2; ++j)
+				for (unsigned int i = 0; i < N; ++i)
+					maxDifference = std::max(maxDifference, fabsf(eagerSystem.m_derivatives[j].m_data[i] - lazySystem.m_derivatives[j].m_data[i]));
+
+			results.AddRow({
+				Format("%.0f", N),
+				method.m_name,
+				Format("%.2f", 1.0e9 * eagerTime / numComponentSteps),
+				Format("%.2f", 1.0e9 * lazyTime / numComponentSteps),
+				Format("%.1fx", eagerTime / lazyTime),
+				Format("%.2e", maxDifference) });
+		}
+	}
+
+
+	void ExpressionTemplateBenchmark(ResultTable& results)
+	{
+		results.m_columns = { "Components", "Method", "Eager (ns/component step)", "Lazy (ns/component step)", "Speedup", "Max Difference" };
+		AddExpressionRows<2>(results);
+		AddExpressionRows<16>(results);
+		AddExpressionRows<128>(results);
+		AddExpressionRows<1024>(results);
+	}
+
+
+	// Rows of the coupled spring's time and four state columns, written through the mapped writer and as
+	// buffered rows with fwrite, then read back from the mapping.  The writes only reach the page cache
+	// before they are timed as done, which is also what an integration loop waits for.
+	void TrajectoryFileBenchmark(ResultTable& results)
+	{
+		constexpr unsigned int numRows = 1 << 22;
+		constexpr unsigned int numStateColumns = 4;
+		constexpr unsigned int numSourceRows = 4096;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr double rowSize = (1 + numStateColumns) * sizeof(float);
+
+		std::vector<float> sourceValues(numSourceRows * numStateColumns);
+		for (unsigned int i = 0; i < numSourceRows * numStateColumns; ++i)
+			sourceValues[i] = sinf(0.001f * i);
+
+		const std::string mappedPath = (std::filesystem::temp_directory_path() / "ode_benchmark_mapped.odet").u8string();
+		const std::string rowsPath = (std::filesystem::temp_directory_path() / "ode_benchmark_rows.bin").u8string();
+
+		ODESystem::TrajectoryFileInfo info;
+		info.m_systemName = "Coupled Spring Mass";
+		info.m_methodName = "Benchmark";
+		info.m_columnNames = { "Position_0", "Position_1", "Speed_0", "Speed_1" };
+		info.m_parameters = { { "StepSize", stepSize } };
+
+		results.m_columns = { "Path", "Rows", "ns/row", "MB/s", "Matches" };
+		const auto addRow = [&](const char* pName, double numPathRows, double time, const char* pMatches)
+		{
+			results.AddRow({
+				pName,
+				Format("%.0f", numPathRows),
+				Format("%.2f", 1.0e9 * time / numPathRows),
+				Format("%.0f", numPathRows * rowSize / (1024.0 * 1024.0 * time)),
+				pMatches });
+		};
+
+		bool isWritten = false;
+		const double mappedTime = MeasureSeconds([&]()
+		{
+			ODESystem::MappedTrajectoryWriter writer;
+			if (!writer.Open(mappedPath.c_str(), info))
+				return;
+
+			for (unsigned int row = 0; row < numRows; ++row)
+				writer.AddSample(row * stepSize, &sourceValues[(row % numSourceRows) * numStateColumns]);
+			isWritten = writer.Close();
+		});
+		addRow("Mapped Writer", numRows, mappedTime, isWritten ? "-" : "Failed");
+
+		const double rowsTime = MeasureSeconds([&]()
+		{
+			FILE* pFile = fopen(rowsPath.c_str(), "wb");
+			if (!pFile)
+				return;
+
+			setvbuf(pFile, nullptr, _IOFBF, 1 << 20);
+			for (unsigned int row = 0; row < numRows; ++row)
+			{
+				const float time = row * stepSize;
+				fwrite(&time, sizeof(float), 1, pFile);
+				fwrite(&sourceValues[(row % numSourceRows) * numStateColumns], sizeof(float), numStateColumns, pFile);
+			}
+			fclose(pFile);
+		});
+		addRow("fwrite Rows (1 MB buffer)", numRows, rowsTime, "-");
+
+		// every value is checked against what was written, a column of a chunk at a time
+		ODESystem::MappedTrajectoryReader reader;
+		bool isMatching = false;
+		const double readTime = MeasureSeconds([&]()
+		{
+			if (!reader.Open(mappedPath.c_str()))
+				return;
+
+			isMatching = (reader.GetNumRows() == numRows) && (reader.GetNumColumns() == 1 + numStateColumns) && (reader.GetInfo().m_columnNames == info.m_columnNames);
+			for (uint64_t chunk = 0; chunk < reader.GetNumChunks() && isMatching; ++chunk)
+			{
+				const uint64_t firstRow = chunk * reader.GetRowsPerChunk();
+				const unsigned int numChunkRows = reader.GetNumChunkRows(chunk);
+				const float* times = reader.GetChunkColumn(chunk, 0);
+				for (unsigned int i = 0; i < numChunkRows; ++i)
+					isMatching &= (times[i] == (firstRow + i) * stepSize);
+
+				for (unsigned int column = 0; column < numStateColumns; ++column)
+				{
+					const float* values = reader.GetChunkColumn(chunk, 1 + column);
+					for (unsigned int i = 0; i < numChunkRows; ++i)
+						isMatching &= (values[i] == sourceValues[((firstRow + i) % numSourceRows) * numStateColumns + column]);
+				}
+			}
+		});
+		addRow("Mapped Reader", numRows, readTime, isMatching ? "Yes" : "No");
+		reader.Close();
+
+		// the cost the sink adds to a trajectory against keeping the positions in memory, undamped as a
+		// damped spring decays to denormals long before the end
+		constexpr unsigned int numSteps = 1 << 20;
+		ODESystem::CoupledSpringMassSystem system;
+		system.Reset(10.0f, 0.0f);
+
+		ODESystem::CoupledSpringMassTrajectory memoryTrajectory(system, ODE::ExplicitRK4<ODESystem::StateData<float, 2>, 2>, stepSize, false);
+		const double memoryTime = MeasureSeconds([&]() { memoryTrajectory.Extend(numSteps); });
+		addRow("RK4 Trajectory in Memory", numSteps, memoryTime, "-");
+
+		ODESystem::CoupledSpringMassTrajectory sinkTrajectory(system, ODE::ExplicitRK4<ODESystem::StateData<float, 2>, 2>, stepSize, false);
+		sinkTrajectory.GetColumnNames(info.m_columnNames);
+		ODESystem::MappedTrajectoryWriter writer;
+		bool isSinkWritten = false;
+		const double sinkTime = MeasureSeconds([&]()
+		{
+			if (!writer.Open(mappedPath.c_str(), info))
+				return;
+
+			sinkTrajectory.m_pSink = &writer;
+			sinkTrajectory.Extend(numSteps);
+			isSinkWritten = writer.Close();
+		});
+
+		// the positions streamed out are the ones kept in memory
+		bool isSinkMatching = isSinkWritten && reader.Open(mappedPath.c_str()) && (reader.GetNumRows() == numSteps);
+		for (uint64_t row = 0; row < numSteps && isSinkMatching; ++row)
+			isSinkMatching = (reader.GetValue(row, 1) == memoryTrajectory.m_positions[row].m_data[0]) && (reader.GetValue(row, 2) == memoryTrajectory.m_positions[row].m_data[1]);
+		addRow("RK4 Trajectory to Mapped Writer", numSteps, sinkTime, isSinkMatching ? "Yes" : "No");
+		reader.Close();
+
+		std::error_code error;
+		std::filesystem::remove(mappedPath, error);
+		std::filesystem::remove(rowsPath, error);
+	}
+
+
+	// Ten minutes of the single spring in double, run serially with the fine method and with Parareal at the
+	// same fine step size, both against the analytical solution.  The bound is the speedup with 32 threads
+	// for the iterations taken, from the measured time of a fine slice and of a coarse sweep, as the serial
+	// coarse sweeps are what limits Parareal rather than the thread count.
+	void PararealBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::SingleSpringMassSystemDouble System;
+		typedef void(*Method)(System&, double);
+
+		constexpr double duration = 600.0;
+		constexpr unsigned int numFineSteps = 144000;
+		constexpr unsigned int numSlices = 240;
+		constexpr unsigned int numFewerSlices = 120;
+		constexpr unsigned int numBoundThreads = 32;
+		static_assert(numFineSteps % numSlices == 0 && numFineSteps % numFewerSlices == 0, "the slices have to split the fine steps evenly to match the serial run");
+
+		struct Run
+		{
+			const char* m_systemName;
+			double m_damping;
+			const char* m_coarseName;
+			Method m_coarseMethod;
+			const char* m_fineName;
+			Method m_fineMethod;
+			unsigned int m_numSlices;
+			unsigned int m_coarseStepsPerSlice;
+		};
+
+		const Run runs[] = {
+			{ "Undamped", 0.0, "Semi-Implicit Euler", ODE::SemiImplicitEuler<double, 2, System>, "Explicit RK4", ODE::ExplicitRK4<double, 2, System>, numSlices, 32 },
+			{ "Undamped", 0.0, "Explicit RK4", ODE::ExplicitRK4<double, 2, System>, "Explicit RK4", ODE::ExplicitRK4<double, 2, System>, numSlices, 32 },
+			{ "Undamped", 0.0, "Explicit RK4", ODE::ExplicitRK4<double, 2, System>, "Ruth 4", ODE::Ruth4<double, System>, numSlices, 32 },
+			{ "Damped (0.1)", 0.1, "Semi-Implicit Euler", ODE::SemiImplicitEuler<double, 2, System>, "Explicit RK4", ODE::ExplicitRK4<double, 2, System>, numSlices, 32 },
+			{ "Damped (0.1)", 0.1, "Explicit RK4", ODE::ExplicitRK4<double, 2, System>, "Explicit RK4", ODE::ExplicitRK4<double, 2, System>, numFewerSlices, 32 } };
+
+		ThreadPool threadPool;
+		const auto parallelFor = [&threadPool](size_t count, const ThreadPool::ParallelFunc& func) { threadPool.ParallelFor(count, func); };
+
+		results.m_columns = { "System", "Coarse", "Fine", "Slices", "Iterations", "Serial Error", "Parareal Error", "Serial (ms)", "Parareal (ms)", "Speedup",
+			Format("Bound (%.0f threads)", numBoundThreads) };
+
+		for (const Run& run : runs)
+		{
+			System system;
+			system.Reset(10.0, run.m_damping);
+
+			const std::vector<double> endTime = { duration };
+			std::vector<double> analyticalPositions;
+			system.SolveAnalytical(endTime, analyticalPositions);
+
+			System serialSystem = system;
+			const double fineStepSize = duration / numFineSteps;
+			const double serialTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numFineSteps; ++step)
+					run.m_fineMethod(serialSystem, fineStepSize);
+			});
+
+			// converged to well within the error of the fine method itself
+			ODE::PararealSettings settings;
+			settings.m_numSlices = run.m_numSlices;
+			settings.m_coarseStepsPerSlice = run.m_coarseStepsPerSlice;
+			settings.m_fineStepsPerSlice = numFineSteps / run.m_numSlices;
+			settings.m_maxIterations = run.m_numSlices;
+			settings.m_absTolerance = 1.0e-8f;
+			settings.m_relTolerance = 0.0f;
+
+			std::vector<std::array<double, 2>> sliceStates;
+			ODE::PararealStats stats;
+			const double pararealTime = MeasureSeconds([&]()
+			{
+				stats = ODE::Parareal<double, 2>(system, duration, settings, run.m_coarseMethod, run.m_fineMethod, parallelFor, sliceStates);
+			});
+
+			System coarseSystem = system;
+			const double coarseStepSize = duration / (run.m_numSlices * run.m_coarseStepsPerSlice);
+			const double coarseSweepTime = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < run.m_numSlices * run.m_coarseStepsPerSlice; ++step)
+					run.m_coarseMethod(coarseSystem, coarseStepSize);
+			});
+
+			const double fineSliceTime = serialTime / run.m_numSlices;
+			double boundTime = (stats.m_numIterations + 1) * coarseSweepTime;
+			for (unsigned int iteration = 0; iteration < stats.m_numIterations; ++iteration)
+				boundTime += ((run.m_numSlices - iteration + numBoundThreads - 1) / numBoundThreads) * fineSliceTime;
+
+			results.AddRow({
+				run.m_systemName,
+				run.m_coarseName,
+				run.m_fineName,
+				Format("%.0f", run.m_numSlices),
+				stats.m_isConverged ? Format("%.0f", stats.m_numIterations) : "Diverged",
+				Format("%.2e", fabs(serialSystem.m_massPos - analyticalPositions[0])),
+				Format("%.2e", fabs(sliceStates.back()[(int)ODESystem::EStateDerivative::Position] - analyticalPositions[0])),
+				Format("%.2f", 1000.0 * serialTime),
+				Format("%.2f", 1000.0 * pararealTime),
+				Format("%.2fx", serialTime / pararealTime),
+				Format("%.2fx", serialTime / boundTime) });
+		}
+	}
+
+
+	// the coupled springs without their jacobian, so the implicit methods fall back to finite differences
+	struct FiniteDifferenceCoupledSystem final : ODE::IState<ODESystem::StateData<float, 2>, static_cast<unsigned int>(ODESystem::EStateDerivative::NUM_DERIVATIVES)>
+	{
+		ODESystem::CoupledSpringMassSystem m_system;
+
+		virtual void GetDerivatives(ODESystem::CoupledSpringDerivatives& derivatives) const override { m_system.GetDerivatives(derivatives); }
+		virtual ODESystem::StateData<float, 2> GetNthDerivative(const ODESystem::CoupledSpringDerivatives& derivatives) const override { return m_system.GetNthDerivative(derivatives); }
+		virtual void SetDerivatives(const ODESystem::CoupledSpringDerivatives& derivatives) override { m_system.SetDerivatives(derivatives); }
+	};
+
+
+	// The stiff coupled springs with the jacobian from one pass over dual numbers against forward differences,
+	// first on their own against the exact jacobian and then inside the implicit methods.
+	void DualJacobianBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::StateData<float, 2> StateData;
+		constexpr float springConstant = 1000.0f;
+		constexpr float damping = 2000.0f;
+		constexpr unsigned int numJacobians = 100000;
+		constexpr unsigned int numComponents = 2 * 2;
+
+		results.m_columns = { "Jacobian", "Method", "RHS Evaluations", "Jacobian Updates", "Jacobian Error", "Max Error", "Time (us)" };
+
+		ODESystem::CoupledSpringMassSystem system;
+		system.Reset(springConstant, damping);
+		ODESystem::CoupledSpringDerivatives derivatives;
+		derivatives[(int)ODESystem::EStateDerivative::Position].m_data = { 0.8f, -0.3f };
+		derivatives[(int)ODESystem::EStateDerivative::Speed].m_data = { 1.5f, 2.5f };
+		// the springs are linear so every pass takes its own spring constant, and keeps its jacobian to be
+		// checked afterwards, which keeps the passes from being hoisted out of the loops
+		const auto getSpringConstant = [](unsigned int pass) { return springConstant * (1.0f + 0.001f * (pass % 1000)); };
+		const auto getJacobianError = [&](const std::vector<float>& jacobians)
+		{
+			float maxError = 0.0f;
+			for (unsigned int pass = 0; pass < numJacobians; ++pass)
+			{
+				const float passSpringConstant = getSpringConstant(pass);
+				const float exactJacobian[2 * numComponents] = {
+					-2.0f * passSpringConstant, passSpringConstant, -damping, 0.0f,
+					passSpringConstant, -2.0f * passSpringConstant, 0.0f, -damping };
+
+				for (unsigned int i = 0; i < 2 * numComponents; ++i)
+					maxError = std::max(maxError, fabsf(jacobians[pass * 2 * numComponents + i] - exactJacobian[i]) / std::max(fabsf(exactJacobian[i]), 1.0f));
+			}
+			return maxError;
+		};
+
+		std::vector<float> dualJacobians(numJacobians * 2 * numComponents);
+		const double dualTime = MeasureSeconds([&]()
+		{
+			for (unsigned int pass = 0; pass < numJacobians; ++pass)
+			{
+				system.m_springConstant = getSpringConstant(pass);
+				system.GetNthDerivativeJacobian(derivatives, &dualJacobians[pass * 2 * numComponents]);
+			}
+		});
+
+		// the same differences as the newton solver takes
+		std::vector<float> differenceJacobians(numJacobians * 2 * numComponents);
+		const double differenceTime = MeasureSeconds([&]()
+		{
+			for (unsigned int pass = 0; pass < numJacobians; ++pass)
+			{
+				system.m_springConstant = getSpringConstant(pass);
+				float* jacobian = &differenceJacobians[pass * 2 * numComponents];
+				const StateData nthDerivative = system.GetNthDerivative(derivatives);
+				ODESystem::CoupledSpringDerivatives perturbed = derivatives;
+				for (unsigned int column = 0; column < numComponents; ++column)
+				{
+					float& value = perturbed[column / 2].m_data[column % 2];
+					const float original = value;
+					const float perturbation = sqrtf(std::numeric_limits<float>::epsilon()) * std::max(fabsf(original), 1.0f);
+					value = original + perturbation;
+					const StateData perturbedNthDerivative = system.GetNthDerivative(perturbed);
+					for (unsigned int row = 0; row < 2; ++row)
+						jacobian[row * numComponents + column] = (perturbedNthDerivative.m_data[row] - nthDerivative.m_data[row]) / perturbation;
+					value = original;
+				}
+			}
+		});
+
+		results.AddRow({ "Dual Numbers", "-", Format("%.0f", numJacobians), "-", Format("%.2e", getJacobianError(dualJacobians)), "-",
+			Format("%.0f", 1.0e6 * dualTime) });
+		results.AddRow({ "Forward Differences", "-", Format("%.0f", (1 + numComponents) * numJacobians), "-", Format("%.2e", getJacobianError(differenceJacobians)), "-",
+			Format("%.0f", 1.0e6 * differenceTime) });
+
+		// reference trajectory from RK4 at a tiny step size, as in the implicit method benchmark
+		constexpr float duration = 10.0f;
+		constexpr float sampleStepSize = 0.1f;
+		constexpr unsigned int numSubSteps = 16;
+		constexpr unsigned int numReferenceSubSteps = 4000;
+		const unsigned int numSamples = static_cast<unsigned int>(duration / sampleStepSize);
+
+		std::vector<std::array<float, 2>> referenceData;
+		system.Reset(springConstant, damping);
+		for (unsigned int i = 0; i <= numSamples; ++i)
+		{
+			referenceData.push_back({ system.m_massPos[0], system.m_massPos[1] });
+			for (unsigned int j = 0; j < numReferenceSubSteps; ++j)
+				ODE::ExplicitRK4<StateData, 2>(system, sampleStepSize / numReferenceSubSteps);
+		}
+
+		const auto addImplicitRow = [&](const char* jacobianName, const char* methodName, auto& stepSystem, ODESystem::CoupledSpringMassSystem& positions, auto integrator)
+		{
+			positions.Reset(springConstant, damping);
+			float maxError = 0.0f;
+			const double time = MeasureSeconds([&]()
+			{
+				for (unsigned int i = 0; i <= numSamples; ++i)
+				{
+					maxError = std::max(maxError, std::max(fabsf(positions.m_massPos[0] - referenceData[i][0]), fabsf(positions.m_massPos[1] - referenceData[i][1])));
+					for (unsigned int j = 0; j < numSubSteps; ++j)
+						integrator.Step(stepSystem, sampleStepSize / numSubSteps);
+				}
+			});
+
+			const ODE::ImplicitStats stats = integrator.GetStats();
+			results.AddRow({ jacobianName, methodName, Format("%.0f", stats.m_numEvaluations), Format("%.0f", stats.m_numJacobianUpdates), "-",
+				isfinite(maxError) ? Format("%.2e", maxError) : "unstable", Format("%.0f", 1.0e6 * time) });
+		};
+
+		FiniteDifferenceCoupledSystem differenceSystem;
+		addImplicitRow("Dual Numbers", "Backward Euler", system, system, ODE::BackwardEuler<StateData, 2>());
+		addImplicitRow("Forward Differences", "Backward Euler", differenceSystem, differenceSystem.m_system, ODE::BackwardEuler<StateData, 2>());
+		addImplicitRow("Dual Numbers", "BDF 4", system, system, ODE::BDF<StateData, 2>());
+		addImplicitRow("Forward Differences", "BDF 4", differenceSystem, differenceSystem.m_system, ODE::BDF<StateData, 2>());
+	}
+
+
+	// The sensitivities of the damped spring's position after ten seconds of RK4 to its spring constant and
+	// damping.  The dual run gets both from the one integration in double, central differences take two
+	// more runs per parameter, and the analytical solution evaluated on duals is the reference.
+	void DualSensitivityBenchmark(ResultTable& results)
+	{
+		typedef AutoDiff::Dual<double, 2> Dual;
+		constexpr double springConstant = 10.0;
+		constexpr double damping = 0.5;
+		constexpr double duration = 10.0;
+		constexpr unsigned int numSteps = 6000;
+		constexpr double stepSize = duration / numSteps;
+
+		// underdamped, starting at rest from one
+		const Dual seededSpringConstant(springConstant, 0);
+		const Dual seededDamping(damping, 1);
+		const Dual halfDamping = 0.5 * seededDamping;
+		const Dual angularFrequency = sqrt(seededSpringConstant - halfDamping * halfDamping);
+		const Dual analytical = exp(-halfDamping * duration) * (cos(angularFrequency * duration) + halfDamping / angularFrequency * sin(angularFrequency * duration));
+
+		ODESystem::SingleSpringMassSystemT<Dual> dualSystem;
+		dualSystem.m_springConstant = seededSpringConstant;
+		dualSystem.m_damping = seededDamping;
+		const double dualTime = MeasureSeconds([&]()
+		{
+			for (unsigned int step = 0; step < numSteps; ++step)
+				ODE::ExplicitRK4<Dual, 2>(dualSystem, stepSize);
+		});
+
+		const auto runPosition = [](double runSpringConstant, double runDamping)
+		{
+			ODESystem::SingleSpringMassSystemDouble system;
+			system.Reset(runSpringConstant, runDamping);
+			for (unsigned int step = 0; step < numSteps; ++step)
+				ODE::ExplicitRK4<double, 2>(system, stepSize);
+			return system.m_massPos;
+		};
+
+		double position = 0.0;
+		const double plainTime = MeasureSeconds([&]() { position = runPosition(springConstant, damping); });
+
+		// a relative step near the cube root of the precision balances truncation against rounding
+		constexpr double relativeStep = 1.0e-5;
+		std::array<double, 2> differences = {};
+		const double differenceTime = MeasureSeconds([&]()
+		{
+			const double springStep = relativeStep * springConstant;
+			const double dampingStep = relativeStep * damping;
+			differences[0] = (runPosition(springConstant + springStep, damping) - runPosition(springConstant - springStep, damping)) / (2.0 * springStep);
+			differences[1] = (runPosition(springConstant, damping + dampingStep) - runPosition(springConstant, damping - dampingStep)) / (2.0 * dampingStep);
+		});
+
+		results.m_columns = { "Method", "Runs", "Position", "d/dSpringConstant", "d/dDamping", "Sensitivity Error", "Time (us)" };
+		const auto addRow = [&](const char* pName, unsigned int numRuns, double rowPosition, double springSensitivity, double dampingSensitivity, double time)
+		{
+			const double error = std::max(fabs(springSensitivity - analytical.m_tangents[0]), fabs(dampingSensitivity - analytical.m_tangents[1]));
+			results.AddRow({ pName, Format("%.0f", numRuns), Format("%.9f", rowPosition), Format("%.9f", springSensitivity), Format("%.9f", dampingSensitivity),
+				Format("%.2e", error), (time > 0.0) ? Format("%.0f", 1.0e6 * time) : "-" });
+		};
+
+		addRow("Analytical on Duals", 0, analytical.m_value, analytical.m_tangents[0], analytical.m_tangents[1], 0.0);
+		addRow("RK4 on Duals", 1, dualSystem.m_massPos.m_value, dualSystem.m_massPos.m_tangents[0], dualSystem.m_massPos.m_tangents[1], dualTime);
+		addRow("RK4, Central Differences", 5, position, differences[0], differences[1], plainTime + differenceTime);
+	}
+
+
+	// A 256 by 256 lattice run with RK4, straight through and then saving a checkpoint every so many steps
+	// either on the stepping thread or through the asynchronous writer.  The stall is how long the stepping
+	// thread waits for each checkpoint.  The restarts are runs killed halfway through and resumed from the
+	// last checkpoint saved, which have to finish with exactly the same state as the run straight through,
+	// as does an adaptive run restored with its step size control.
+	void CheckpointBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::DynamicStateData<float> State;
+		typedef ODESystem::SpringLatticeSystem System;
+
+		constexpr unsigned int size = 256;
+		constexpr unsigned int mode = size / 16;
+		constexpr float springConstant = 100.0f;
+		constexpr float damping = 0.1f;
+		constexpr uint64_t numSteps = 240;
+		constexpr uint64_t checkpointInterval = 24;
+		const auto method = ODE::ExplicitRK4<State, 2, System>;
+
+		const std::string checkpointPath = (std::filesystem::temp_directory_path() / "ode_benchmark_checkpoint.odec").u8string();
+		ODESystem::RunProgress startProgress;
+		startProgress.m_numSteps = numSteps;
+		startProgress.m_stepSize = 1.0f / 60.0f;
+
+		const auto isMatching = [](const System& lhs, const System& rhs)
+		{
+			return (lhs.m_massPos.m_data.size() == rhs.m_massPos.m_data.size()) && (lhs.m_massSpeed.m_data.size() == rhs.m_massSpeed.m_data.size())
+				&& (memcmp(lhs.m_massPos.m_data.data(), rhs.m_massPos.m_data.data(), lhs.m_massPos.m_data.size() * sizeof(float)) == 0)
+				&& (memcmp(lhs.m_massSpeed.m_data.data(), rhs.m_massSpeed.m_data.data(), lhs.m_massSpeed.m_data.size() * sizeof(float)) == 0);
+		};
+
+		results.m_columns = { "Run", "Steps", "Checkpoints Saved", "Checkpoint (KB)", "Time (ms)", "Stall per Checkpoint (us)", "Bit Identical" };
+
+		// a few steps first so that none of the runs pays for the allocator warming up
+		System uninterrupted;
+		uninterrupted.Reset(size, size, springConstant, damping, mode, mode);
+		for (unsigned int step = 0; step < 4; ++step)
+			method(uninterrupted, static_cast<float>(startProgress.m_stepSize));
+
+		uninterrupted.Reset(size, size, springConstant, damping, mode, mode);
+		const double uninterruptedTime = MeasureSeconds([&]()
+		{
+			for (uint64_t step = 0; step < numSteps; ++step)
+				method(uninterrupted, static_cast<float>(startProgress.m_stepSize));
+		});
+
+		ODESystem::Checkpoint sizeCheckpoint;
+		sizeCheckpoint.Write(startProgress);
+		ODESystem::WriteCheckpoint(sizeCheckpoint, uninterrupted);
+		const double checkpointSize = sizeCheckpoint.GetSize() / 1024.0;
+
+		const auto addRow = [&](const char* pName, uint64_t numRunSteps, unsigned int numSaved, double time, double stallTime, const char* pMatches)
+		{
+			results.AddRow({ pName, Format("%.0f", static_cast<double>(numRunSteps)), Format("%.0f", numSaved), Format("%.0f", checkpointSize), Format("%.1f", 1000.0 * time),
+				(stallTime > 0.0) ? Format("%.1f", 1.0e6 * stallTime) : "-", pMatches });
+		};
+		addRow("Uninterrupted", numSteps, 0, uninterruptedTime, 0.0, "-");
+
+		// saving on the stepping thread blocks it for the whole write
+		System synchronous;
+		synchronous.Reset(size, size, springConstant, damping, mode, mode);
+		unsigned int numSynchronousSaved = 0;
+		double synchronousStallTime = 0.0;
+		const double synchronousTime = MeasureSeconds([&]()
+		{
+			ODESystem::Checkpoint checkpoint;
+			for (uint64_t step = 1; step <= numSteps; ++step)
+			{
+				method(synchronous, static_cast<float>(startProgress.m_stepSize));
+				if (step % checkpointInterval == 0)
+				{
+					synchronousStallTime += MeasureSeconds([&]()
+					{
+						ODESystem::RunProgress progress = startProgress;
+						progress.m_step = step;
+						checkpoint.Clear();
+						checkpoint.Write(progress);
+						ODESystem::WriteCheckpoint(checkpoint, synchronous);
+						numSynchronousSaved += checkpoint.Save(checkpointPath.c_str()) ? 1 : 0;
+					});
+				}
+			}
+		});
+		// no stall is shown when every save failed
+		const double synchronousStall = (numSynchronousSaved > 0) ? synchronousStallTime / numSynchronousSaved : 0.0;
+		addRow("Synchronous Checkpoints", numSteps, numSynchronousSaved, synchronousTime, synchronousStall, isMatching(synchronous, uninterrupted) ? "Yes" : "No");
+
+		// the writer is flushed inside the timing so every checkpoint is on disk by the end
+		System asynchronous;
+		asynchronous.Reset(size, size, springConstant, damping, mode, mode);
+		unsigned int numAsynchronousSaved = 0;
+		const double asynchronousTime = MeasureSeconds([&]()
+		{
+			ODESystem::AsyncCheckpointWriter writer(checkpointPath.c_str());
+			ODESystem::RunProgress progress = startProgress;
+			ODESystem::RunWithCheckpoints<float>(asynchronous, method, progress, numSteps, checkpointInterval, writer);
+			writer.Flush();
+			numAsynchronousSaved = writer.GetNumSaved();
+		});
+
+		// the run hands checkpoints over from inside RunWithCheckpoints, so the stall is measured the same way outside it
+		constexpr unsigned int numStallCheckpoints = 10;
+		ODESystem::AsyncCheckpointWriter stallWriter(checkpointPath.c_str());
+		ODESystem::Checkpoint stallCheckpoint;
+		const double asynchronousStallTime = MeasureSeconds([&]()
+		{
+			for (unsigned int i = 0; i < numStallCheckpoints; ++i)
+			{
+				stallCheckpoint.Write(startProgress);
+				ODESystem::WriteCheckpoint(stallCheckpoint, asynchronous);
+				stallWriter.Submit(stallCheckpoint);
+			}
+		});
+		stallWriter.Flush();
+		addRow("Asynchronous Checkpoints", numSteps, numAsynchronousSaved, asynchronousTime, asynchronousStallTime / numStallCheckpoints, isMatching(asynchronous, uninterrupted) ? "Yes" : "No");
+
+		// killed just before a checkpoint was due, so the steps since the last one are run again
+		const uint64_t numKilledSteps = numSteps / 2 + checkpointInterval - 1;
+		unsigned int numKilledSaved = 0;
+		const double killedTime = MeasureSeconds([&]()
+		{
+			System killed;
+			killed.Reset(size, size, springConstant, damping, mode, mode);
+			ODESystem::AsyncCheckpointWriter writer(checkpointPath.c_str());
+			ODESystem::RunProgress progress = startProgress;
+			ODESystem::RunWithCheckpoints<float>(killed, method, progress, numKilledSteps, checkpointInterval, writer);
+			writer.Flush();
+			numKilledSaved = writer.GetNumSaved();
+		});
+		addRow("Killed Run", numKilledSteps, numKilledSaved, killedTime, 0.0, "-");
+
+		System restarted;
+		ODESystem::RunProgress restartedProgress;
+		bool isRestored = false;
+		unsigned int numRestartedSaved = 0;
+		const double restartedTime = MeasureSeconds([&]()
+		{
+			isRestored = ODESystem::RestoreRun(checkpointPath.c_str(), restarted, restartedProgress);
+			if (!isRestored)
+				return;
+
+			ODESystem::AsyncCheckpointWriter writer(checkpointPath.c_str());
+			const uint64_t firstStep = restartedProgress.m_step;
+			ODESystem::RunWithCheckpoints<float>(restarted, method, restartedProgress, numSteps, checkpointInterval, writer);
+			writer.Flush();
+			numRestartedSaved = writer.GetNumSaved();
+			restartedProgress.m_step -= firstStep;
+		});
+		addRow("Restarted Run", restartedProgress.m_step, numRestartedSaved, restartedTime, 0.0, !isRestored ? "Not Restored" : isMatching(restarted, uninterrupted) ? "Yes" : "No");
+
+		// the adaptive integrator's step size and error history go in with the state, 600 frames of the
+		// damped single spring in double with the run killed and restored at frame 300
+		typedef ODESystem::SingleSpringMassSystemDouble SpringSystem;
+		typedef ODE::AdaptiveRungeKutta<ODE::DormandPrince54, double, 2> Adaptive;
+		constexpr unsigned int numFrames = 600;
+		constexpr double frameDuration = 1.0 / 60.0;
+		ODE::AdaptiveSettings settings;
+		settings.m_absTolerance = 1.0e-9f;
+		settings.m_relTolerance = 1.0e-9f;
+
+		SpringSystem adaptiveSystem;
+		adaptiveSystem.Reset(10.0, 0.5);
+		Adaptive adaptive(settings);
+		for (unsigned int frame = 0; frame < numFrames; ++frame)
+			adaptive.Integrate(adaptiveSystem, frameDuration);
+
+		SpringSystem killedSystem;
+		killedSystem.Reset(10.0, 0.5);
+		Adaptive killedAdaptive(settings);
+		ODESystem::Checkpoint checkpoint;
+		for (unsigned int frame = 0; frame < numFrames / 2; ++frame)
+			killedAdaptive.Integrate(killedSystem, frameDuration);
+		checkpoint.Write(numFrames / 2);
+		checkpoint.Write(killedAdaptive.GetCheckpoint());
+		ODESystem::WriteCheckpoint(checkpoint, killedSystem);
+		const bool isAdaptiveSaved = checkpoint.Save(checkpointPath.c_str());
+
+		SpringSystem restoredSystem;
+		Adaptive restoredAdaptive(settings);
+		Adaptive::Checkpoint adaptiveCheckpoint;
+		unsigned int firstFrame = 0;
+		const bool isAdaptiveRestored = isAdaptiveSaved && checkpoint.Load(checkpointPath.c_str()) && checkpoint.Read(firstFrame) && checkpoint.Read(adaptiveCheckpoint)
+			&& ODESystem::ReadCheckpoint(checkpoint, restoredSystem) && checkpoint.IsFullyRead();
+		restoredAdaptive.Restore(adaptiveCheckpoint);
+		for (unsigned int frame = firstFrame; frame < numFrames && isAdaptiveRestored; ++frame)
+			restoredAdaptive.Integrate(restoredSystem, frameDuration);
+
+		const bool isAdaptiveMatching = (memcmp(&restoredSystem.m_massPos, &adaptiveSystem.m_massPos, sizeof(double)) == 0)
+			&& (memcmp(&restoredSystem.m_massSpeed, &adaptiveSystem.m_massSpeed, sizeof(double)) == 0)
+			&& (restoredAdaptive.GetStats().m_numAcceptedSteps == adaptive.GetStats().m_numAcceptedSteps);
+		results.AddRow({ "Restarted Dormand-Prince 5(4)", Format("%.0f", adaptive.GetStats().m_numAcceptedSteps), "1", Format("%.2f", checkpoint.GetSize() / 1024.0), "-", "-",
+			!isAdaptiveRestored ? "Not Restored" : isAdaptiveMatching ? "Yes" : "No" });
+
+		std::error_code error;
+		std::filesystem::remove(checkpointPath, error);
+	}
+
+
+	// A chain of soft springs with every hundredth spring a thousand times stiffer, so the stiff springs ring
+	// over thirty times faster.  Single rate Verlet has to step every mass at the rate the stiff springs
+	// need, the multirate method only subcycles the masses on either end of them.  Errors are against single
+	// rate Verlet at a far smaller step.
+	void MultirateBenchmark(ResultTable& results)
+	{
+		typedef ODEMultirate::MultirateVerlet<float> Method;
+
+		constexpr unsigned int numMasses = 20000;
+		constexpr float softSpringConstant = 100.0f;
+		constexpr float stiffSpringConstant = 100000.0f;
+		constexpr unsigned int stiffSpacing = 100;
+		constexpr float damping = 0.1f;
+		constexpr float stepSize = 1.0f / 60.0f;
+		constexpr unsigned int numSteps = 60;
+		constexpr unsigned int numReferenceSubSteps = 256;
+
+		ODESystem::HeterogeneousSpringChain chain;
+		chain.Reset(numMasses, softSpringConstant, stiffSpringConstant, stiffSpacing, damping);
+		std::vector<ODEMultirate::Range> fastRanges;
+		chain.GetStiffRanges(softSpringConstant, fastRanges);
+
+		unsigned int numFastMasses = 0;
+		for (const ODEMultirate::Range& range : fastRanges)
+			numFastMasses += range.m_end - range.m_begin;
+
+		const auto run = [&](ODESystem::HeterogeneousSpringChain& runChain, Method& method, unsigned int numSubSteps)
+		{
+			runChain.Reset(numMasses, softSpringConstant, stiffSpringConstant, stiffSpacing, damping);
+			for (unsigned int step = 0; step < numSteps * numSubSteps; ++step)
+				method.Step(runChain, stepSize / numSubSteps);
+		};
+
+		ODESystem::HeterogeneousSpringChain reference;
+		Method referenceMethod;
+		run(reference, referenceMethod, numReferenceSubSteps);
+
+		std::vector<bool> isFastMass(numMasses, false);
+		for (const ODEMultirate::Range& range : fastRanges)
+			std::fill(isFastMass.begin() + range.m_begin, isFastMass.begin() + range.m_end, true);
+
+		// the stiff springs' ringing is far out of phase at any of these steps, so the soft masses get their own error
+		results.m_columns = { "Method", "Step Size", "Fast Substeps", "Fast Masses", "Evaluations", "Max Error", "Soft Mass Max Error", "Time (ms)" };
+		const auto addRow = [&](const char* pName, unsigned int numSubSteps, unsigned int numFastSubSteps, const std::vector<ODEMultirate::Range>& runFastRanges,
+			unsigned int numRunFastMasses)
+		{
+			ODESystem::HeterogeneousSpringChain runChain;
+			Method method(runFastRanges, numFastSubSteps);
+			const double time = MeasureSeconds([&]() { run(runChain, method, numSubSteps); });
+
+			float maxError = 0.0f;
+			float softMaxError = 0.0f;
+			for (unsigned int i = 0; i < numMasses; ++i)
+			{
+				const float error = fabsf(runChain.GetPositions()[i] - reference.GetPositions()[i]);
+				maxError = std::max(maxError, error);
+				softMaxError = isFastMass[i] ? softMaxError : std::max(softMaxError, error);
+			}
+
+			const ODEMultirate::MultirateStats& stats = method.GetStats();
+			results.AddRow({ pName, Format("%.2e", stepSize / numSubSteps), Format("%.0f", numFastSubSteps), Format("%.0f", numRunFastMasses),
+				Format("%.3e", static_cast<double>(stats.m_numFastEvaluations + stats.m_numSlowEvaluations)),
+				(maxError < 1.0f) ? Format("%.2e", maxError) : "unstable", (maxError < 1.0f) ? Format("%.2e", softMaxError) : "unstable", Format("%.1f", 1000.0 * time) });
+		};
+
+		const std::vector<ODEMultirate::Range> noFastRanges;
+		for (unsigned int numSubSteps : { 1, 16, 32, 64 })
+			addRow("Velocity Verlet", numSubSteps, 1, noFastRanges, 0);
+
+		for (unsigned int numFastSubSteps : { 16, 32, 64 })
+			addRow("Multirate Verlet", 1, numFastSubSteps, fastRanges, numFastMasses);
+	}
+
+
+	void XPBDClothBenchmark(ResultTable& results)
+	{
+		typedef ODESystem::DynamicStateData<float> State;
+		typedef ODESystem::SpringNetworkSystem System;
+
+		constexpr unsigned int clothSize = 64;
+		constexpr float totalMass = 1.0f;
+		constexpr float springConstant = 1000.0f;
+		constexpr float frameTime = 1.0f / 60.0f;
+		constexpr unsigned int numFrames = 60;
+		constexpr unsigned int numReferenceSubSteps = 256;
+
+		ODESystem::SpringNetwork cloth;
+		cloth.BuildCloth(clothSize, clothSize, 1.0f, totalMass, springConstant);
+
+		XPBD::ParticleStore particles;
+		XPBD::DistanceConstraints constraints;
+		cloth.CreateXPBD(particles, constraints);
+		const unsigned int numColours = constraints.GetNumColours();
+
+		const auto runSemiImplicit = [&](unsigned int numSubSteps, float& maxStrain)
+		{
+			System system;
+			system.Reset(cloth);
+			const float stepSize = frameTime / numSubSteps;
+			const double time = MeasureSeconds([&]()
+			{
+				for (unsigned int step = 0; step < numFrames * numSubSteps; ++step)
+					ODE::SemiImplicitEuler<State, 2, System>(system, stepSize);
+			});
+			maxStrain = cloth.GetMaxStrain(system.m_positions.m_data.data());
+			return time;
+		};
+
+		// The springs at a small enough step are the behaviour being approximated, so the strain error is how
+		// far a method's cloth is from it.  XPBD with too few iterations stretches a long way but stays finite,
+		// while an unstable explicit step overflows.
+		float referenceStrain = 0.0f;
+		const double referenceTime = runSemiImplicit(numReferenceSubSteps, referenceStrain);
+
+		results.m_columns = { "Method", "Substeps", "Iterations", "Colours", "Max Strain", "Strain Error", "Time per Frame (ms)" };
+		const auto addRow = [&](const char* pName, unsigned int numSubSteps, const std::string& iterations, const std::string& colours, float maxStrain, double time)
+		{
+			const bool isStable = (maxStrain <= 1.0e3f);
+			results.AddRow({ pName, Format("%.0f", numSubSteps), iterations, colours, isStable ? Format("%.3f", maxStrain) : "unstable",
+				isStable ? Format("%.3f", fabsf(maxStrain - referenceStrain)) : "-", Format("%.3f", 1000.0 * time / numFrames) });
+		};
+
+		addRow("Semi-Implicit Euler (reference)", numReferenceSubSteps, "-", "-", referenceStrain, referenceTime);
+		for (unsigned int numSubSteps : { 1, 8, 32, 64, 128 })
+		{
+			float maxStrain = 0.0f;
+			const double time = runSemiImplicit(numSubSteps, maxStrain);
+			addRow("Semi-Implicit Euler", numSubSteps, "-", "-", maxStrain, time);
+		}
+
+		struct Config
+		{
+			unsigned int m_numSubSteps;
+			unsigned int m_numIterations;
+		};
+
+		const auto runXPBD = [&](const char* pName, const Config& config, const auto& parallelFor)
+		{
+			cloth.CreateXPBD(particles, constraints);
+			XPBD::Settings settings;
+			settings.m_numSubSteps = config.m_numSubSteps;
+			settings.m_numIterations = config.m_numIterations;
+			const double time = MeasureSeconds([&]()
+			{
+				for (unsigned int frame = 0; frame < numFrames; ++frame)
+					XPBD::Step(particles, constraints, frameTime, settings, parallelFor);
+			});
+			addRow(pName, config.m_numSubSteps, Format("%.0f", config.m_numIterations), Format("%.0f", numColours), cloth.GetMaxStrain(particles.m_positions.data()), time);
+		};
+
+		const Config configs[] = { { 1, 4 }, { 1, 16 }, { 1, 64 }, { 4, 4 }, { 16, 1 }, { 64, 1 } };
+		for (const Config& config : configs)
+			runXPBD("XPBD", config, XPBD::SerialFor());
+
+		// each colour is a parallel loop over blocks of its constraints with a wait between the colours
+		ThreadPool threadPool;
+		const auto parallelFor = [&threadPool](size_t count, const ThreadPool::ParallelFunc& func) { threadPool.ParallelFor(count, func); };
+		for (const Config& config : { configs[1], configs[4] })
+			runXPBD("XPBD (thread pool)", config, parallelFor);
+	}
+
+	void StaticDispatchBenchmark(ResultTable& results)
+	{
+		results.m_columns = { "System", "Method", "Virtual (ns/step)", "Static (ns/step)", "Speedup", "Max Difference" };
+		AddDispatchRows<ODESystem::SingleSpringMassSystem, float>(results, "Single Spring");
+		AddDispatchRows<ODESystem::CoupledSpringMassSystem, ODESystem::StateData<float, 2>>(results, "Coupled Springs");
+	}
+}
+
+
+
+ODEBenchmarkWidget::ODEBenchmarkWidget(std::weak_ptr<MessageBus> pMessageBus)
+	: IWindowWidget(pMessageBus)
+{
+	m_benchmarks.push_back(Benchmark("Batched Spring Mass (50k systems)", BatchedSpringMassBenchmark));
+	m_benchmarks.push_back(Benchmark("Adaptive Step Size (k = 1000)", AdaptiveStepSizeBenchmark));
+	m_benchmarks.push_back(Benchmark("Implicit Methods (stiff coupled springs)", ImplicitStiffBenchmark));
+	m_benchmarks.push_back(Benchmark("Static vs Virtual Dispatch (10k systems)", StaticDispatchBenchmark));
+	m_benchmarks.push_back(Benchmark("Butcher Tableau Engine (10k systems)", TableauEngineBenchmark));
+	m_benchmarks.push_back(Benchmark("Dense Output Resampling (1200 Hz)", DenseOutputBenchmark));
+	m_benchmarks.push_back(Benchmark("Mixed Precision (single spring, 600 s)", MixedPrecisionBenchmark));
+	m_benchmarks.push_back(Benchmark("Parameter Sweep Scaling (100x100x6)", ParameterSweepScalingBenchmark));
+	m_benchmarks.push_back(Benchmark("Parameter Sweep Errors (100x100x6)", ParameterSweepErrorBenchmark));
+	m_benchmarks.push_back(Benchmark("Symplectic Composition (single spring, 1000 s)", SymplecticCompositionBenchmark));
+	m_benchmarks.push_back(Benchmark("Spring Chains and Lattices (up to 1M masses)", SpringLatticeBenchmark));
+	m_benchmarks.push_back(Benchmark("N-Body Direct vs Barnes-Hut (up to 1M bodies)", NBodyBenchmark));
+	m_benchmarks.push_back(Benchmark("Transition Matrix vs RK4 (10k systems)", TransitionMatrixBenchmark));
+	m_benchmarks.push_back(Benchmark("Analytical Solutions, C Library vs SIMD (600 s)", AnalyticalSolutionBenchmark));
+	m_benchmarks.push_back(Benchmark("Event Detection (single spring, 60 s)", EventDetectionBenchmark));
+	m_benchmarks.push_back(Benchmark("SDE Ensemble (10k paths, 10 s)", StochasticEnsembleBenchmark));
+	m_benchmarks.push_back(Benchmark("Expression Templates, Eager vs Lazy StateData", ExpressionTemplateBenchmark));
+	m_benchmarks.push_back(Benchmark("Trajectory File Streaming", TrajectoryFileBenchmark));
+	m_benchmarks.push_back(Benchmark("Parareal vs Serial (10 min spring, double)", PararealBenchmark));
+	m_benchmarks.push_back(Benchmark("Dual Number Jacobians (stiff coupled springs)", DualJacobianBenchmark));
+	m_benchmarks.push_back(Benchmark("Dual Number Sensitivities (single spring, 10 s)", DualSensitivityBenchmark));
+	m_benchmarks.push_back(Benchmark("Checkpoint and Restart (256x256 lattice)", CheckpointBenchmark));
+	m_benchmarks.push_back(Benchmark("Multirate vs Single Rate (stiff springs in a 20k chain)", MultirateBenchmark));
+	m_benchmarks.push_back(Benchmark("XPBD vs Semi-Implicit Euler (64x64 cloth, 60 Hz)", XPBDClothBenchmark));
+}
+
+
+void ODEBenchmarkWidget::OnMessage(const MessageType& message)
+{
+}
+
+
+const char* ODEBenchmarkWidget::GetWindowName() const
+{
+	return "ODE Benchmarks";
+}
+
+
+void ODEBenchmarkWidget::RenderContents(float deltaTime)
+{
+	for (Benchmark& benchmark : m_benchmarks)
+	{
+		ImGui::PushID(benchmark.m_name);
+		if (ImGui::CollapsingHeader(benchmark.m_name, ImGuiTreeNodeFlags_DefaultOpen))
+		{
+			if (ImGui::Button("Run"))
+			{
+				benchmark.m_results = ResultTable();
+				benchmark.m_runTime = MeasureSeconds([&benchmark]() { benchmark.m_run(benchmark.m_results); });
+			}
+
+			const ResultTable& results = benchmark.m_results;
+			if (!results.m_rows.empty())
+			{
+				ImGui::SameLine();
+				ImGui::Text("Completed in %.2fs", benchmark.m_runTime);
+
+				const int numColumns = static_cast<int>(results.m_columns.size());
+				if (ImGui::BeginTable("Results", numColumns, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+				{
+					for (const std::string& column : results.m_columns)
+						ImGui::TableSetupColumn(column.c_str());
+					ImGui::TableHeadersRow();
+
+					for (const std::vector<std::string>& row : results.m_rows)
+					{
+						ImGui::TableNextRow();
+						for (int columnIndex = 0; columnIndex < numColumns && columnIndex < static_cast<int>(row.size()); ++columnIndex)
+						{
+							ImGui::TableSetColumnIndex(columnIndex);
+							ImGui::TextUnformatted(row[columnIndex].c_str());
+						}
+					}
+					ImGui::EndTable();
+				}
+			}
+		}
+		ImGui::PopID();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+
+#include "Widgets/WindowWidget.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+
+
+class ODEBenchmarkWidget : public IWindowWidget
+{
+public:
+	ODEBenchmarkWidget(std::weak_ptr<MessageBus> pMessageBus);
+
+	struct ResultTable
+	{
+		void AddRow(const std::vector<std::string>& row) { m_rows.push_back(row); }
+
+		std::vector<std::string> m_columns;
+		std::vector<std::vector<std::string>> m_rows;
+	};
+
+private:
+	virtual void OnMessage(const MessageType& message) override;
+	virtual const char* GetWindowName() const override;
+	virtual void RenderContents(float deltaTime) override;
+
+	struct Benchmark
+	{
+		Benchmark(const char* name, std::function<void(ResultTable&)> run) : m_name(name), m_run(run) {}
+		const char* m_name = nullptr;
+		std::function<void(ResultTable&)> m_run;
+		ResultTable m_results;
+		double m_runTime = 0.0;
+	};
+
+	std::vector<Benchmark> m_benchmarks;
+};
\ No newline at end of file
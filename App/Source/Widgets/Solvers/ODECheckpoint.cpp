@@ -0,0 +1,235 @@
+#include "Widgets/Solvers/ODECheckpoint.h"
+#include <filesystem>
+#include <stdio.h>
+#include <utility>
+
+
+
+namespace ODESystem
+{
+	namespace
+	{
+		// the bytes of the checkpoint follow the header, in the byte order of the machine that wrote them
+		struct FileHeader
+		{
+			char m_magic[8];
+			uint32_t m_version;
+			uint32_t m_reserved;
+			uint64_t m_size;
+			uint64_t m_checksum;
+		};
+
+		constexpr char fileMagic[8] = "ODECHKP";
+		constexpr uint32_t fileVersion = 1;
+
+
+		// FNV-1a, only there to catch a file that was cut short or corrupted rather than to resist tampering
+		uint64_t GetChecksum(const uint8_t* pBytes, size_t size)
+		{
+			uint64_t checksum = 14695981039346656037ull;
+			for (size_t i = 0; i < size; ++i)
+				checksum = (checksum ^ pBytes[i]) * 1099511628211ull;
+			return checksum;
+		}
+	}
+
+
+
+	bool Checkpoint::Save(const char* pFileName) const
+	{
+		const std::string tempFileName = std::string(pFileName) + ".tmp";
+		FILE* pFile = fopen(tempFileName.c_str(), "wb");
+		if (!pFile)
+			return false;
+
+		FileHeader header = {};
+		memcpy(header.m_magic, fileMagic, sizeof(fileMagic));
+		header.m_version = fileVersion;
+		header.m_size = m_bytes.size();
+		header.m_checksum = GetChecksum(m_bytes.data(), m_bytes.size());
+
+		bool isWritten = (fwrite(&header, sizeof(header), 1, pFile) == 1) && (m_bytes.empty() || fwrite(m_bytes.data(), m_bytes.size(), 1, pFile) == 1);
+		isWritten &= (fclose(pFile) == 0);
+
+		std::error_code error;
+		if (isWritten)
+			std::filesystem::rename(tempFileName, pFileName, error);
+
+		if (!isWritten || error)
+		{
+			std::filesystem::remove(tempFileName, error);
+			return false;
+		}
+
+		return true;
+	}
+
+
+	bool Checkpoint::Load(const char* pFileName)
+	{
+		Clear();
+
+		std::error_code error;
+		const uintmax_t fileSize = std::filesystem::file_size(pFileName, error);
+		if (error || fileSize < sizeof(FileHeader))
+			return false;
+
+		FILE* pFile = fopen(pFileName, "rb");
+		if (!pFile)
+			return false;
+
+		FileHeader header;
+		bool isRead = (fread(&header, sizeof(header), 1, pFile) == 1) && (memcmp(header.m_magic, fileMagic, sizeof(fileMagic)) == 0)
+			&& (header.m_version == fileVersion) && (header.m_size == fileSize - sizeof(FileHeader));
+
+		if (isRead)
+		{
+			m_bytes.resize(static_cast<size_t>(header.m_size));
+			isRead = (m_bytes.empty() || fread(m_bytes.data(), m_bytes.size(), 1, pFile) == 1) && (GetChecksum(m_bytes.data(), m_bytes.size()) == header.m_checksum);
+		}
+		fclose(pFile);
+
+		if (!isRead)
+			Clear();
+		return isRead;
+	}
+
+
+
+	AsyncCheckpointWriter::AsyncCheckpointWriter(const char* pFileName)
+		: m_fileName(pFileName)
+	{
+		m_worker = std::thread(&AsyncCheckpointWriter::WorkerLoop, this);
+	}
+
+
+	AsyncCheckpointWriter::~AsyncCheckpointWriter()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_workAvailable.notify_one();
+		m_worker.join();
+	}
+
+
+	void AsyncCheckpointWriter::Submit(Checkpoint& checkpoint)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_hasWaiting)
+				++m_numReplaced;
+
+			std::swap(m_waiting, checkpoint);
+			m_hasWaiting = true;
+		}
+		m_workAvailable.notify_one();
+		checkpoint.Clear();
+	}
+
+
+	void AsyncCheckpointWriter::Flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workDone.wait(lock, [this]() { return !m_hasWaiting && !m_isSaving; });
+	}
+
+
+	unsigned int AsyncCheckpointWriter::GetNumSaved() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_numSaved;
+	}
+
+
+	unsigned int AsyncCheckpointWriter::GetNumReplaced() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_numReplaced;
+	}
+
+
+	bool AsyncCheckpointWriter::IsFailed() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_isFailed;
+	}
+
+
+	// the waiting and saving buffers swap rather than copy, so the submitting thread only ever waits for a swap
+	void AsyncCheckpointWriter::WorkerLoop()
+	{
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workAvailable.wait(lock, [this]() { return m_hasWaiting || m_isStopping; });
+				if (!m_hasWaiting)
+					return;
+
+				std::swap(m_saving, m_waiting);
+				m_hasWaiting = false;
+				m_isSaving = true;
+			}
+
+			const bool isSaved = m_saving.Save(m_fileName.c_str());
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_isSaving = false;
+				if (isSaved)
+					++m_numSaved;
+				else
+					m_isFailed = true;
+			}
+			m_workDone.notify_all();
+		}
+	}
+
+
+
+	void WriteCheckpoint(Checkpoint& checkpoint, const CoupledSpringMassSystem& system)
+	{
+		checkpoint.Write(ECheckpointSystem::CoupledSpringMass);
+		checkpoint.Write<uint32_t>(sizeof(float));
+		checkpoint.Write(system.m_massPos);
+		checkpoint.Write(system.m_massSpeed);
+		checkpoint.Write(system.m_springConstant);
+		checkpoint.Write(system.m_damping);
+	}
+
+
+	bool ReadCheckpoint(Checkpoint& checkpoint, CoupledSpringMassSystem& system)
+	{
+		ECheckpointSystem type;
+		uint32_t scalarSize = 0;
+		if (!checkpoint.Read(type) || type != ECheckpointSystem::CoupledSpringMass || !checkpoint.Read(scalarSize) || scalarSize != sizeof(float))
+			return false;
+
+		return checkpoint.Read(system.m_massPos) && checkpoint.Read(system.m_massSpeed) && checkpoint.Read(system.m_springConstant) && checkpoint.Read(system.m_damping);
+	}
+
+
+	void WriteCheckpoint(Checkpoint& checkpoint, const SpringLatticeSystem& system)
+	{
+		checkpoint.Write(ECheckpointSystem::SpringLattice);
+		checkpoint.Write<uint32_t>(sizeof(float));
+		checkpoint.Write(system.m_lattice);
+		checkpoint.Write(system.m_massPos.m_data);
+		checkpoint.Write(system.m_massSpeed.m_data);
+	}
+
+
+	// the state has to cover the whole lattice it was saved with
+	bool ReadCheckpoint(Checkpoint& checkpoint, SpringLatticeSystem& system)
+	{
+		ECheckpointSystem type;
+		uint32_t scalarSize = 0;
+		if (!checkpoint.Read(type) || type != ECheckpointSystem::SpringLattice || !checkpoint.Read(scalarSize) || scalarSize != sizeof(float))
+			return false;
+
+		return checkpoint.Read(system.m_lattice) && checkpoint.Read(system.m_massPos.m_data) && checkpoint.Read(system.m_massSpeed.m_data)
+			&& (system.m_massPos.m_data.size() == system.m_lattice.GetNumMasses()) && (system.m_massSpeed.m_data.size() == system.m_lattice.GetNumMasses());
+	}
+}
\ No newline at end of file
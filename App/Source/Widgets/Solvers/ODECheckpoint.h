@@ -0,0 +1,242 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODESpringLattice.h"
+#include "Widgets/Solvers/ODEWidget.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+
+namespace ODESystem
+{
+	// A snapshot of a run as a flat buffer of bytes, written and then read back field by field in the same
+	// order.  Only trivially copyable values go in as they are, so a snapshot is restored bit for bit but
+	// only by a build with the same layouts.
+	class Checkpoint
+	{
+	public:
+		template<typename V>
+		void Write(const V& value)
+		{
+			static_assert(std::is_trivially_copyable_v<V>);
+			WriteBytes(&value, sizeof(V));
+		}
+
+		template<typename V>
+		void Write(const std::vector<V>& values)
+		{
+			static_assert(std::is_trivially_copyable_v<V>);
+			Write<uint64_t>(values.size());
+			WriteBytes(values.data(), values.size() * sizeof(V));
+		}
+
+		// fails once a read would run past the end, and every read after it fails too
+		template<typename V>
+		bool Read(V& value)
+		{
+			static_assert(std::is_trivially_copyable_v<V>);
+			return ReadBytes(&value, sizeof(V));
+		}
+
+		template<typename V>
+		bool Read(std::vector<V>& values)
+		{
+			static_assert(std::is_trivially_copyable_v<V>);
+			uint64_t size = 0;
+			if (!Read(size) || size > (m_bytes.size() - m_readOffset) / sizeof(V))
+				return Fail();
+
+			values.resize(static_cast<size_t>(size));
+			return ReadBytes(values.data(), values.size() * sizeof(V));
+		}
+
+		// keeps the buffer so that writing the next snapshot doesn't allocate
+		void Clear()
+		{
+			m_bytes.clear();
+			m_readOffset = 0;
+			m_isFailed = false;
+		}
+
+		size_t GetSize() const { return m_bytes.size(); }
+		bool IsFullyRead() const { return !m_isFailed && m_readOffset == m_bytes.size(); }
+
+		// Saving writes a file beside the named one and then renames it over the top, so a run killed while
+		// saving still leaves the last complete checkpoint.  Loading checks the checksum before reading starts.
+		bool Save(const char* pFileName) const;
+		bool Load(const char* pFileName);
+
+	private:
+		void WriteBytes(const void* pData, size_t size)
+		{
+			const size_t offset = m_bytes.size();
+			m_bytes.resize(offset + size);
+			if (size > 0)
+				memcpy(m_bytes.data() + offset, pData, size);
+		}
+
+		bool ReadBytes(void* pData, size_t size)
+		{
+			if (m_isFailed || size > m_bytes.size() - m_readOffset)
+				return Fail();
+
+			if (size > 0)
+				memcpy(pData, m_bytes.data() + m_readOffset, size);
+			m_readOffset += size;
+			return true;
+		}
+
+		bool Fail()
+		{
+			m_isFailed = true;
+			return false;
+		}
+
+		std::vector<uint8_t> m_bytes;
+		size_t m_readOffset = 0;
+		bool m_isFailed = false;
+	};
+
+
+	// Saves checkpoints on a thread of its own, so a run only waits for its checkpoint to be handed over
+	// and never for the disk.  A checkpoint submitted while the last is still being saved replaces any
+	// other still waiting, as only the latest is worth keeping.  The destructor saves whatever is waiting.
+	class AsyncCheckpointWriter
+	{
+	public:
+		AsyncCheckpointWriter(const char* pFileName);
+		AsyncCheckpointWriter(const AsyncCheckpointWriter&) = delete;
+		AsyncCheckpointWriter& operator = (const AsyncCheckpointWriter&) = delete;
+		~AsyncCheckpointWriter();
+
+		// takes the bytes of the checkpoint and leaves it with a spare buffer to write the next one into
+		void Submit(Checkpoint& checkpoint);
+
+		// blocks until every checkpoint submitted so far is saved or replaced
+		void Flush();
+
+		unsigned int GetNumSaved() const;
+		unsigned int GetNumReplaced() const;
+		bool IsFailed() const;
+
+	private:
+		void WorkerLoop();
+
+		std::string m_fileName;
+		Checkpoint m_waiting;
+		Checkpoint m_saving;
+		unsigned int m_numSaved = 0;
+		unsigned int m_numReplaced = 0;
+		bool m_hasWaiting = false;
+		bool m_isSaving = false;
+		bool m_isFailed = false;
+		bool m_isStopping = false;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_workAvailable;
+		std::condition_variable m_workDone;
+		std::thread m_worker;
+	};
+
+
+	// where a fixed step run is up to, the step size is kept as a double and converted back exactly
+	struct RunProgress
+	{
+		uint64_t m_step = 0;
+		uint64_t m_numSteps = 0;
+		double m_stepSize = 0.0;
+	};
+
+
+	// SYSTEMS
+
+	// written ahead of each system along with the size of its scalar, so a snapshot can't be read back into
+	// the wrong system or precision
+	enum class ECheckpointSystem : uint32_t
+	{
+		SingleSpringMass,
+		CoupledSpringMass,
+		SpringLattice
+	};
+
+
+	// The parameters go in with the state so a run restores without knowing how it was set up.
+	template<typename S>
+	void WriteCheckpoint(Checkpoint& checkpoint, const SingleSpringMassSystemT<S>& system)
+	{
+		checkpoint.Write(ECheckpointSystem::SingleSpringMass);
+		checkpoint.Write<uint32_t>(sizeof(S));
+		checkpoint.Write(system.m_massPos);
+		checkpoint.Write(system.m_massSpeed);
+		checkpoint.Write(system.m_springConstant);
+		checkpoint.Write(system.m_damping);
+	}
+
+	template<typename S>
+	bool ReadCheckpoint(Checkpoint& checkpoint, SingleSpringMassSystemT<S>& system)
+	{
+		ECheckpointSystem type;
+		uint32_t scalarSize = 0;
+		if (!checkpoint.Read(type) || type != ECheckpointSystem::SingleSpringMass || !checkpoint.Read(scalarSize) || scalarSize != sizeof(S))
+			return false;
+
+		return checkpoint.Read(system.m_massPos) && checkpoint.Read(system.m_massSpeed) && checkpoint.Read(system.m_springConstant) && checkpoint.Read(system.m_damping);
+	}
+
+	void WriteCheckpoint(Checkpoint& checkpoint, const CoupledSpringMassSystem& system);
+	bool ReadCheckpoint(Checkpoint& checkpoint, CoupledSpringMassSystem& system);
+	void WriteCheckpoint(Checkpoint& checkpoint, const SpringLatticeSystem& system);
+	bool ReadCheckpoint(Checkpoint& checkpoint, SpringLatticeSystem& system);
+
+
+	// RUNS
+
+	// Steps a fixed step run on from its progress by up to numSteps, stopping early at the end of the run,
+	// and submits a checkpoint of the progress and the system after every interval steps of the whole run.
+	// Restoring one with RestoreRun and carrying on finishes the run with exactly the state an uninterrupted
+	// run ends with.  Scalar is the step size type the method takes.
+	template<typename Scalar, typename System, typename Method>
+	void RunWithCheckpoints(System& system, const Method& method, RunProgress& progress, uint64_t numSteps, uint64_t checkpointInterval, AsyncCheckpointWriter& writer)
+	{
+		const Scalar stepSize = static_cast<Scalar>(progress.m_stepSize);
+		const uint64_t endStep = progress.m_step + std::min(numSteps, progress.m_numSteps - progress.m_step);
+
+		Checkpoint checkpoint;
+		while (progress.m_step < endStep)
+		{
+			method(system, stepSize);
+			++progress.m_step;
+
+			if (checkpointInterval > 0 && progress.m_step % checkpointInterval == 0)
+			{
+				checkpoint.Clear();
+				checkpoint.Write(progress);
+				WriteCheckpoint(checkpoint, system);
+				writer.Submit(checkpoint);
+			}
+		}
+	}
+
+	// leaves the system and progress untouched unless the whole checkpoint reads back
+	template<typename System>
+	bool RestoreRun(const char* pFileName, System& system, RunProgress& progress)
+	{
+		Checkpoint checkpoint;
+		RunProgress restoredProgress;
+		System restoredSystem = system;
+		if (!checkpoint.Load(pFileName) || !checkpoint.Read(restoredProgress) || !ReadCheckpoint(checkpoint, restoredSystem) || !checkpoint.IsFullyRead())
+			return false;
+
+		system = std::move(restoredSystem);
+		progress = restoredProgress;
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,563 @@
+#include "Widgets/Solvers/ODEConvergence.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+
+
+namespace ODESystem
+{
+	// forwards to the system and counts the evaluations of its derivative function
+	template<typename T>
+	class CountingState final : public ODE::IState<T, 2>
+	{
+	public:
+		CountingState(ODE::IState<T, 2>& state)
+			: m_state(state)
+		{
+		}
+
+		virtual void GetDerivatives(std::array<T, 2>& derivatives) const override
+		{
+			m_state.GetDerivatives(derivatives);
+		}
+
+		virtual T GetNthDerivative(const std::array<T, 2>& derivatives) const override
+		{
+			++m_numEvaluations;
+			return m_state.GetNthDerivative(derivatives);
+		}
+
+		virtual void SetDerivatives(const std::array<T, 2>& derivatives) override
+		{
+			m_state.SetDerivatives(derivatives);
+		}
+
+		// forwarded so the implicit methods use the analytic jacobian rather than finite differences
+		virtual bool GetNthDerivativeJacobian(const std::array<T, 2>& derivatives, ODE::ScalarType<T>* jacobian) const override
+		{
+			return m_state.GetNthDerivativeJacobian(derivatives, jacobian);
+		}
+
+		size_t GetNumEvaluations() const { return m_numEvaluations; }
+
+	private:
+		ODE::IState<T, 2>& m_state;
+		mutable size_t m_numEvaluations = 0;
+	};
+
+
+	template<typename S>
+	void GetPositions(const SingleSpringMassSystemT<S>& system, double* positions)
+	{
+		positions[0] = system.m_massPos;
+	}
+
+
+	static void GetPositions(const CoupledSpringMassSystem& system, double* positions)
+	{
+		positions[0] = system.m_massPos[0];
+		positions[1] = system.m_massPos[1];
+	}
+
+
+	template<typename S>
+	unsigned int SolveAnalytical(const SingleSpringMassSystemT<S>& system, const std::vector<S>& timeData, std::vector<S>* positionData)
+	{
+		system.SolveAnalytical(timeData, positionData[0]);
+		return 1;
+	}
+
+
+	static unsigned int SolveAnalytical(const CoupledSpringMassSystem& system, const std::vector<float>& timeData, std::vector<float>* positionData)
+	{
+		system.SolveAnalytical(timeData, positionData[0], positionData[1]);
+		return 2;
+	}
+
+
+	template<typename System, typename T>
+	ConvergenceRun RunMethod(const ConvergenceSettings& settings, const SpringMethod<T>& prototype, float stepSize, float tolerance)
+	{
+		typedef ODE::ScalarType<T> Scalar;
+
+		ConvergenceRun run;
+		run.m_stepSize = stepSize;
+		run.m_tolerance = tolerance;
+		run.m_numSteps = static_cast<unsigned int>(ceilf(settings.m_duration / stepSize));
+
+		std::vector<Scalar> timeData(run.m_numSteps + 1);
+		for (unsigned int i = 0; i <= run.m_numSteps; ++i)
+			timeData[i] = i * static_cast<Scalar>(stepSize);
+
+		System system;
+		system.Reset(settings.m_springConstant, settings.m_damping);
+		std::vector<Scalar> analyticalData[2];
+		const unsigned int numPositions = SolveAnalytical(system, timeData, analyticalData);
+
+		// the error and evaluations come from a run through the counting state
+		CountingState<T> countingState(system);
+		SpringMethod<T> method = prototype;
+		double maxError = 0.0;
+		bool isFinite = true;
+		for (unsigned int i = 1; i <= run.m_numSteps; ++i)
+		{
+			method(countingState, stepSize);
+
+			double positions[2];
+			GetPositions(system, positions);
+			for (unsigned int j = 0; j < numPositions; ++j)
+			{
+				isFinite &= isfinite(positions[j]);
+				maxError = std::max(maxError, fabs(positions[j] - analyticalData[j][i]));
+			}
+		}
+		run.m_maxError = isFinite ? maxError : NAN;
+		run.m_evaluationsPerStep = static_cast<double>(countingState.GetNumEvaluations()) / run.m_numSteps;
+
+		// Timed on the system directly, repeating short runs so the clock resolution doesn't matter.  Every
+		// repeat gets its own system and copy of the method, made up front, so stateful methods start fresh.
+		// The fastest of a few trials is kept as the others mostly measure whatever else the machine is doing.
+		const unsigned int numRepeats = std::max(1u, settings.m_minTimedSteps / run.m_numSteps);
+		double minSeconds = INFINITY;
+		for (unsigned int trial = 0; trial < settings.m_numTimingTrials; ++trial)
+		{
+			std::vector<System> systems(numRepeats);
+			std::vector<SpringMethod<T>> methods(numRepeats, prototype);
+			for (System& repeatSystem : systems)
+				repeatSystem.Reset(settings.m_springConstant, settings.m_damping);
+
+			const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+			for (unsigned int repeat = 0; repeat < numRepeats; ++repeat)
+				for (unsigned int i = 0; i < run.m_numSteps; ++i)
+					methods[repeat](systems[repeat], stepSize);
+			minSeconds = std::min(minSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+		}
+		run.m_nanosecondsPerStep = 1.0e9 * minSeconds / (static_cast<double>(numRepeats) * run.m_numSteps);
+
+		return run;
+	}
+
+
+	template<typename System, typename T>
+	void AddSystemSeries(const ConvergenceSettings& settings, const char* systemName, std::vector<ConvergenceSeries>& series)
+	{
+		// errors this small are mostly rounding over the thousands of steps
+		const double noiseFloor = std::is_same_v<ODE::ScalarType<T>, float> ? 1.0e-5 : 1.0e-11;
+
+		// the fixed step methods come first, then the adaptive methods over the tolerances
+		for (bool isAdaptive : { false, true })
+		{
+			for (unsigned int methodIndex = 0; methodIndex < static_cast<unsigned int>(ESpringMethod::NUM_METHODS); ++methodIndex)
+			{
+				const ESpringMethod method = static_cast<ESpringMethod>(methodIndex);
+				if (IsAdaptiveSpringMethod(method) != isAdaptive)
+					continue;
+
+				ConvergenceSeries methodSeries;
+				methodSeries.m_systemName = systemName;
+				methodSeries.m_methodName = GetSpringMethodName(method);
+				methodSeries.m_noiseFloor = noiseFloor;
+				methodSeries.m_isAdaptive = isAdaptive;
+				if (!isAdaptive)
+				{
+					const SpringMethod<T> springMethod = MakeSpringMethod<T>(method, ODE::AdaptiveSettings());
+					for (float stepSize : settings.m_stepSizes)
+						methodSeries.m_runs.push_back(RunMethod<System, T>(settings, springMethod, stepSize, 0.0f));
+					methodSeries.m_order = FitConvergenceOrder(methodSeries.m_runs, noiseFloor);
+				}
+				else
+				{
+					for (float tolerance : settings.m_tolerances)
+					{
+						ODE::AdaptiveSettings adaptiveSettings;
+						adaptiveSettings.m_absTolerance = tolerance;
+						adaptiveSettings.m_relTolerance = tolerance;
+						methodSeries.m_runs.push_back(RunMethod<System, T>(settings, MakeSpringMethod<T>(method, adaptiveSettings), settings.m_adaptiveOutputStepSize, tolerance));
+					}
+					methodSeries.m_order = NAN;
+				}
+				series.push_back(std::move(methodSeries));
+			}
+		}
+	}
+
+
+	void RunConvergenceSuite(const ConvergenceSettings& settings, std::vector<ConvergenceSeries>& series)
+	{
+		series.clear();
+		AddSystemSeries<SingleSpringMassSystem, float>(settings, "Single Spring Mass", series);
+		AddSystemSeries<CoupledSpringMassSystem, StateData<float, 2>>(settings, "Coupled Spring Mass", series);
+		AddSystemSeries<SingleSpringMassSystemT<double>, double>(settings, "Single Spring Mass (double)", series);
+	}
+
+
+	float FitConvergenceOrder(const std::vector<ConvergenceRun>& runs, double noiseFloor)
+	{
+		constexpr double maxError = 0.1;
+		constexpr double minImprovement = 1.5;
+
+		double sumX = 0.0;
+		double sumY = 0.0;
+		double sumXX = 0.0;
+		double sumXY = 0.0;
+		double previousError = INFINITY;
+		unsigned int count = 0;
+		for (const ConvergenceRun& run : runs)
+		{
+			const bool isAboveFloor = run.m_maxError > noiseFloor;
+			if (count == 0 && !(isAboveFloor && run.m_maxError < maxError))
+				continue;
+			if (count > 0 && !(isAboveFloor && run.m_maxError * minImprovement < previousError))
+				break;
+
+			const double x = log(static_cast<double>(run.m_stepSize));
+			const double y = log(run.m_maxError);
+			sumX += x;
+			sumY += y;
+			sumXX += x * x;
+			sumXY += x * y;
+			previousError = run.m_maxError;
+			++count;
+		}
+
+		const double variance = count * sumXX - sumX * sumX;
+		if (count < 2 || variance <= 0.0)
+			return NAN;
+		return static_cast<float>((count * sumXY - sumX * sumY) / variance);
+	}
+
+
+
+	// JSON has no NaN so diverged errors and missing orders are written as null
+	static void WriteJsonNumber(FILE* pFile, const char* pName, double value, const char* pSeparator)
+	{
+		if (isfinite(value))
+			fprintf(pFile, "\"%s\": %.9g%s", pName, value, pSeparator);
+		else
+			fprintf(pFile, "\"%s\": null%s", pName, pSeparator);
+	}
+
+
+	bool WriteConvergenceJson(const char* pFileName, const std::vector<ConvergenceSeries>& series)
+	{
+		FILE* pFile = fopen(pFileName, "w");
+		if (!pFile)
+			return false;
+
+		fprintf(pFile, "{\n\t\"series\": [\n");
+		for (size_t i = 0; i < series.size(); ++i)
+		{
+			const ConvergenceSeries& methodSeries = series[i];
+			fprintf(pFile, "\t\t{\n");
+			fprintf(pFile, "\t\t\t\"system\": \"%s\",\n", methodSeries.m_systemName.c_str());
+			fprintf(pFile, "\t\t\t\"method\": \"%s\",\n", methodSeries.m_methodName.c_str());
+			fprintf(pFile, "\t\t\t\"adaptive\": %s,\n", methodSeries.m_isAdaptive ? "true" : "false");
+			fprintf(pFile, "\t\t\t");
+			WriteJsonNumber(pFile, "noise_floor", methodSeries.m_noiseFloor, ",\n");
+			fprintf(pFile, "\t\t\t");
+			WriteJsonNumber(pFile, "order", methodSeries.m_order, ",\n");
+			fprintf(pFile, "\t\t\t\"runs\": [\n");
+			for (size_t j = 0; j < methodSeries.m_runs.size(); ++j)
+			{
+				const ConvergenceRun& run = methodSeries.m_runs[j];
+				fprintf(pFile, "\t\t\t\t{ ");
+				WriteJsonNumber(pFile, "step_size", run.m_stepSize, ", ");
+				WriteJsonNumber(pFile, "tolerance", run.m_tolerance, ", ");
+				WriteJsonNumber(pFile, "num_steps", run.m_numSteps, ", ");
+				WriteJsonNumber(pFile, "evaluations_per_step", run.m_evaluationsPerStep, ", ");
+				WriteJsonNumber(pFile, "ns_per_step", run.m_nanosecondsPerStep, ", ");
+				WriteJsonNumber(pFile, "max_error", run.m_maxError, " }");
+				fprintf(pFile, "%s\n", (j + 1 < methodSeries.m_runs.size()) ? "," : "");
+			}
+			fprintf(pFile, "\t\t\t]\n\t\t}%s\n", (i + 1 < series.size()) ? "," : "");
+		}
+		fprintf(pFile, "\t]\n}\n");
+
+		return fclose(pFile) == 0;
+	}
+
+
+	static const char* csvHeader = "system,method,adaptive,noise_floor,step_size,tolerance,num_steps,evaluations_per_step,ns_per_step,max_error,order";
+
+
+	bool WriteConvergenceCsv(const char* pFileName, const std::vector<ConvergenceSeries>& series)
+	{
+		FILE* pFile = fopen(pFileName, "w");
+		if (!pFile)
+			return false;
+
+		fprintf(pFile, "%s\n", csvHeader);
+		for (const ConvergenceSeries& methodSeries : series)
+		{
+			for (const ConvergenceRun& run : methodSeries.m_runs)
+			{
+				fprintf(pFile, "%s,%s,%d,%.9g,%.9g,%.9g,%u,%.9g,%.9g,%.9g,%.9g\n", methodSeries.m_systemName.c_str(), methodSeries.m_methodName.c_str(),
+					methodSeries.m_isAdaptive ? 1 : 0, methodSeries.m_noiseFloor, run.m_stepSize, run.m_tolerance, run.m_numSteps, run.m_evaluationsPerStep,
+					run.m_nanosecondsPerStep, run.m_maxError, methodSeries.m_order);
+			}
+		}
+
+		return fclose(pFile) == 0;
+	}
+
+
+	bool ReadConvergenceCsv(const char* pFileName, std::vector<ConvergenceSeries>& series)
+	{
+		FILE* pFile = fopen(pFileName, "r");
+		if (!pFile)
+			return false;
+
+		series.clear();
+		char line[1024];
+		bool isValid = fgets(line, sizeof(line), pFile) && strncmp(line, csvHeader, strlen(csvHeader)) == 0;
+		while (isValid && fgets(line, sizeof(line), pFile))
+		{
+			if (line[0] == '\n' || line[0] == '\r' || line[0] == '\0')
+				continue;
+
+			// the names don't contain commas so every field ends at the next one
+			const char* fields[11];
+			unsigned int numFields = 0;
+			for (char* pField = line; pField && numFields < 11; ++numFields)
+			{
+				fields[numFields] = pField;
+				pField = strchr(pField, ',');
+				if (pField)
+					*pField++ = '\0';
+			}
+			if (numFields != 11)
+			{
+				isValid = false;
+				break;
+			}
+
+			// rows of the same system and method are consecutive
+			if (series.empty() || series.back().m_systemName != fields[0] || series.back().m_methodName != fields[1])
+			{
+				series.emplace_back();
+				series.back().m_systemName = fields[0];
+				series.back().m_methodName = fields[1];
+				series.back().m_isAdaptive = atoi(fields[2]) != 0;
+				series.back().m_noiseFloor = strtod(fields[3], nullptr);
+				series.back().m_order = strtof(fields[10], nullptr);
+			}
+
+			ConvergenceRun run;
+			run.m_stepSize = strtof(fields[4], nullptr);
+			run.m_tolerance = strtof(fields[5], nullptr);
+			run.m_numSteps = static_cast<unsigned int>(strtoul(fields[6], nullptr, 10));
+			run.m_evaluationsPerStep = strtod(fields[7], nullptr);
+			run.m_nanosecondsPerStep = strtod(fields[8], nullptr);
+			run.m_maxError = strtod(fields[9], nullptr);
+			series.back().m_runs.push_back(run);
+		}
+
+		fclose(pFile);
+		return isValid;
+	}
+
+
+	bool WriteWorkPrecisionSvg(const char* pFileName, const std::vector<ConvergenceSeries>& series)
+	{
+		constexpr double panelWidth = 460.0;
+		constexpr double panelHeight = 400.0;
+		constexpr double margin = 60.0;
+		constexpr double legendWidth = 220.0;
+		constexpr double lineHeight = 16.0;
+		static const char* colours[] = { "#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd", "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf" };
+		constexpr unsigned int numColours = sizeof(colours) / sizeof(colours[0]);
+
+		std::vector<std::string> systemNames;
+		std::vector<std::string> methodNames;
+		for (const ConvergenceSeries& methodSeries : series)
+		{
+			if (std::find(systemNames.begin(), systemNames.end(), methodSeries.m_systemName) == systemNames.end())
+				systemNames.push_back(methodSeries.m_systemName);
+			if (std::find(methodNames.begin(), methodNames.end(), methodSeries.m_methodName) == methodNames.end())
+				methodNames.push_back(methodSeries.m_methodName);
+		}
+
+		// cost is the time to simulate a second, which puts the fixed step and adaptive runs on one axis
+		const auto getCost = [](const ConvergenceRun& run) { return run.m_nanosecondsPerStep / run.m_stepSize; };
+		const auto isPlotted = [](double cost, double error) { return cost > 0.0 && error > 0.0 && isfinite(cost) && isfinite(error); };
+
+		const double width = systemNames.size() * (panelWidth + margin) + margin + legendWidth;
+		const double height = std::max(panelHeight + 2.0 * margin, margin + methodNames.size() * lineHeight + margin);
+
+		FILE* pFile = fopen(pFileName, "w");
+		if (!pFile)
+			return false;
+
+		fprintf(pFile, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%.0f\" height=\"%.0f\" font-family=\"sans-serif\" font-size=\"11\">\n", width, height);
+		fprintf(pFile, "<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n");
+
+		for (size_t panel = 0; panel < systemNames.size(); ++panel)
+		{
+			// whole decades around every plotted run of the system
+			double minX = INFINITY;
+			double maxX = -INFINITY;
+			double minY = INFINITY;
+			double maxY = -INFINITY;
+			for (const ConvergenceSeries& methodSeries : series)
+			{
+				if (methodSeries.m_systemName != systemNames[panel])
+					continue;
+				for (const ConvergenceRun& run : methodSeries.m_runs)
+				{
+					if (!isPlotted(getCost(run), run.m_maxError))
+						continue;
+					minX = std::min(minX, floor(log10(getCost(run))));
+					maxX = std::max(maxX, ceil(log10(getCost(run))));
+					minY = std::min(minY, floor(log10(run.m_maxError)));
+					maxY = std::max(maxY, ceil(log10(run.m_maxError)));
+				}
+			}
+			if (!(minX < maxX))
+			{
+				minX = 0.0;
+				maxX = 1.0;
+			}
+			if (!(minY < maxY))
+			{
+				minY = 0.0;
+				maxY = 1.0;
+			}
+
+			const double left = margin + panel * (panelWidth + margin);
+			const double top = margin;
+			const auto toX = [&](double cost) { return left + (log10(cost) - minX) / (maxX - minX) * panelWidth; };
+			const auto toY = [&](double error) { return top + (maxY - log10(error)) / (maxY - minY) * panelHeight; };
+
+			fprintf(pFile, "<text x=\"%.1f\" y=\"%.1f\" text-anchor=\"middle\" font-size=\"14\">%s</text>\n", left + 0.5 * panelWidth, top - 20.0, systemNames[panel].c_str());
+			for (double decade = minX; decade <= maxX; decade += 1.0)
+			{
+				const double x = left + (decade - minX) / (maxX - minX) * panelWidth;
+				fprintf(pFile, "<line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" stroke=\"#dddddd\"/>\n", x, top, x, top + panelHeight);
+				fprintf(pFile, "<text x=\"%.1f\" y=\"%.1f\" text-anchor=\"middle\">1e%.0f</text>\n", x, top + panelHeight + 15.0, decade);
+			}
+			for (double decade = minY; decade <= maxY; decade += 1.0)
+			{
+				const double y = top + (maxY - decade) / (maxY - minY) * panelHeight;
+				fprintf(pFile, "<line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" stroke=\"#dddddd\"/>\n", left, y, left + panelWidth, y);
+				fprintf(pFile, "<text x=\"%.1f\" y=\"%.1f\" text-anchor=\"end\">1e%.0f</text>\n", left - 5.0, y + 4.0, decade);
+			}
+			fprintf(pFile, "<rect x=\"%.1f\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\" fill=\"none\" stroke=\"black\"/>\n", left, top, panelWidth, panelHeight);
+			fprintf(pFile, "<text x=\"%.1f\" y=\"%.1f\" text-anchor=\"middle\">ns per simulated second</text>\n", left + 0.5 * panelWidth, top + panelHeight + 35.0);
+			fprintf(pFile, "<text transform=\"translate(%.1f %.1f) rotate(-90)\" text-anchor=\"middle\">max position error</text>\n", left - 45.0, top + 0.5 * panelHeight);
+
+			for (const ConvergenceSeries& methodSeries : series)
+			{
+				if (methodSeries.m_systemName != systemNames[panel])
+					continue;
+
+				const size_t methodIndex = std::find(methodNames.begin(), methodNames.end(), methodSeries.m_methodName) - methodNames.begin();
+				const char* colour = colours[methodIndex % numColours];
+				const char* dashes = (methodIndex / numColours == 1) ? " stroke-dasharray=\"6 3\"" : (methodIndex / numColours >= 2) ? " stroke-dasharray=\"2 2\"" : "";
+
+				// diverged runs break the line rather than end it
+				std::string path;
+				char command[64];
+				bool isDrawing = false;
+				for (const ConvergenceRun& run : methodSeries.m_runs)
+				{
+					const double cost = getCost(run);
+					if (!isPlotted(cost, run.m_maxError))
+					{
+						isDrawing = false;
+						continue;
+					}
+					snprintf(command, sizeof(command), "%c%.1f %.1f ", isDrawing ? 'L' : 'M', toX(cost), toY(run.m_maxError));
+					path += command;
+					isDrawing = true;
+					fprintf(pFile, "<circle cx=\"%.1f\" cy=\"%.1f\" r=\"2.5\" fill=\"%s\"/>\n", toX(cost), toY(run.m_maxError), colour);
+				}
+				if (!path.empty())
+					fprintf(pFile, "<path d=\"%s\" fill=\"none\" stroke=\"%s\"%s/>\n", path.c_str(), colour, dashes);
+			}
+		}
+
+		const double legendLeft = margin + systemNames.size() * (panelWidth + margin);
+		for (size_t i = 0; i < methodNames.size(); ++i)
+		{
+			const double y = margin + i * lineHeight;
+			const char* dashes = (i / numColours == 1) ? " stroke-dasharray=\"6 3\"" : (i / numColours >= 2) ? " stroke-dasharray=\"2 2\"" : "";
+			fprintf(pFile, "<line x1=\"%.1f\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" stroke=\"%s\" stroke-width=\"2\"%s/>\n", legendLeft, y, legendLeft + 24.0, y, colours[i % numColours], dashes);
+			fprintf(pFile, "<text x=\"%.1f\" y=\"%.1f\">%s</text>\n", legendLeft + 30.0, y + 4.0, methodNames[i].c_str());
+		}
+		fprintf(pFile, "</svg>\n");
+
+		return fclose(pFile) == 0;
+	}
+
+
+
+	std::vector<std::string> CompareConvergence(const std::vector<ConvergenceSeries>& baseline, const std::vector<ConvergenceSeries>& series, const RegressionTolerances& tolerances)
+	{
+		std::vector<std::string> regressions;
+		char line[256];
+
+		for (const ConvergenceSeries& methodSeries : series)
+		{
+			const auto baselineIt = std::find_if(baseline.begin(), baseline.end(), [&methodSeries](const ConvergenceSeries& baselineSeries)
+			{
+				return baselineSeries.m_systemName == methodSeries.m_systemName && baselineSeries.m_methodName == methodSeries.m_methodName;
+			});
+			if (baselineIt == baseline.end())
+				continue;
+
+			const std::string name = methodSeries.m_systemName + " / " + methodSeries.m_methodName;
+			if (isfinite(baselineIt->m_order) && !(methodSeries.m_order >= baselineIt->m_order - tolerances.m_orderDrop))
+			{
+				snprintf(line, sizeof(line), "%s: order %.2f, baseline %.2f", name.c_str(), methodSeries.m_order, baselineIt->m_order);
+				regressions.push_back(line);
+			}
+
+			// the time is compared over the whole series as single runs are too noisy to flag on their own
+			double sumLogTimeRatio = 0.0;
+			unsigned int numTimedRuns = 0;
+			for (const ConvergenceRun& run : methodSeries.m_runs)
+			{
+				const auto baselineRunIt = std::find_if(baselineIt->m_runs.begin(), baselineIt->m_runs.end(), [&run](const ConvergenceRun& baselineRun)
+				{
+					return fabsf(baselineRun.m_stepSize - run.m_stepSize) <= 1.0e-6f * run.m_stepSize && fabsf(baselineRun.m_tolerance - run.m_tolerance) <= 1.0e-6f * run.m_tolerance;
+				});
+				if (baselineRunIt == baselineIt->m_runs.end())
+					continue;
+
+				const double baselineError = baselineRunIt->m_maxError;
+				if (isfinite(baselineError) && !(run.m_maxError <= std::max(baselineError * tolerances.m_errorRatio, baselineError + methodSeries.m_noiseFloor)))
+				{
+					char runName[32];
+					if (methodSeries.m_isAdaptive)
+						snprintf(runName, sizeof(runName), "tolerance %.0e", run.m_tolerance);
+					else
+						snprintf(runName, sizeof(runName), "h = %.5f", run.m_stepSize);
+
+					snprintf(line, sizeof(line), "%s (%s): max error %.3e, baseline %.3e", name.c_str(), runName, run.m_maxError, baselineError);
+					regressions.push_back(line);
+				}
+
+				if (run.m_nanosecondsPerStep > 0.0 && baselineRunIt->m_nanosecondsPerStep > 0.0)
+				{
+					sumLogTimeRatio += log(run.m_nanosecondsPerStep / baselineRunIt->m_nanosecondsPerStep);
+					++numTimedRuns;
+				}
+			}
+
+			const double timeRatio = (numTimedRuns > 0) ? exp(sumLogTimeRatio / numTimedRuns) : 1.0;
+			if (timeRatio > tolerances.m_timeRatio)
+			{
+				snprintf(line, sizeof(line), "%s: %.2fx the baseline time per step", name.c_str(), timeRatio);
+				regressions.push_back(line);
+			}
+		}
+
+		return regressions;
+	}
+}
\ No newline at end of file
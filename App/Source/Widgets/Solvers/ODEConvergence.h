@@ -0,0 +1,83 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODEWidget.h"
+#include <string>
+#include <vector>
+
+
+
+namespace ODESystem
+{
+	// Undamped by default, as the splitting methods take the force at the speed of the last kick and drop
+	// to first order once it depends on the speed.
+	struct ConvergenceSettings
+	{
+		float m_springConstant = 10.0f;
+		float m_damping = 0.0f;
+		float m_duration = 10.0f;
+		std::vector<float> m_stepSizes = { 1.0f / 15.0f, 1.0f / 30.0f, 1.0f / 60.0f, 1.0f / 120.0f, 1.0f / 240.0f, 1.0f / 480.0f, 1.0f / 960.0f };
+		std::vector<float> m_tolerances = { 1.0e-2f, 1.0e-3f, 1.0e-4f, 1.0e-5f, 1.0e-6f };		// the adaptive methods run over these instead
+		float m_adaptiveOutputStepSize = 1.0f / 60.0f;
+		unsigned int m_minTimedSteps = 100000;		// short runs are repeated until they reach this many steps
+		unsigned int m_numTimingTrials = 3;
+	};
+
+
+	// a single run of one method, the adaptive methods step over the output interval and integrate to the tolerance
+	struct ConvergenceRun
+	{
+		float m_stepSize = 0.0f;
+		float m_tolerance = 0.0f;
+		unsigned int m_numSteps = 0;
+		double m_evaluationsPerStep = 0.0;		// calls to GetNthDerivative
+		double m_nanosecondsPerStep = 0.0;
+		double m_maxError = 0.0;				// of the positions against SolveAnalytical at the end of every step, NaN once diverged
+	};
+
+
+	struct ConvergenceSeries
+	{
+		std::string m_systemName;
+		std::string m_methodName;
+		bool m_isAdaptive = false;
+		double m_noiseFloor = 0.0;				// errors below this are rounding rather than the method
+		float m_order = 0.0f;					// NaN for the adaptive methods and when too few runs are in the asymptotic range
+		std::vector<ConvergenceRun> m_runs;
+	};
+
+
+	// Runs every method of the ODE widget on both spring systems, and on the single spring in double
+	// precision where the higher order methods converge well past the float rounding, over the ladder of step
+	// sizes, or of tolerances for the adaptive methods, and fits the order of the fixed step methods.
+	void RunConvergenceSuite(const ConvergenceSettings& settings, std::vector<ConvergenceSeries>& series);
+
+	// Least squares slope of log error against log step size over runs ordered from the largest step.  The
+	// fit starts at the first run with an error below 0.1, where the method is in its asymptotic range, and
+	// stops once the error no longer falls by a clear margin or reaches the noise floor, where rounding has
+	// taken over.
+	float FitConvergenceOrder(const std::vector<ConvergenceRun>& runs, double noiseFloor);
+
+	// The CSV has a row per run with the fitted order repeated, which is also the layout ReadConvergenceCsv
+	// reads back as a baseline.  The diagram plots the error against the cost per simulated second, a panel
+	// per system.
+	bool WriteConvergenceJson(const char* pFileName, const std::vector<ConvergenceSeries>& series);
+	bool WriteConvergenceCsv(const char* pFileName, const std::vector<ConvergenceSeries>& series);
+	bool ReadConvergenceCsv(const char* pFileName, std::vector<ConvergenceSeries>& series);
+	bool WriteWorkPrecisionSvg(const char* pFileName, const std::vector<ConvergenceSeries>& series);
+
+
+	// how far a run may fall behind its baseline before it is reported
+	struct RegressionTolerances
+	{
+		double m_errorRatio = 2.0;				// growth within the series' noise floor is ignored
+		double m_orderDrop = 0.3;
+		double m_timeRatio = 1.5;
+	};
+
+
+	// Matches the runs by system, method and step size or tolerance and returns a line for every
+	// regression, runs missing from either side are ignored.  The time is compared as the geometric mean
+	// ratio over each series.
+	std::vector<std::string> CompareConvergence(const std::vector<ConvergenceSeries>& baseline, const std::vector<ConvergenceSeries>& series, const RegressionTolerances& tolerances);
+}
\ No newline at end of file
@@ -0,0 +1,602 @@
+#include "Widgets/Solvers/ODENBody.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+
+
+
+namespace ODESystem
+{
+	static constexpr unsigned int maxTreeLevel = 21;			// 21 bits per axis fill a 63 bit Morton key
+	static constexpr unsigned int maxLeafSize = 16;
+	static constexpr unsigned int maxNumChunks = 64;
+
+
+	static void ParallelFor(ThreadPool* pThreadPool, size_t count, const ThreadPool::ParallelFunc& func, size_t grainSize)
+	{
+		if (pThreadPool)
+		{
+			pThreadPool->ParallelFor(count, func, grainSize);
+			return;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+			func(i);
+	}
+
+
+	// spaces the lower 21 bits of x three bits apart
+	static uint64_t SpreadBits(uint64_t x)
+	{
+		x &= 0x1fffff;
+		x = (x | x << 32) & 0x1f00000000ffff;
+		x = (x | x << 16) & 0x1f0000ff0000ff;
+		x = (x | x << 8) & 0x100f00f00f00f00f;
+		x = (x | x << 4) & 0x10c30c30c30c30c3;
+		x = (x | x << 2) & 0x1249249249249249;
+		return x;
+	}
+
+
+	// adds the pull of mass at offset, the softening length squared keeps it finite at zero offset
+	static void AddInteraction(float dx, float dy, float dz, float mass, float softeningSquared, float* acceleration, float& potential)
+	{
+		const float inverseDistance = 1.0f / sqrtf(dx * dx + dy * dy + dz * dz + softeningSquared);
+		const float scale = mass * inverseDistance * inverseDistance * inverseDistance;
+		acceleration[0] += scale * dx;
+		acceleration[1] += scale * dy;
+		acceleration[2] += scale * dz;
+		potential -= mass * inverseDistance;
+	}
+
+
+
+	void BarnesHutTree::Build(const float* positions, const float* masses, size_t numBodies, ThreadPool* pThreadPool)
+	{
+		m_pPositions = positions;
+		m_pMasses = masses;
+		m_numBodies = numBodies;
+		m_nodes.clear();
+		if (numBodies == 0)
+			return;
+
+		const float* x = positions;
+		const float* y = positions + numBodies;
+		const float* z = positions + 2 * numBodies;
+
+		// bounds of each chunk of bodies in parallel, then the cube around all of them
+		const size_t numChunks = std::min<size_t>(maxNumChunks, numBodies);
+		std::array<std::array<float, 6>, maxNumChunks> chunkBounds;
+		ParallelFor(pThreadPool, numChunks, [&](size_t chunk)
+		{
+			std::array<float, 6>& bounds = chunkBounds[chunk];
+			bounds = { INFINITY, INFINITY, INFINITY, -INFINITY, -INFINITY, -INFINITY };
+			for (size_t i = numBodies * chunk / numChunks; i < numBodies * (chunk + 1) / numChunks; ++i)
+			{
+				bounds[0] = std::min(bounds[0], x[i]);
+				bounds[1] = std::min(bounds[1], y[i]);
+				bounds[2] = std::min(bounds[2], z[i]);
+				bounds[3] = std::max(bounds[3], x[i]);
+				bounds[4] = std::max(bounds[4], y[i]);
+				bounds[5] = std::max(bounds[5], z[i]);
+			}
+		}, 1);
+
+		std::array<float, 6> bounds = chunkBounds[0];
+		for (size_t chunk = 1; chunk < numChunks; ++chunk)
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				bounds[axis] = std::min(bounds[axis], chunkBounds[chunk][axis]);
+				bounds[axis + 3] = std::max(bounds[axis + 3], chunkBounds[chunk][axis + 3]);
+			}
+
+		// grown a little so the bodies on the far faces still quantise inside the cube
+		const float extent = std::max({ bounds[3] - bounds[0], bounds[4] - bounds[1], bounds[5] - bounds[2] });
+		m_rootSize = (extent > 0.0f) ? extent * 1.0001f : 1.0f;
+		const float scale = static_cast<float>(1 << maxTreeLevel) / m_rootSize;
+		constexpr float maxCell = static_cast<float>((1 << maxTreeLevel) - 1);
+
+		// Morton keys and a histogram of the buckets, the cells two levels down, for each chunk
+		m_sortedKeys.resize(numBodies);
+		m_sortedPositions.resize(3 * numBodies);
+		m_sortedMasses.resize(numBodies);
+		std::vector<std::pair<uint64_t, unsigned int>>& keys = m_unsortedKeys;
+		keys.resize(numBodies);
+
+		std::array<std::array<unsigned int, numBuckets>, maxNumChunks> chunkCounts;
+		constexpr unsigned int bucketShift = 3 * (maxTreeLevel - numBucketLevels);
+		ParallelFor(pThreadPool, numChunks, [&](size_t chunk)
+		{
+			chunkCounts[chunk].fill(0);
+			for (size_t i = numBodies * chunk / numChunks; i < numBodies * (chunk + 1) / numChunks; ++i)
+			{
+				const uint64_t cellX = static_cast<uint64_t>(std::min((x[i] - bounds[0]) * scale, maxCell));
+				const uint64_t cellY = static_cast<uint64_t>(std::min((y[i] - bounds[1]) * scale, maxCell));
+				const uint64_t cellZ = static_cast<uint64_t>(std::min((z[i] - bounds[2]) * scale, maxCell));
+				keys[i] = { (SpreadBits(cellX) << 2) | (SpreadBits(cellY) << 1) | SpreadBits(cellZ), static_cast<unsigned int>(i) };
+				++chunkCounts[chunk][keys[i].first >> bucketShift];
+			}
+		}, 1);
+
+		// each chunk scatters its keys into its own slice of every bucket
+		unsigned int offset = 0;
+		for (unsigned int bucket = 0; bucket < numBuckets; ++bucket)
+		{
+			m_bucketStarts[bucket] = offset;
+			for (size_t chunk = 0; chunk < numChunks; ++chunk)
+			{
+				const unsigned int count = chunkCounts[chunk][bucket];
+				chunkCounts[chunk][bucket] = offset;
+				offset += count;
+			}
+		}
+		m_bucketStarts[numBuckets] = offset;
+
+		ParallelFor(pThreadPool, numChunks, [&](size_t chunk)
+		{
+			for (size_t i = numBodies * chunk / numChunks; i < numBodies * (chunk + 1) / numChunks; ++i)
+				m_sortedKeys[chunkCounts[chunk][keys[i].first >> bucketShift]++] = keys[i];
+		}, 1);
+
+		ParallelFor(pThreadPool, numBuckets, [this](size_t bucket) { BuildBucket(static_cast<unsigned int>(bucket)); }, 1);
+		LinkTree();
+
+		// the pools are copied into one array so traversal only follows plain indices
+		ParallelFor(pThreadPool, numBuckets, [this](size_t bucket)
+		{
+			const std::vector<Node>& pool = m_bucketNodes[bucket];
+			if (pool.empty())
+				return;
+
+			const unsigned int poolOffset = m_bucketOffsets[bucket];
+			m_nodes[m_bucketRoots[bucket]] = pool[0];
+			for (size_t i = 1; i < pool.size(); ++i)
+				m_nodes[poolOffset + i - 1] = pool[i];
+
+			const auto relink = [poolOffset](Node& node) { if (node.m_numChildren > 0) node.m_firstChild += poolOffset - 1; };
+			relink(m_nodes[m_bucketRoots[bucket]]);
+			for (size_t i = 1; i < pool.size(); ++i)
+				relink(m_nodes[poolOffset + i - 1]);
+		}, 1);
+
+		// walked in Morton order so neighbouring leaves in a range share most of their interaction lists
+		m_leaves.clear();
+		for (unsigned int i = 0; i < m_nodes.size(); ++i)
+			if (m_nodes[i].m_numChildren == 0)
+				m_leaves.push_back(i);
+		std::sort(m_leaves.begin(), m_leaves.end(), [this](unsigned int lhs, unsigned int rhs) { return m_nodes[lhs].m_firstBody < m_nodes[rhs].m_firstBody; });
+	}
+
+
+	void BarnesHutTree::BuildBucket(unsigned int bucket)
+	{
+		const unsigned int begin = m_bucketStarts[bucket];
+		const unsigned int end = m_bucketStarts[bucket + 1];
+		std::vector<Node>& pool = m_bucketNodes[bucket];
+		pool.clear();
+		if (begin == end)
+			return;
+
+		std::sort(m_sortedKeys.begin() + begin, m_sortedKeys.begin() + end);
+
+		const size_t numBodies = m_numBodies;
+		for (unsigned int i = begin; i < end; ++i)
+		{
+			const unsigned int body = m_sortedKeys[i].second;
+			m_sortedPositions[i] = m_pPositions[body];
+			m_sortedPositions[numBodies + i] = m_pPositions[numBodies + body];
+			m_sortedPositions[2 * numBodies + i] = m_pPositions[2 * numBodies + body];
+			m_sortedMasses[i] = m_pMasses[body];
+		}
+
+		pool.resize(1);
+		BuildNode(pool, 0, begin, end, numBucketLevels);
+	}
+
+
+	void BarnesHutTree::BuildNode(std::vector<Node>& pool, unsigned int nodeIndex, unsigned int begin, unsigned int end, unsigned int level) const
+	{
+		Node node;
+		node.m_size = ldexpf(m_rootSize, -static_cast<int>(level));
+		node.m_firstBody = begin;
+		node.m_numBodies = end - begin;
+
+		if (end - begin <= maxLeafSize || level == maxTreeLevel)
+		{
+			const size_t numBodies = m_numBodies;
+			float weightedPosition[3] = { 0.0f, 0.0f, 0.0f };
+			for (unsigned int i = begin; i < end; ++i)
+			{
+				const float mass = m_sortedMasses[i];
+				node.m_mass += mass;
+				for (int axis = 0; axis < 3; ++axis)
+					weightedPosition[axis] += mass * m_sortedPositions[axis * numBodies + i];
+			}
+			for (int axis = 0; axis < 3; ++axis)
+				node.m_centerOfMass[axis] = (node.m_mass > 0.0f) ? weightedPosition[axis] / node.m_mass : m_sortedPositions[axis * numBodies + begin];
+
+			pool[nodeIndex] = node;
+			return;
+		}
+
+		// the keys share every digit above this level, so the children are runs of the next digit
+		const unsigned int shift = 3 * (maxTreeLevel - 1 - level);
+		const uint64_t childMask = (uint64_t(1) << shift) - 1;
+		std::array<unsigned int, 9> childStarts;
+		unsigned int numChildren = 0;
+		for (unsigned int i = begin; i < end; ++numChildren)
+		{
+			childStarts[numChildren] = i;
+			const std::pair<uint64_t, unsigned int> lastInChild(m_sortedKeys[i].first | childMask, ~0u);
+			i = static_cast<unsigned int>(std::upper_bound(m_sortedKeys.begin() + i, m_sortedKeys.begin() + end, lastInChild) - m_sortedKeys.begin());
+		}
+		childStarts[numChildren] = end;
+
+		// children are allocated together so a node only needs the index of the first
+		node.m_firstChild = static_cast<unsigned int>(pool.size());
+		node.m_numChildren = numChildren;
+		pool.resize(pool.size() + numChildren);
+		for (unsigned int child = 0; child < numChildren; ++child)
+			BuildNode(pool, node.m_firstChild + child, childStarts[child], childStarts[child + 1], level + 1);
+
+		SetCenterOfMass(node, pool.data());
+		pool[nodeIndex] = node;
+	}
+
+
+	void BarnesHutTree::SetCenterOfMass(Node& node, const Node* nodes) const
+	{
+		float weightedPosition[3] = { 0.0f, 0.0f, 0.0f };
+		node.m_mass = 0.0f;
+		for (unsigned int child = node.m_firstChild; child < node.m_firstChild + node.m_numChildren; ++child)
+		{
+			node.m_mass += nodes[child].m_mass;
+			for (int axis = 0; axis < 3; ++axis)
+				weightedPosition[axis] += nodes[child].m_mass * nodes[child].m_centerOfMass[axis];
+		}
+		for (int axis = 0; axis < 3; ++axis)
+			node.m_centerOfMass[axis] = (node.m_mass > 0.0f) ? weightedPosition[axis] / node.m_mass : nodes[node.m_firstChild].m_centerOfMass[axis];
+	}
+
+
+	void BarnesHutTree::LinkTree()
+	{
+		// The levels above the buckets go first: the root, the cells one level down, then the bucket roots
+		// grouped by their parent so that siblings are contiguous.  The rest of each pool follows in turn.
+		constexpr unsigned int numTopCells = 8;
+		constexpr unsigned int bucketsPerCell = numBuckets / numTopCells;
+
+		unsigned int numCells = 0;
+		unsigned int numBucketRoots = 0;
+		for (unsigned int cell = 0; cell < numTopCells; ++cell)
+		{
+			bool isCellUsed = false;
+			for (unsigned int bucket = cell * bucketsPerCell; bucket < (cell + 1) * bucketsPerCell; ++bucket)
+				if (!m_bucketNodes[bucket].empty())
+				{
+					isCellUsed = true;
+					++numBucketRoots;
+				}
+			numCells += isCellUsed ? 1 : 0;
+		}
+
+		unsigned int nextRoot = 1 + numCells;
+		unsigned int nextOffset = 1 + numCells + numBucketRoots;
+		for (unsigned int bucket = 0; bucket < numBuckets; ++bucket)
+		{
+			const size_t poolSize = m_bucketNodes[bucket].size();
+			m_bucketRoots[bucket] = (poolSize > 0) ? nextRoot++ : 0;
+			m_bucketOffsets[bucket] = nextOffset;
+			nextOffset += (poolSize > 0) ? static_cast<unsigned int>(poolSize - 1) : 0;
+		}
+		m_nodes.resize(nextOffset);
+
+		// the top nodes take their centres of mass from the bucket roots still in their pools
+		std::array<Node, numBuckets> bucketRoots;
+		for (unsigned int bucket = 0; bucket < numBuckets; ++bucket)
+			if (!m_bucketNodes[bucket].empty())
+				bucketRoots[m_bucketRoots[bucket] - 1 - numCells] = m_bucketNodes[bucket][0];
+
+		Node root;
+		root.m_size = m_rootSize;
+		root.m_firstChild = 1;
+		root.m_numChildren = numCells;
+		root.m_numBodies = static_cast<unsigned int>(m_numBodies);
+
+		unsigned int cellIndex = 1;
+		unsigned int firstBucketRoot = 0;
+		for (unsigned int cell = 0; cell < numTopCells; ++cell)
+		{
+			Node node;
+			node.m_size = 0.5f * m_rootSize;
+			node.m_firstBody = m_bucketStarts[cell * bucketsPerCell];
+			node.m_numBodies = m_bucketStarts[(cell + 1) * bucketsPerCell] - node.m_firstBody;
+			if (node.m_numBodies == 0)
+				continue;
+
+			node.m_firstChild = firstBucketRoot;
+			for (unsigned int bucket = cell * bucketsPerCell; bucket < (cell + 1) * bucketsPerCell; ++bucket)
+				node.m_numChildren += m_bucketNodes[bucket].empty() ? 0 : 1;
+			SetCenterOfMass(node, bucketRoots.data());
+			node.m_firstChild += 1 + numCells;
+			firstBucketRoot += node.m_numChildren;
+			m_nodes[cellIndex++] = node;
+		}
+
+		SetCenterOfMass(root, m_nodes.data());
+		m_nodes[0] = root;
+	}
+
+
+	// Walks the tree once for a whole leaf, opening nodes against the leaf's bounding box so the nodes and
+	// bodies it gathers are a valid interaction list for every body in the leaf.  Applying the list is then
+	// the same branch free loop as the direct sum.
+	uint64_t BarnesHutTree::GetLeafAccelerations(const Node& leaf, float gravity, float softening, float theta, float* accelerations, float* pPotentials) const
+	{
+		const size_t numBodies = m_numBodies;
+		const float* x = m_sortedPositions.data();
+		const float* y = x + numBodies;
+		const float* z = y + numBodies;
+		const unsigned int endBody = leaf.m_firstBody + leaf.m_numBodies;
+
+		float boxMin[3] = { INFINITY, INFINITY, INFINITY };
+		float boxMax[3] = { -INFINITY, -INFINITY, -INFINITY };
+		for (unsigned int i = leaf.m_firstBody; i < endBody; ++i)
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				boxMin[axis] = std::min(boxMin[axis], x[axis * numBodies + i]);
+				boxMax[axis] = std::max(boxMax[axis], x[axis * numBodies + i]);
+			}
+
+		// reused by every leaf the thread walks
+		thread_local std::vector<float> listX;
+		thread_local std::vector<float> listY;
+		thread_local std::vector<float> listZ;
+		thread_local std::vector<float> listMasses;
+		listX.clear();
+		listY.clear();
+		listZ.clear();
+		listMasses.clear();
+		const auto addToList = [](float x, float y, float z, float mass)
+		{
+			listX.push_back(x);
+			listY.push_back(y);
+			listZ.push_back(z);
+			listMasses.push_back(mass);
+		};
+
+		// each level pushes at most eight children and pops its parent
+		std::array<unsigned int, 8 * (maxTreeLevel + 1)> stack;
+		unsigned int stackSize = 0;
+		stack[stackSize++] = 0;
+		const float thetaSquared = theta * theta;
+		while (stackSize > 0)
+		{
+			const Node& node = m_nodes[stack[--stackSize]];
+			if (node.m_numChildren == 0)
+			{
+				for (unsigned int i = node.m_firstBody; i < node.m_firstBody + node.m_numBodies; ++i)
+					addToList(x[i], y[i], z[i], m_sortedMasses[i]);
+				continue;
+			}
+
+			float distanceSquared = 0.0f;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float distance = std::max({ boxMin[axis] - node.m_centerOfMass[axis], node.m_centerOfMass[axis] - boxMax[axis], 0.0f });
+				distanceSquared += distance * distance;
+			}
+			// a large theta could otherwise accept a node holding the leaf itself, feeding its own bodies back in
+			// as a point mass, so a node whose range covers the leaf's bodies is always opened
+			const bool isAncestor = (node.m_firstBody <= leaf.m_firstBody) && (endBody <= node.m_firstBody + node.m_numBodies);
+			if (!isAncestor && node.m_size * node.m_size < thetaSquared * distanceSquared)
+			{
+				addToList(node.m_centerOfMass[0], node.m_centerOfMass[1], node.m_centerOfMass[2], node.m_mass);
+				continue;
+			}
+
+			for (unsigned int child = node.m_firstChild; child < node.m_firstChild + node.m_numChildren; ++child)
+				stack[stackSize++] = child;
+		}
+
+		const size_t listSize = listMasses.size();
+		const float softeningSquared = softening * softening;
+
+		// The list is the outer loop so the inner loop runs across the leaf's bodies with no reduction in
+		// it, which vectorises without reordering any sums.  Each body is in its own list at zero offset,
+		// which only adds its self term to the potential.  Leaves at the deepest level can hold more than
+		// maxLeafSize bodies so they're taken a block at a time.
+		for (unsigned int blockStart = leaf.m_firstBody; blockStart < endBody; blockStart += maxLeafSize)
+		{
+			const unsigned int blockSize = std::min(endBody - blockStart, maxLeafSize);
+			const float* __restrict bodyX = x + blockStart;
+			const float* __restrict bodyY = y + blockStart;
+			const float* __restrict bodyZ = z + blockStart;
+			float accelerationX[maxLeafSize] = {};
+			float accelerationY[maxLeafSize] = {};
+			float accelerationZ[maxLeafSize] = {};
+			float potential[maxLeafSize] = {};
+
+			for (size_t j = 0; j < listSize; ++j)
+			{
+				const float sourceX = listX[j];
+				const float sourceY = listY[j];
+				const float sourceZ = listZ[j];
+				const float sourceMass = listMasses[j];
+				for (unsigned int i = 0; i < blockSize; ++i)
+				{
+					const float dx = sourceX - bodyX[i];
+					const float dy = sourceY - bodyY[i];
+					const float dz = sourceZ - bodyZ[i];
+					const float inverseDistance = 1.0f / sqrtf(dx * dx + dy * dy + dz * dz + softeningSquared);
+					const float scale = sourceMass * inverseDistance * inverseDistance * inverseDistance;
+					accelerationX[i] += scale * dx;
+					accelerationY[i] += scale * dy;
+					accelerationZ[i] += scale * dz;
+					potential[i] -= sourceMass * inverseDistance;
+				}
+			}
+
+			for (unsigned int i = 0; i < blockSize; ++i)
+			{
+				const unsigned int body = m_sortedKeys[blockStart + i].second;
+				accelerations[body] = gravity * accelerationX[i];
+				accelerations[numBodies + body] = gravity * accelerationY[i];
+				accelerations[2 * numBodies + body] = gravity * accelerationZ[i];
+				if (pPotentials)
+					pPotentials[body] = gravity * (potential[i] + m_sortedMasses[blockStart + i] / softening);
+			}
+		}
+
+		return static_cast<uint64_t>(leaf.m_numBodies) * (listSize - 1);
+	}
+
+
+	uint64_t BarnesHutTree::GetAccelerations(float gravity, float softening, float theta, float* accelerations, float* pPotentials, ThreadPool* pThreadPool) const
+	{
+		std::atomic<uint64_t> numInteractions = 0;
+		ParallelFor(pThreadPool, m_leaves.size(), [&](size_t leaf)
+		{
+			const uint64_t numLeafInteractions = GetLeafAccelerations(m_nodes[m_leaves[leaf]], gravity, softening, theta, accelerations, pPotentials);
+			numInteractions.fetch_add(numLeafInteractions, std::memory_order_relaxed);
+		}, 16);
+
+		return numInteractions;
+	}
+
+
+
+	static uint64_t GetDirectAccelerations(const float* positions, const float* masses, size_t numBodies, float gravity, float softening,
+		float* accelerations, float* pPotentials, ThreadPool* pThreadPool)
+	{
+		const float* __restrict x = positions;
+		const float* __restrict y = positions + numBodies;
+		const float* __restrict z = positions + 2 * numBodies;
+		const float softeningSquared = softening * softening;
+
+		// the self term is zero for the acceleration so the inner loop has no branch to stop it vectorising
+		ParallelFor(pThreadPool, numBodies, [&](size_t body)
+		{
+			float acceleration[3] = { 0.0f, 0.0f, 0.0f };
+			float potential = 0.0f;
+			for (size_t i = 0; i < numBodies; ++i)
+				AddInteraction(x[i] - x[body], y[i] - y[body], z[i] - z[body], masses[i], softeningSquared, acceleration, potential);
+
+			accelerations[body] = gravity * acceleration[0];
+			accelerations[numBodies + body] = gravity * acceleration[1];
+			accelerations[2 * numBodies + body] = gravity * acceleration[2];
+			if (pPotentials)
+				pPotentials[body] = gravity * (potential + masses[body] / softening);
+		}, 16);
+
+		return static_cast<uint64_t>(numBodies) * (numBodies - 1);
+	}
+
+
+
+	void NBodySystem::GetAccelerations(const float* positions, float* accelerations, float* pPotentials) const
+	{
+		const size_t numBodies = GetNumBodies();
+		if (m_force == ENBodyForce::Direct)
+		{
+			m_numInteractions += GetDirectAccelerations(positions, m_masses.data(), numBodies, m_gravity, m_softening, accelerations, pPotentials, m_pThreadPool);
+			return;
+		}
+
+		m_tree.Build(positions, m_masses.data(), numBodies, m_pThreadPool);
+		m_numInteractions += m_tree.GetAccelerations(m_gravity, m_softening, m_theta, accelerations, pPotentials, m_pThreadPool);
+	}
+
+
+	double NBodySystem::GetEnergy() const
+	{
+		const size_t numBodies = GetNumBodies();
+		std::vector<float> accelerations(3 * numBodies);
+		std::vector<float> potentials(numBodies);
+
+		// measuring the energy isn't part of the run, so its interactions aren't counted
+		const uint64_t numInteractions = m_numInteractions;
+		GetAccelerations(m_positions.m_data.data(), accelerations.data(), potentials.data());
+		m_numInteractions = numInteractions;
+
+		// every pair is counted from both ends so the potential energy is half the sum
+		double energy = 0.0;
+		for (size_t i = 0; i < numBodies; ++i)
+		{
+			const double speedSquared = static_cast<double>(m_speeds.m_data[i]) * m_speeds.m_data[i]
+				+ static_cast<double>(m_speeds.m_data[numBodies + i]) * m_speeds.m_data[numBodies + i]
+				+ static_cast<double>(m_speeds.m_data[2 * numBodies + i]) * m_speeds.m_data[2 * numBodies + i];
+			energy += 0.5 * m_masses[i] * (speedSquared + potentials[i]);
+		}
+		return energy;
+	}
+
+
+	void NBodySystem::Reset(size_t numBodies, unsigned int seed)
+	{
+		// Aarseth, Henon and Wielen's sampling of the Plummer model, scaled from a unit Plummer radius to
+		// a unit virial radius.  The far tail is cut off so a handful of bodies don't stretch the tree.
+		constexpr double pi = 3.14159265358979323846;
+		const double lengthScale = 3.0 * pi / 16.0;
+		const double speedScale = 1.0 / sqrt(lengthScale);
+
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<double> uniform(0.0, 1.0);
+		const auto getDirection = [&](double length, double* vector)
+		{
+			const double cosTheta = 2.0 * uniform(generator) - 1.0;
+			const double sinTheta = sqrt(1.0 - cosTheta * cosTheta);
+			const double phi = 2.0 * pi * uniform(generator);
+			vector[0] = length * sinTheta * cos(phi);
+			vector[1] = length * sinTheta * sin(phi);
+			vector[2] = length * cosTheta;
+		};
+
+		m_masses.assign(numBodies, 1.0f / numBodies);
+		m_positions.m_data.resize(3 * numBodies);
+		m_speeds.m_data.resize(3 * numBodies);
+		m_numInteractions = 0;
+
+		double meanPosition[3] = { 0.0, 0.0, 0.0 };
+		double meanSpeed[3] = { 0.0, 0.0, 0.0 };
+		for (size_t i = 0; i < numBodies; ++i)
+		{
+			double radius = 0.0;
+			do
+				radius = 1.0 / sqrt(pow(uniform(generator), -2.0 / 3.0) - 1.0);
+			while (radius > 10.0);
+
+			// von Neumann rejection for the speed as a fraction of the escape speed
+			double q = 0.0;
+			double g = 0.0;
+			do
+			{
+				q = uniform(generator);
+				g = 0.1 * uniform(generator);
+			} while (g > q * q * pow(1.0 - q * q, 3.5));
+			const double speed = q * sqrt(2.0) * pow(1.0 + radius * radius, -0.25);
+
+			double position[3];
+			double velocity[3];
+			getDirection(radius * lengthScale, position);
+			getDirection(speed * speedScale, velocity);
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				m_positions.m_data[axis * numBodies + i] = static_cast<float>(position[axis]);
+				m_speeds.m_data[axis * numBodies + i] = static_cast<float>(velocity[axis]);
+				meanPosition[axis] += position[axis] / numBodies;
+				meanSpeed[axis] += velocity[axis] / numBodies;
+			}
+		}
+
+		// centred on the origin and at rest as a whole
+		for (int axis = 0; axis < 3; ++axis)
+			for (size_t i = 0; i < numBodies; ++i)
+			{
+				m_positions.m_data[axis * numBodies + i] -= static_cast<float>(meanPosition[axis]);
+				m_speeds.m_data[axis * numBodies + i] -= static_cast<float>(meanSpeed[axis]);
+			}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODEWidget.h"
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+
+class ThreadPool;
+
+
+namespace ODESystem
+{
+	enum class ENBodyForce : unsigned int
+	{
+		Direct,				// every pair, exact but O(N^2)
+		BarnesHut,			// distant groups of bodies replaced by their centre of mass, O(N log N)
+	};
+
+
+	// Octree over the bodies for the Barnes-Hut approximation, rebuilt for every force evaluation.  The bodies
+	// are sorted along a Morton curve so every node covers a contiguous range of them, and the 64 cells two
+	// levels down are built in parallel, each into its own node pool.  The pools and sort buffers keep their
+	// capacity between builds so rebuilding doesn't allocate once the tree has reached its size.
+	class BarnesHutTree
+	{
+	public:
+		// positions hold the x of every body followed by every y then every z
+		void Build(const float* positions, const float* masses, size_t numBodies, ThreadPool* pThreadPool);
+
+		// Accelerations and optionally potentials in the original body order, in the same layout as the
+		// positions.  A node is used as a whole when its size is less than theta times its distance, and never
+		// when it holds the bodies being evaluated whatever theta is.  Returns the number of body-body and
+		// body-node interactions.
+		uint64_t GetAccelerations(float gravity, float softening, float theta, float* accelerations, float* pPotentials, ThreadPool* pThreadPool) const;
+
+		size_t GetNumNodes() const { return m_nodes.size(); }
+
+	private:
+		struct Node
+		{
+			float m_centerOfMass[3] = { 0.0f, 0.0f, 0.0f };
+			float m_mass = 0.0f;
+			float m_size = 0.0f;
+			unsigned int m_firstChild = 0;
+			unsigned int m_numChildren = 0;			// zero for leaves
+			unsigned int m_firstBody = 0;			// in sorted order
+			unsigned int m_numBodies = 0;
+		};
+
+		static constexpr unsigned int numBucketLevels = 2;
+		static constexpr unsigned int numBuckets = 1 << (3 * numBucketLevels);
+
+		void BuildNode(std::vector<Node>& pool, unsigned int nodeIndex, unsigned int begin, unsigned int end, unsigned int level) const;
+		void BuildBucket(unsigned int bucket);
+		void LinkTree();
+		void SetCenterOfMass(Node& node, const Node* nodes) const;
+
+		uint64_t GetLeafAccelerations(const Node& leaf, float gravity, float softening, float theta, float* accelerations, float* pPotentials) const;
+
+		std::vector<std::pair<uint64_t, unsigned int>> m_unsortedKeys;		// Morton key and body index
+		std::vector<std::pair<uint64_t, unsigned int>> m_sortedKeys;
+		std::vector<float> m_sortedPositions;
+		std::vector<float> m_sortedMasses;
+		std::array<unsigned int, numBuckets + 1> m_bucketStarts = {};
+		std::array<std::vector<Node>, numBuckets> m_bucketNodes;			// bucket root first
+		std::array<unsigned int, numBuckets> m_bucketRoots = {};			// where each pool goes in the tree
+		std::array<unsigned int, numBuckets> m_bucketOffsets = {};
+		std::vector<Node> m_nodes;											// root first
+		std::vector<unsigned int> m_leaves;
+		const float* m_pPositions = nullptr;
+		const float* m_pMasses = nullptr;
+		size_t m_numBodies = 0;
+		float m_rootSize = 0.0f;
+	};
+
+
+	// Self gravitating bodies, positions and speeds hold every x followed by every y then every z.  The
+	// softening length keeps close encounters and the self term of the direct sum finite.  The tree is
+	// reused between evaluations, so a system can't be evaluated from more than one thread at a time.
+	struct NBodySystem final : ODE::IState<DynamicStateData<float>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	{
+		typedef std::array<DynamicStateData<float>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> Derivatives;
+
+		DynamicStateData<float> m_positions;
+		DynamicStateData<float> m_speeds;
+		std::vector<float> m_masses;
+		float m_gravity = 1.0f;
+		float m_softening = 0.01f;
+		float m_theta = 0.5f;
+		ENBodyForce m_force = ENBodyForce::BarnesHut;
+		ThreadPool* m_pThreadPool = nullptr;					// evaluates on the calling thread when null
+
+		mutable BarnesHutTree m_tree;
+		mutable uint64_t m_numInteractions = 0;					// since the last reset
+
+		virtual void GetDerivatives(Derivatives& derivatives) const override
+		{
+			derivatives[(int)EStateDerivative::Position] = m_positions;
+			derivatives[(int)EStateDerivative::Speed] = m_speeds;
+		}
+
+		virtual DynamicStateData<float> GetNthDerivative(const Derivatives& derivatives) const override
+		{
+			DynamicStateData<float> accelerations;
+			accelerations.m_data.resize(m_positions.m_data.size());
+			GetAccelerations(derivatives[(int)EStateDerivative::Position].m_data.data(), accelerations.m_data.data(), nullptr);
+			return accelerations;
+		}
+
+		virtual void SetDerivatives(const Derivatives& derivatives) override
+		{
+			m_positions = derivatives[(int)EStateDerivative::Position];
+			m_speeds = derivatives[(int)EStateDerivative::Speed];
+		}
+
+		void GetAccelerations(const float* positions, float* accelerations, float* pPotentials) const;
+
+		// kinetic plus potential energy, the potential comes from the current force method so it's only an
+		// estimate for Barnes-Hut
+		double GetEnergy() const;
+
+		// Plummer sphere of equal masses in units where the total mass, gravity and virial radius are one
+		void Reset(size_t numBodies, unsigned int seed = 1);
+		size_t GetNumBodies() const { return m_masses.size(); }
+	};
+}
\ No newline at end of file
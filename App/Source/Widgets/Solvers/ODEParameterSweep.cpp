@@ -0,0 +1,67 @@
+#include "Widgets/Solvers/ODEParameterSweep.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+
+
+namespace ODESystem
+{
+	static void RunCell(const SweepGrid& grid, SweepCell& cell)
+	{
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		const unsigned int numSteps = static_cast<unsigned int>(ceilf(grid.m_duration / cell.m_stepSize));
+
+		// reused between the cells run on the same worker
+		thread_local std::vector<float> timeData;
+		thread_local std::vector<float> analyticalData;
+		timeData.clear();
+		for (unsigned int i = 0; i <= numSteps; ++i)
+			timeData.push_back(i * cell.m_stepSize);
+
+		SingleSpringMassSystem system;
+		system.Reset(cell.m_springConstant, cell.m_damping);
+		system.SolveAnalytical(timeData, analyticalData);
+
+		FixedSpringMethod method = grid.m_methods[cell.m_methodIndex].m_method;
+		float maxError = 0.0f;
+		double errorSquared = 0.0;
+		for (unsigned int i = 1; i <= numSteps; ++i)
+		{
+			method(system, cell.m_stepSize);
+			const float error = fabsf(system.m_massPos - analyticalData[i]);
+			maxError = std::max(maxError, error);
+			errorSquared += static_cast<double>(error) * error;
+		}
+
+		// std::max drops NaN so diverged and unsupported systems are flagged here instead
+		const bool isFinite = isfinite(system.m_massPos) && isfinite(errorSquared);
+		cell.m_maxError = isFinite ? maxError : NAN;
+		cell.m_rmsError = isFinite ? static_cast<float>(sqrt(errorSquared / numSteps)) : NAN;
+		cell.m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+
+	void RunParameterSweep(const SweepGrid& grid, ThreadPool& threadPool, std::vector<SweepCell>& cells)
+	{
+		const size_t numSpringConstants = grid.m_springConstants.size();
+		const size_t numDampings = grid.m_dampings.size();
+		const size_t numStepSizes = grid.m_stepSizes.size();
+
+		cells.resize(grid.GetNumCells());
+		for (size_t i = 0; i < cells.size(); ++i)
+		{
+			SweepCell& cell = cells[i];
+			cell.m_springConstant = grid.m_springConstants[i % numSpringConstants];
+			cell.m_damping = grid.m_dampings[(i / numSpringConstants) % numDampings];
+			cell.m_stepSize = grid.m_stepSizes[(i / (numSpringConstants * numDampings)) % numStepSizes];
+			cell.m_methodIndex = static_cast<unsigned int>(i / (numSpringConstants * numDampings * numStepSizes));
+		}
+
+		// a cell is tens of microseconds so small batches keep the queue overhead out of the way
+		constexpr size_t grainSize = 16;
+		threadPool.ParallelFor(cells.size(), [&grid, &cells](size_t index) { RunCell(grid, cells[index]); }, grainSize);
+	}
+}
\ No newline at end of file
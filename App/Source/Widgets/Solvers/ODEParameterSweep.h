@@ -0,0 +1,50 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODEWidget.h"
+#include <vector>
+
+
+
+class ThreadPool;
+
+
+namespace ODESystem
+{
+	struct SweepMethod
+	{
+		const char* m_name = nullptr;
+		FixedSpringMethod m_method;
+	};
+
+
+	// every combination of the axes is a cell, the spring constant varies fastest
+	struct SweepGrid
+	{
+		std::vector<float> m_springConstants;
+		std::vector<float> m_dampings;
+		std::vector<float> m_stepSizes;
+		std::vector<SweepMethod> m_methods;
+		float m_duration = 10.0f;
+
+		size_t GetNumCells() const { return m_springConstants.size() * m_dampings.size() * m_stepSizes.size() * m_methods.size(); }
+	};
+
+
+	struct SweepCell
+	{
+		float m_springConstant = 0.0f;
+		float m_damping = 0.0f;
+		float m_stepSize = 0.0f;
+		unsigned int m_methodIndex = 0;
+		float m_maxError = 0.0f;			// against SolveAnalytical at the end of every step
+		float m_rmsError = 0.0f;
+		double m_seconds = 0.0;				// wall time of the integration and error measurement
+	};
+
+
+	// Runs the single spring for every cell of the grid across the pool.  Each cell takes its own copy of
+	// the method so stateful methods like the adaptive integrators start fresh and aren't shared between
+	// threads.  Systems the analytical solution doesn't cover (overdamped) report a NaN error.
+	void RunParameterSweep(const SweepGrid& grid, ThreadPool& threadPool, std::vector<SweepCell>& cells);
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "Widgets/Solvers/ODESpringLattice.h"
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace ODESystem
+{
+	// columns per block, three rows of a block of positions stay in the L1 cache while the rows are swept
+	static constexpr size_t latticeBlockWidth = 1024;
+
+
+	static void GetChainAccelerations(size_t numMasses, float springConstant, float damping, const float* __restrict positions, const float* __restrict speeds, float* __restrict accelerations)
+	{
+		if (numMasses == 1)
+		{
+			accelerations[0] = -2.0f * springConstant * positions[0] - damping * speeds[0];
+			return;
+		}
+
+		accelerations[0] = springConstant * (positions[1] - 2.0f * positions[0]) - damping * speeds[0];
+		for (size_t i = 1; i < numMasses - 1; ++i)
+			accelerations[i] = springConstant * (positions[i - 1] - 2.0f * positions[i] + positions[i + 1]) - damping * speeds[i];
+		accelerations[numMasses - 1] = springConstant * (positions[numMasses - 2] - 2.0f * positions[numMasses - 1]) - damping * speeds[numMasses - 1];
+	}
+
+
+	// One block of one row of the lattice.  The pointers are at the start of the block and the rows above and
+	// below are zeros at the edges of the lattice, so only the first and last columns need their own case.
+	static void GetLatticeRowAccelerations(size_t blockStart, size_t blockEnd, size_t width, float springConstant, float damping,
+		const float* __restrict up, const float* __restrict row, const float* __restrict down, const float* __restrict speeds, float* __restrict accelerations)
+	{
+		const size_t blockSize = blockEnd - blockStart;
+		const size_t first = (blockStart == 0) ? 1 : 0;
+		const size_t last = (blockEnd == width) ? blockSize - 1 : blockSize;
+
+		for (size_t i = first; i < last; ++i)
+			accelerations[i] = springConstant * (up[i] + down[i] + row[i - 1] + row[i + 1] - 4.0f * row[i]) - damping * speeds[i];
+
+		if (blockStart == 0)
+		{
+			const float right = (width > 1) ? row[1] : 0.0f;
+			accelerations[0] = springConstant * (up[0] + down[0] + right - 4.0f * row[0]) - damping * speeds[0];
+		}
+		if (blockEnd == width && width > 1)
+		{
+			const size_t i = blockSize - 1;
+			accelerations[i] = springConstant * (up[i] + down[i] + row[i - 1] - 4.0f * row[i]) - damping * speeds[i];
+		}
+	}
+
+
+	void SpringLattice::GetAccelerations(const float* positions, const float* speeds, float* accelerations) const
+	{
+		if (m_height == 1)
+		{
+			GetChainAccelerations(m_width, m_springConstant, m_damping, positions, speeds, accelerations);
+			return;
+		}
+
+		// stands in for the fixed masses above the first row and below the last
+		static const float anchors[latticeBlockWidth] = {};
+
+		const size_t width = m_width;
+		for (size_t blockStart = 0; blockStart < width; blockStart += latticeBlockWidth)
+		{
+			const size_t blockEnd = std::min(blockStart + latticeBlockWidth, width);
+			for (size_t y = 0; y < m_height; ++y)
+			{
+				const size_t rowStart = y * width + blockStart;
+				const float* up = (y > 0) ? positions + rowStart - width : anchors;
+				const float* down = (y + 1 < m_height) ? positions + rowStart + width : anchors;
+				GetLatticeRowAccelerations(blockStart, blockEnd, width, m_springConstant, m_damping,
+					up, positions + rowStart, down, speeds + rowStart, accelerations + rowStart);
+			}
+		}
+	}
+
+
+	void SpringLattice::SolveAnalytical(float time, float* positions) const
+	{
+		// a sine standing wave is an eigenvector of the stencil, so every mass oscillates like a single spring
+		// whose constant is the spring constant times the stencil's eigenvalue
+		constexpr double pi = 3.14159265358979323846;
+		const double waveNumberX = pi * m_modeX / (m_width + 1.0);
+		const double waveNumberY = pi * m_modeY / (m_height + 1.0);
+		const double eigenvalue = (2.0 - 2.0 * cos(waveNumberX)) + ((m_height > 1) ? 2.0 - 2.0 * cos(waveNumberY) : 0.0);
+
+		const double damping = m_damping;
+		const double angularFrequency = sqrt(std::max(m_springConstant * eigenvalue - 0.25 * damping * damping, 0.0));
+		const double sinOverFrequency = (angularFrequency > 1.0e-6) ? sin(angularFrequency * time) / angularFrequency : time;
+		const double amplitude = exp(-0.5 * damping * time) * (cos(angularFrequency * time) + 0.5 * damping * sinOverFrequency);
+
+		std::vector<double> shapeX(m_width);
+		for (unsigned int x = 0; x < m_width; ++x)
+			shapeX[x] = amplitude * sin(waveNumberX * (x + 1));
+
+		for (unsigned int y = 0; y < m_height; ++y)
+		{
+			const double shapeY = (m_height > 1) ? sin(waveNumberY * (y + 1)) : 1.0;
+			float* row = positions + static_cast<size_t>(y) * m_width;
+			for (unsigned int x = 0; x < m_width; ++x)
+				row[x] = static_cast<float>(shapeX[x] * shapeY);
+		}
+	}
+
+
+
+	void SpringLatticeSystem::Reset(unsigned int width, unsigned int height, float springConstant, float damping, unsigned int modeX, unsigned int modeY)
+	{
+		m_lattice = { width, height, modeX, modeY, springConstant, damping };
+		m_massPos.m_data.resize(m_lattice.GetNumMasses());
+		m_massSpeed.m_data.assign(m_lattice.GetNumMasses(), 0.0f);
+		m_lattice.SolveAnalytical(0.0f, m_massPos.m_data.data());
+	}
+
+
+
+	void HeterogeneousSpringChain::GetAccelerations(const float* __restrict positions, const float* __restrict speeds, const std::vector<ODEMultirate::Range>& ranges,
+		float* __restrict accelerations) const
+	{
+		const unsigned int numMasses = static_cast<unsigned int>(GetSize());
+		const float* __restrict springConstants = m_springConstants.data();
+		for (const ODEMultirate::Range& range : ranges)
+		{
+			if (range.m_begin >= range.m_end)
+				continue;
+
+			// the anchors only need handling at the ends of the chain, which keeps the loop over the rest branch free
+			const unsigned int begin = std::max(range.m_begin, 1u);
+			const unsigned int end = std::min(range.m_end, numMasses - 1);
+			for (unsigned int i = begin; i < end; ++i)
+				accelerations[i] = springConstants[i] * (positions[i - 1] - positions[i]) + springConstants[i + 1] * (positions[i + 1] - positions[i]) - m_damping * speeds[i];
+
+			if (range.m_begin == 0)
+			{
+				const float next = (numMasses > 1) ? positions[1] : 0.0f;
+				accelerations[0] = -springConstants[0] * positions[0] + springConstants[1] * (next - positions[0]) - m_damping * speeds[0];
+			}
+			if (range.m_end == numMasses && numMasses > 1)
+			{
+				const unsigned int i = numMasses - 1;
+				accelerations[i] = springConstants[i] * (positions[i - 1] - positions[i]) - springConstants[i + 1] * positions[i] - m_damping * speeds[i];
+			}
+		}
+	}
+
+
+	void HeterogeneousSpringChain::GetCoupledComponents(const std::vector<ODEMultirate::Range>& ranges, std::vector<unsigned int>& components) const
+	{
+		const unsigned int numMasses = static_cast<unsigned int>(GetSize());
+		for (const ODEMultirate::Range& range : ranges)
+		{
+			if (range.m_begin > 0)
+				components.push_back(range.m_begin - 1);
+			if (range.m_end < numMasses)
+				components.push_back(range.m_end);
+		}
+	}
+
+
+	void HeterogeneousSpringChain::Reset(unsigned int numMasses, float softSpringConstant, float stiffSpringConstant, unsigned int stiffSpacing, float damping)
+	{
+		m_damping = damping;
+		m_springConstants.resize(numMasses + 1);
+		for (unsigned int i = 0; i <= numMasses; ++i)
+			m_springConstants[i] = (stiffSpacing > 0 && i % stiffSpacing == stiffSpacing / 2) ? stiffSpringConstant : softSpringConstant;
+
+		constexpr double pi = 3.14159265358979323846;
+		constexpr float nudge = 0.01f;
+		Resize(numMasses);
+		float* positions = GetPositions();
+		for (unsigned int i = 0; i < numMasses; ++i)
+			positions[i] = static_cast<float>(sin(pi * (i + 1) / (numMasses + 1.0))) + ((m_springConstants[i] != softSpringConstant) ? nudge : 0.0f);
+		std::fill_n(GetSpeeds(), numMasses, 0.0f);
+	}
+
+
+	void HeterogeneousSpringChain::GetStiffRanges(float springConstantThreshold, std::vector<ODEMultirate::Range>& ranges) const
+	{
+		ranges.clear();
+		const unsigned int numMasses = static_cast<unsigned int>(GetSize());
+		for (unsigned int spring = 0; spring <= numMasses; ++spring)
+		{
+			if (m_springConstants[spring] <= springConstantThreshold)
+				continue;
+
+			const unsigned int begin = (spring > 0) ? spring - 1 : 0;
+			const unsigned int end = std::min(spring + 1, numMasses);
+			if (!ranges.empty() && ranges.back().m_end >= begin)
+				ranges.back().m_end = std::max(ranges.back().m_end, end);
+			else
+				ranges.push_back({ begin, end });
+		}
+	}
+
+
+
+	void SpringLatticeBatch::GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const
+	{
+		m_lattice.GetAccelerations(derivatives[(int)EStateDerivative::Position], derivatives[(int)EStateDerivative::Speed], nthDerivatives);
+	}
+
+
+	void SpringLatticeBatch::Reset(unsigned int width, unsigned int height, float springConstant, float damping, unsigned int modeX, unsigned int modeY)
+	{
+		m_lattice = { width, height, modeX, modeY, springConstant, damping };
+		Resize(m_lattice.GetNumMasses());
+		std::fill_n(GetDerivatives((int)EStateDerivative::Speed), GetSize(), 0.0f);
+		m_lattice.SolveAnalytical(0.0f, GetDerivatives((int)EStateDerivative::Position));
+	}
+}
\ No newline at end of file
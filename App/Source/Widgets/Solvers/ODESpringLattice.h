@@ -0,0 +1,94 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODEWidget.h"
+#include "Solvers/ODEMultirate.h"
+#include <vector>
+
+
+
+namespace ODESystem
+{
+	// Width by height grid of unit masses joined to their four neighbours by springs, with the masses
+	// outside the grid fixed in place.  A height of one is a chain where each mass only has the two springs
+	// along it.  Each mass moves along a single axis so the 2D lattice is a membrane, the linearised
+	// out of plane motion of a cloth.  Masses are stored row by row.
+	struct SpringLattice
+	{
+		unsigned int m_width = 0;
+		unsigned int m_height = 0;
+		unsigned int m_modeX = 1;			// standing wave the masses start in and the analytical solution follows
+		unsigned int m_modeY = 1;
+		float m_springConstant = 1.0f;
+		float m_damping = 0.0f;
+
+		size_t GetNumMasses() const { return static_cast<size_t>(m_width) * m_height; }
+
+		// the force only depends on the neighbours so evaluating it is a stencil over the grid rather than a matrix product
+		void GetAccelerations(const float* positions, const float* speeds, float* accelerations) const;
+
+		// positions of the standing wave at time, starting from rest so the initial state is time zero
+		void SolveAnalytical(float time, float* positions) const;
+	};
+
+
+	struct SpringLatticeSystem final : ODE::IState<DynamicStateData<float>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	{
+		typedef std::array<DynamicStateData<float>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> Derivatives;
+
+		SpringLattice m_lattice;
+		DynamicStateData<float> m_massPos;
+		DynamicStateData<float> m_massSpeed;
+
+		virtual void GetDerivatives(Derivatives& derivatives) const override
+		{
+			derivatives[(int)EStateDerivative::Position] = m_massPos;
+			derivatives[(int)EStateDerivative::Speed] = m_massSpeed;
+		}
+
+		virtual DynamicStateData<float> GetNthDerivative(const Derivatives& derivatives) const override
+		{
+			DynamicStateData<float> accelerations;
+			accelerations.m_data.resize(m_lattice.GetNumMasses());
+			m_lattice.GetAccelerations(derivatives[(int)EStateDerivative::Position].m_data.data(), derivatives[(int)EStateDerivative::Speed].m_data.data(), accelerations.m_data.data());
+			return accelerations;
+		}
+
+		virtual void SetDerivatives(const Derivatives& derivatives) override
+		{
+			m_massPos = derivatives[(int)EStateDerivative::Position];
+			m_massSpeed = derivatives[(int)EStateDerivative::Speed];
+		}
+
+		void Reset(unsigned int width, unsigned int height, float springConstant, float damping, unsigned int modeX = 1, unsigned int modeY = 1);
+	};
+
+
+	struct SpringLatticeBatch : ODEBatch::IState<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	{
+		SpringLattice m_lattice;
+
+		virtual void GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const override;
+		void Reset(unsigned int width, unsigned int height, float springConstant, float damping, unsigned int modeX = 1, unsigned int modeY = 1);
+	};
+
+
+	// A chain of unit masses whose springs each have their own constant, so a few stiff springs can sit
+	// among many soft ones.  Spring i joins mass i - 1 to mass i and the first and last join the ends to
+	// fixed anchors, so there is one more spring than there are masses.
+	struct HeterogeneousSpringChain : ODEMultirate::IState<float>
+	{
+		std::vector<float> m_springConstants;
+		float m_damping = 0.0f;
+
+		virtual void GetAccelerations(const float* positions, const float* speeds, const std::vector<ODEMultirate::Range>& ranges, float* accelerations) const override;
+		virtual void GetCoupledComponents(const std::vector<ODEMultirate::Range>& ranges, std::vector<unsigned int>& components) const override;
+
+		// Every stiffSpacing'th spring is stiff.  The masses start at rest in the lowest mode of the uniform
+		// chain, with the mass after every stiff spring nudged so that the stiff springs ring as well.
+		void Reset(unsigned int numMasses, float softSpringConstant, float stiffSpringConstant, unsigned int stiffSpacing, float damping);
+
+		// the masses on both ends of every spring stiffer than the threshold, as sorted ranges for the multirate methods
+		void GetStiffRanges(float springConstantThreshold, std::vector<ODEMultirate::Range>& ranges) const;
+	};
+}
\ No newline at end of file
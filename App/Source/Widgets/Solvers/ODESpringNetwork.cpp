@@ -0,0 +1,183 @@
+#include "Widgets/Solvers/ODESpringNetwork.h"
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace ODESystem
+{
+	void SpringNetwork::Clear()
+	{
+		m_restPositions.clear();
+		m_inverseMasses.clear();
+		m_particles0.clear();
+		m_particles1.clear();
+		m_restLengths.clear();
+	}
+
+
+	void SpringNetwork::BuildCloth(unsigned int width, unsigned int height, float size, float totalMass, float springConstant)
+	{
+		Clear();
+		m_springConstant = springConstant;
+		if (width < 2 || height < 2)
+			return;
+
+		const size_t numParticles = static_cast<size_t>(width) * height;
+		const float spacing = size / (std::max(width, height) - 1);
+		m_restPositions.assign(3 * numParticles, 0.0f);
+		m_inverseMasses.assign(numParticles, numParticles / totalMass);
+
+		const auto getIndex = [width](unsigned int x, unsigned int y) { return y * width + x; };
+		const auto addSpring = [this](unsigned int particle0, unsigned int particle1, float restLength)
+		{
+			m_particles0.push_back(particle0);
+			m_particles1.push_back(particle1);
+			m_restLengths.push_back(restLength);
+		};
+
+		const float diagonal = spacing * sqrtf(2.0f);
+		for (unsigned int y = 0; y < height; ++y)
+		{
+			for (unsigned int x = 0; x < width; ++x)
+			{
+				const unsigned int index = getIndex(x, y);
+				m_restPositions[index] = x * spacing;
+				m_restPositions[numParticles + index] = -(y * spacing);
+
+				if (x + 1 < width)
+					addSpring(index, getIndex(x + 1, y), spacing);
+				if (y + 1 < height)
+					addSpring(index, getIndex(x, y + 1), spacing);
+				if (x + 1 < width && y + 1 < height)
+				{
+					addSpring(index, getIndex(x + 1, y + 1), diagonal);
+					addSpring(getIndex(x + 1, y), getIndex(x, y + 1), diagonal);
+				}
+			}
+		}
+
+		m_inverseMasses[getIndex(0, 0)] = 0.0f;
+		m_inverseMasses[getIndex(width - 1, 0)] = 0.0f;
+	}
+
+
+	void SpringNetwork::BuildRope(unsigned int numParticles, float length, float totalMass, float springConstant)
+	{
+		Clear();
+		m_springConstant = springConstant;
+		if (numParticles < 2)
+			return;
+
+		const float spacing = length / (numParticles - 1);
+		m_restPositions.assign(3 * static_cast<size_t>(numParticles), 0.0f);
+		m_inverseMasses.assign(numParticles, numParticles / totalMass);
+
+		for (unsigned int i = 0; i < numParticles; ++i)
+		{
+			m_restPositions[i] = i * spacing;
+			if (i + 1 < numParticles)
+			{
+				m_particles0.push_back(i);
+				m_particles1.push_back(i + 1);
+				m_restLengths.push_back(spacing);
+			}
+		}
+
+		m_inverseMasses[0] = 0.0f;
+	}
+
+
+	void SpringNetwork::CreateXPBD(XPBD::ParticleStore& particles, XPBD::DistanceConstraints& constraints) const
+	{
+		particles.Resize(GetNumParticles());
+		particles.m_positions = m_restPositions;
+		particles.m_prevPositions = m_restPositions;
+		std::fill(particles.m_velocities.begin(), particles.m_velocities.end(), 0.0f);
+		particles.m_inverseMasses = m_inverseMasses;
+
+		constraints = XPBD::DistanceConstraints();
+		const float compliance = 1.0f / m_springConstant;
+		for (size_t i = 0; i < GetNumSprings(); ++i)
+			constraints.Add(m_particles0[i], m_particles1[i], m_restLengths[i], compliance);
+		constraints.Colour(GetNumParticles());
+	}
+
+
+	float SpringNetwork::GetMaxStrain(const float* positions) const
+	{
+		const size_t numParticles = GetNumParticles();
+		float maxStrain = 0.0f;
+		for (size_t i = 0; i < GetNumSprings(); ++i)
+		{
+			float lengthSquared = 0.0f;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				const float delta = positions[axis * numParticles + m_particles1[i]] - positions[axis * numParticles + m_particles0[i]];
+				lengthSquared += delta * delta;
+			}
+
+			// written so a NaN from a method that blew up is kept
+			const float strain = fabsf(sqrtf(lengthSquared) - m_restLengths[i]) / m_restLengths[i];
+			if (!(strain <= maxStrain))
+				maxStrain = strain;
+		}
+		return maxStrain;
+	}
+
+
+
+	void SpringNetworkSystem::GetAccelerations(const float* positions, float* accelerations) const
+	{
+		const SpringNetwork& network = *m_pNetwork;
+		const size_t numParticles = network.GetNumParticles();
+		const float* x = positions;
+		const float* y = positions + numParticles;
+		const float* z = positions + 2 * numParticles;
+		float* accelerationsX = accelerations;
+		float* accelerationsY = accelerations + numParticles;
+		float* accelerationsZ = accelerations + 2 * numParticles;
+
+		std::fill_n(accelerationsX, numParticles, 0.0f);
+		std::fill_n(accelerationsY, numParticles, 0.0f);
+		std::fill_n(accelerationsZ, numParticles, 0.0f);
+
+		// forces are gathered in the accelerations and scaled by the inverse masses after
+		for (size_t i = 0; i < network.GetNumSprings(); ++i)
+		{
+			const unsigned int particle0 = network.m_particles0[i];
+			const unsigned int particle1 = network.m_particles1[i];
+			const float dx = x[particle1] - x[particle0];
+			const float dy = y[particle1] - y[particle0];
+			const float dz = z[particle1] - z[particle0];
+			const float length = sqrtf(dx * dx + dy * dy + dz * dz);
+			if (length < 1.0e-9f)
+				continue;
+
+			const float scale = network.m_springConstant * (length - network.m_restLengths[i]) / length;
+			accelerationsX[particle0] += scale * dx;
+			accelerationsY[particle0] += scale * dy;
+			accelerationsZ[particle0] += scale * dz;
+			accelerationsX[particle1] -= scale * dx;
+			accelerationsY[particle1] -= scale * dy;
+			accelerationsZ[particle1] -= scale * dz;
+		}
+
+		for (size_t i = 0; i < numParticles; ++i)
+		{
+			const float inverseMass = network.m_inverseMasses[i];
+			const float gravityScale = (inverseMass > 0.0f) ? 1.0f : 0.0f;
+			accelerationsX[i] = accelerationsX[i] * inverseMass + m_gravity[0] * gravityScale;
+			accelerationsY[i] = accelerationsY[i] * inverseMass + m_gravity[1] * gravityScale;
+			accelerationsZ[i] = accelerationsZ[i] * inverseMass + m_gravity[2] * gravityScale;
+		}
+	}
+
+
+	void SpringNetworkSystem::Reset(const SpringNetwork& network)
+	{
+		m_pNetwork = &network;
+		m_positions.m_data = network.m_restPositions;
+		m_speeds.m_data.assign(network.m_restPositions.size(), 0.0f);
+	}
+}
\ No newline at end of file
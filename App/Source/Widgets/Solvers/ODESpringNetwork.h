@@ -0,0 +1,81 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODEWidget.h"
+#include "Solvers/XPBD.h"
+#include <array>
+#include <vector>
+
+
+
+namespace ODESystem
+{
+	// Particles joined by springs of a single constant, in 3D with gravity along -y.  The positions hold
+	// every x followed by every y then every z like the n-body positions, and a zero inverse mass pins a
+	// particle.  The same network steps either as an ODE of spring forces or with the XPBD solver.
+	struct SpringNetwork
+	{
+		std::vector<float> m_restPositions;
+		std::vector<float> m_inverseMasses;
+		std::vector<unsigned int> m_particles0;
+		std::vector<unsigned int> m_particles1;
+		std::vector<float> m_restLengths;
+		float m_springConstant = 1.0f;
+
+		size_t GetNumParticles() const { return m_inverseMasses.size(); }
+		size_t GetNumSprings() const { return m_restLengths.size(); }
+
+		// no particles or springs
+		void Clear();
+
+		// A square cloth of width by height particles hanging in the xy plane from its top corners, with
+		// springs along the rows and columns and across both diagonals of every cell.  Fewer than two
+		// particles along either side leaves the network empty.
+		void BuildCloth(unsigned int width, unsigned int height, float size, float totalMass, float springConstant);
+
+		// a horizontal rope pinned at its first particle, empty with fewer than two particles
+		void BuildRope(unsigned int numParticles, float length, float totalMass, float springConstant);
+
+		// the particles at rest and a constraint per spring with the spring's compliance, coloured
+		void CreateXPBD(XPBD::ParticleStore& particles, XPBD::DistanceConstraints& constraints) const;
+
+		// largest stretch or compression of any spring relative to its rest length
+		float GetMaxStrain(const float* positions) const;
+	};
+
+
+	struct SpringNetworkSystem final : ODE::IState<DynamicStateData<float>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	{
+		typedef std::array<DynamicStateData<float>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> Derivatives;
+
+		const SpringNetwork* m_pNetwork = nullptr;
+		DynamicStateData<float> m_positions;
+		DynamicStateData<float> m_speeds;
+		std::array<float, 3> m_gravity = { 0.0f, -9.81f, 0.0f };
+
+		virtual void GetDerivatives(Derivatives& derivatives) const override
+		{
+			derivatives[(int)EStateDerivative::Position] = m_positions;
+			derivatives[(int)EStateDerivative::Speed] = m_speeds;
+		}
+
+		virtual DynamicStateData<float> GetNthDerivative(const Derivatives& derivatives) const override
+		{
+			DynamicStateData<float> accelerations;
+			accelerations.m_data.resize(m_positions.m_data.size());
+			GetAccelerations(derivatives[(int)EStateDerivative::Position].m_data.data(), accelerations.m_data.data());
+			return accelerations;
+		}
+
+		virtual void SetDerivatives(const Derivatives& derivatives) override
+		{
+			m_positions = derivatives[(int)EStateDerivative::Position];
+			m_speeds = derivatives[(int)EStateDerivative::Speed];
+		}
+
+		void GetAccelerations(const float* positions, float* accelerations) const;
+
+		// the network at rest, which has to outlive the system
+		void Reset(const SpringNetwork& network);
+	};
+}
\ No newline at end of file
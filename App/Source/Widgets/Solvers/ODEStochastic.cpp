@@ -0,0 +1,172 @@
+#include "Widgets/Solvers/ODEStochastic.h"
+#include "Functions/Random.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <math.h>
+
+
+
+namespace ODESystem
+{
+	void StochasticSpringMassBatch::GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const
+	{
+		const size_t size = GetSize();
+		const float* __restrict positions = derivatives[(int)EStateDerivative::Position];
+		const float* __restrict speeds = derivatives[(int)EStateDerivative::Speed];
+		float* __restrict accelerations = nthDerivatives;
+
+		const float springConstant = m_springConstant;
+		const float damping = m_damping;
+		for (size_t i = 0; i < size; ++i)
+			accelerations[i] = -(positions[i] * springConstant + speeds[i] * damping);
+	}
+
+
+	void StochasticSpringMassBatch::GetDiffusions(const std::array<const float*, 2>& derivatives, float* diffusions, float* diffusionSlopes) const
+	{
+		const size_t size = GetSize();
+		const float* __restrict speeds = derivatives[(int)EStateDerivative::Speed];
+		float* __restrict noises = diffusions;
+		float* __restrict slopes = diffusionSlopes;
+
+		const float additiveNoise = m_additiveNoise;
+		const float multiplicativeNoise = m_multiplicativeNoise;
+		for (size_t i = 0; i < size; ++i)
+		{
+			noises[i] = additiveNoise + multiplicativeNoise * speeds[i];
+			slopes[i] = multiplicativeNoise;
+		}
+	}
+
+
+	void StochasticSpringMassBatch::Reset(size_t numPaths, float springConstant, float damping, float additiveNoise, float multiplicativeNoise)
+	{
+		Resize(numPaths);
+		m_springConstant = springConstant;
+		m_damping = damping;
+		m_additiveNoise = additiveNoise;
+		m_multiplicativeNoise = multiplicativeNoise;
+
+		float* positions = GetDerivatives((int)EStateDerivative::Position);
+		float* speeds = GetDerivatives((int)EStateDerivative::Speed);
+		for (size_t i = 0; i < numPaths; ++i)
+		{
+			positions[i] = 1.0f;
+			speeds[i] = 0.0f;
+		}
+	}
+
+
+
+	// the chunk size, rather than the number of threads, decides how the statistics are summed
+	static constexpr size_t pathsPerChunk = 1024;
+
+
+	// mean and sum of squared differences from it, which merge between chunks without losing precision
+	struct ChunkStatistics
+	{
+		std::vector<double> m_means;
+		std::vector<double> m_sumSquares;
+	};
+
+
+	static void AddSample(const StochasticSpringMassBatch& batch, unsigned int sampleIndex, ChunkStatistics& statistics)
+	{
+		const size_t numPaths = batch.GetSize();
+		const float* positions = batch.GetDerivatives((int)EStateDerivative::Position);
+
+		double sum = 0.0;
+		for (size_t i = 0; i < numPaths; ++i)
+			sum += positions[i];
+		const double mean = sum / numPaths;
+
+		double sumSquares = 0.0;
+		for (size_t i = 0; i < numPaths; ++i)
+			sumSquares += (positions[i] - mean) * (positions[i] - mean);
+
+		statistics.m_means[sampleIndex] = mean;
+		statistics.m_sumSquares[sampleIndex] = sumSquares;
+	}
+
+
+	static void RunChunk(const EnsembleSettings& settings, size_t firstPath, size_t numPaths, ChunkStatistics& statistics)
+	{
+		StochasticSpringMassBatch batch;
+		batch.Reset(numPaths, settings.m_springConstant, settings.m_damping, settings.m_additiveNoise, settings.m_multiplicativeNoise);
+
+		const unsigned int numSamples = 1 + settings.m_numSteps / settings.m_stepsPerSample;
+		statistics.m_means.resize(numSamples);
+		statistics.m_sumSquares.resize(numSamples);
+		AddSample(batch, 0, statistics);
+
+		std::vector<float> wienerIncrements(numPaths);
+		const float incrementScale = sqrtf(settings.m_stepSize);
+		for (unsigned int step = 0; step < settings.m_numSteps; ++step)
+		{
+			Random::FillNormals(settings.m_seed, step, firstPath, wienerIncrements.data(), numPaths);
+			for (float& wienerIncrement : wienerIncrements)
+				wienerIncrement *= incrementScale;
+
+			if (settings.m_method == EStochasticMethod::Milstein)
+				SDE::Milstein(batch, settings.m_stepSize, wienerIncrements.data());
+			else
+				SDE::EulerMaruyama(batch, settings.m_stepSize, wienerIncrements.data());
+
+			if ((step + 1) % settings.m_stepsPerSample == 0)
+				AddSample(batch, (step + 1) / settings.m_stepsPerSample, statistics);
+		}
+	}
+
+
+	void RunEnsemble(const EnsembleSettings& requestedSettings, ThreadPool* pThreadPool, EnsembleStatistics& statistics)
+	{
+		// zero steps per sample would divide by zero, so it samples every step instead
+		EnsembleSettings settings = requestedSettings;
+		settings.m_stepsPerSample = std::max(settings.m_stepsPerSample, 1u);
+
+		const size_t numChunks = (settings.m_numPaths + pathsPerChunk - 1) / pathsPerChunk;
+		std::vector<ChunkStatistics> chunks(numChunks);
+
+		const auto runChunk = [&settings, &chunks](size_t chunkIndex)
+		{
+			const size_t firstPath = chunkIndex * pathsPerChunk;
+			RunChunk(settings, firstPath, std::min(pathsPerChunk, settings.m_numPaths - firstPath), chunks[chunkIndex]);
+		};
+
+		if (pThreadPool)
+		{
+			pThreadPool->ParallelFor(numChunks, runChunk);
+		}
+		else
+		{
+			for (size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+				runChunk(chunkIndex);
+		}
+
+		// Chan et al's pairwise update, in chunk order
+		const unsigned int numSamples = 1 + settings.m_numSteps / settings.m_stepsPerSample;
+		statistics.m_times.resize(numSamples);
+		statistics.m_means.assign(numSamples, 0.0);
+		statistics.m_variances.assign(numSamples, 0.0);
+
+		for (unsigned int sample = 0; sample < numSamples; ++sample)
+		{
+			double count = 0.0;
+			double mean = 0.0;
+			double sumSquares = 0.0;
+			for (size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+			{
+				const double chunkCount = static_cast<double>(std::min(pathsPerChunk, settings.m_numPaths - chunkIndex * pathsPerChunk));
+				const double delta = chunks[chunkIndex].m_means[sample] - mean;
+				const double totalCount = count + chunkCount;
+				mean += delta * chunkCount / totalCount;
+				sumSquares += chunks[chunkIndex].m_sumSquares[sample] + delta * delta * count * chunkCount / totalCount;
+				count = totalCount;
+			}
+
+			statistics.m_times[sample] = sample * settings.m_stepsPerSample * settings.m_stepSize;
+			statistics.m_means[sample] = mean;
+			statistics.m_variances[sample] = (count > 1.0) ? sumSquares / (count - 1.0) : 0.0;
+		}
+	}
+}
\ No newline at end of file
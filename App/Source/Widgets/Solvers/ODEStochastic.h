@@ -0,0 +1,67 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODEWidget.h"
+#include "Solvers/SDE.h"
+#include <stdint.h>
+#include <vector>
+
+
+
+class ThreadPool;
+
+
+namespace ODESystem
+{
+	// Single spring masses driven by a random force, with a constant part and a part proportional to the
+	// speed like a noisy damper
+	struct StochasticSpringMassBatch : SDE::IState<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	{
+		float m_springConstant = 0.0f;
+		float m_damping = 0.0f;
+		float m_additiveNoise = 0.0f;
+		float m_multiplicativeNoise = 0.0f;
+
+		virtual void GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const override;
+		virtual void GetDiffusions(const std::array<const float*, 2>& derivatives, float* diffusions, float* diffusionSlopes) const override;
+		void Reset(size_t numPaths, float springConstant, float damping, float additiveNoise, float multiplicativeNoise);
+	};
+
+
+	enum class EStochasticMethod : unsigned int
+	{
+		EulerMaruyama,
+		Milstein
+	};
+
+
+	struct EnsembleSettings
+	{
+		float m_springConstant = 10.0f;
+		float m_damping = 0.1f;
+		float m_additiveNoise = 0.0f;
+		float m_multiplicativeNoise = 0.0f;
+		float m_stepSize = 1.0f / 60.0f;
+		unsigned int m_numSteps = 600;
+		unsigned int m_stepsPerSample = 1;		// zero is taken as one
+		size_t m_numPaths = 10000;
+		uint64_t m_seed = 0;
+		EStochasticMethod m_method = EStochasticMethod::EulerMaruyama;
+	};
+
+
+	// position statistics across the paths, taken at the start and after every m_stepsPerSample steps
+	struct EnsembleStatistics
+	{
+		std::vector<float> m_times;
+		std::vector<double> m_means;
+		std::vector<double> m_variances;
+	};
+
+
+	// Runs the paths in fixed chunks across the pool, or on the calling thread without one.  Path i draws
+	// its noise from stream i of a counter based generator and the chunk statistics are merged in chunk
+	// order, so the results are the same bit for bit whatever the number of threads.  Only the per sample
+	// statistics are kept, not the paths.
+	void RunEnsemble(const EnsembleSettings& settings, ThreadPool* pThreadPool, EnsembleStatistics& statistics);
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "Widgets/Solvers/ODETrajectoryCache.h"
+
+
+
+namespace ODESystem
+{
+	void TrajectoryCache::Trim()
+	{
+		size_t memorySize = GetMemorySize();
+		while (memorySize > m_memoryBudget && m_entries.size() > 1)
+		{
+			const Entry& entry = m_entries.back();
+			memorySize -= entry.m_pTrajectory->GetMemorySize();
+			m_lookup.erase(entry.m_key);
+			m_entries.pop_back();
+		}
+	}
+
+
+	size_t TrajectoryCache::GetMemorySize() const
+	{
+		size_t memorySize = 0;
+		for (const Entry& entry : m_entries)
+			memorySize += entry.m_pTrajectory->GetMemorySize();
+		return memorySize;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#pragma once
+
+
+#include "Widgets/Solvers/ODETrajectoryFile.h"
+#include "Widgets/Solvers/ODEWidget.h"
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+
+namespace ODESystem
+{
+	struct ITrajectory
+	{
+		virtual ~ITrajectory() {}
+		virtual size_t GetMemorySize() const = 0;
+	};
+
+
+	// Trajectory of one method on one system.  It keeps the system and its own copy of the method, so it
+	// can carry on from where it stopped when a longer duration is asked for and stateful methods like the
+	// adaptive integrators continue with the step size they had reached.
+	template<typename System, typename T>
+	struct Trajectory : ITrajectory
+	{
+		typedef std::function<void(ODE::IState<T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>& state, float stepSize)> Method;
+
+		Trajectory(const System& system, const Method& method, float stepSize, bool isDenseOutput)
+			: m_system(system)
+			, m_method(method)
+			, m_stepSize(stepSize)
+			, m_isDenseOutput(isDenseOutput)
+		{
+		}
+
+		// Records the state at the start of every step, as either a position or a dense output node.  With a
+		// sink every derivative is streamed to it instead, so nothing is kept however long the run.
+		void Extend(unsigned int numSteps)
+		{
+			using ODE::GetComponent;
+			using ODE::GetNumComponents;
+
+			std::array<T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> derivatives;
+			std::vector<float> values;
+			for (; m_numSteps < numSteps; ++m_numSteps)
+			{
+				if (m_pSink)
+				{
+					m_system.GetDerivatives(derivatives);
+					values.clear();
+					for (const T& derivative : derivatives)
+						for (unsigned int i = 0; i < GetNumComponents(derivative); ++i)
+							values.push_back(static_cast<float>(GetComponent(derivative, i)));
+					m_pSink->AddSample(m_numSteps * m_stepSize, values.data());
+				}
+				else if (m_isDenseOutput)
+				{
+					m_denseOutput.AddNode(m_numSteps * m_stepSize, m_system);
+				}
+				else
+				{
+					m_system.GetDerivatives(derivatives);
+					m_positions.push_back(derivatives[(int)EStateDerivative::Position]);
+				}
+				m_method(m_system, m_stepSize);
+			}
+		}
+
+		// the sink's columns, in the order Extend streams them
+		void GetColumnNames(std::vector<std::string>& columnNames) const
+		{
+			using ODE::GetNumComponents;
+
+			static const std::array<const char*, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> derivativeNames = { "Position", "Speed" };
+
+			const unsigned int numComponents = GetNumComponents(T());
+			columnNames.clear();
+			for (const char* pDerivativeName : derivativeNames)
+				for (unsigned int i = 0; i < numComponents; ++i)
+					columnNames.push_back((numComponents > 1) ? std::string(pDerivativeName) + "_" + std::to_string(i) : std::string(pDerivativeName));
+		}
+
+		virtual size_t GetMemorySize() const override
+		{
+			constexpr size_t nodeSize = sizeof(float) + 2 * sizeof(std::array<T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>);
+			return sizeof(*this) + m_positions.capacity() * sizeof(T) + m_denseOutput.GetNumNodes() * nodeSize;
+		}
+
+		System m_system;
+		Method m_method;
+		ODE::DenseOutput<T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> m_denseOutput;
+		std::vector<T> m_positions;
+		ITrajectorySink* m_pSink = nullptr;
+		float m_stepSize = 0.0f;
+		unsigned int m_numSteps = 0;
+		bool m_isDenseOutput = false;
+	};
+
+	typedef Trajectory<SingleSpringMassSystem, float> SingleSpringMassTrajectory;
+	typedef Trajectory<CoupledSpringMassSystem, StateData<float, 2>> CoupledSpringMassTrajectory;
+
+
+	// the duration is left out so a longer run extends the trajectory already cached
+	struct TrajectoryKey
+	{
+		unsigned int m_system = 0;
+		unsigned int m_method = 0;
+		float m_springConstant = 0.0f;
+		float m_damping = 0.0f;
+		float m_fps = 0.0f;
+		float m_tolerance = 0.0f;			// zero for methods that don't use it so they stay shared
+		bool m_isDenseOutput = false;
+
+		bool operator < (const TrajectoryKey& rhs) const
+		{
+			return std::tie(m_system, m_method, m_springConstant, m_damping, m_fps, m_tolerance, m_isDenseOutput)
+				< std::tie(rhs.m_system, rhs.m_method, rhs.m_springConstant, rhs.m_damping, rhs.m_fps, rhs.m_tolerance, rhs.m_isDenseOutput);
+		}
+	};
+
+
+	// Least recently used cache of trajectories within a memory budget.  Trajectories grow as they're
+	// extended, so the budget is enforced by Trim after they have been used rather than on insertion.
+	class TrajectoryCache
+	{
+	public:
+		TrajectoryCache(size_t memoryBudget) : m_memoryBudget(memoryBudget) {}
+
+		// returns the trajectory for key as the most recently used, calling create if it isn't cached
+		template<typename TrajectoryType, typename CreateFunc>
+		TrajectoryType& Get(const TrajectoryKey& key, const CreateFunc& create)
+		{
+			const std::map<TrajectoryKey, EntryList::iterator>::iterator lookupIter = m_lookup.find(key);
+			if (lookupIter != m_lookup.end())
+			{
+				m_entries.splice(m_entries.begin(), m_entries, lookupIter->second);
+				return static_cast<TrajectoryType&>(*m_entries.front().m_pTrajectory);
+			}
+
+			m_entries.push_front({ key, create() });
+			m_lookup[key] = m_entries.begin();
+			return static_cast<TrajectoryType&>(*m_entries.front().m_pTrajectory);
+		}
+
+		// evicts from the least recently used end, the most recently used trajectory is always kept
+		void Trim();
+
+		size_t GetNumEntries() const { return m_entries.size(); }
+		size_t GetMemorySize() const;
+
+	private:
+		struct Entry
+		{
+			TrajectoryKey m_key;
+			std::unique_ptr<ITrajectory> m_pTrajectory;
+		};
+		typedef std::list<Entry> EntryList;
+
+		EntryList m_entries;
+		std::map<TrajectoryKey, EntryList::iterator> m_lookup;
+		size_t m_memoryBudget = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "Widgets/Solvers/ODETrajectoryFile.h"
+#include <stddef.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+
+namespace ODESystem
+{
+	namespace
+	{
+		// The header is followed by a record per name, which is the system, the method, the state columns and
+		// then the parameters whose value takes the end of the record.  The whole is padded to a page so the
+		// chunks start aligned, values are in the byte order of the machine that wrote them.
+		struct FileHeader
+		{
+			char m_magic[8];
+			uint32_t m_version;
+			uint32_t m_numColumns;
+			uint32_t m_rowsPerChunk;
+			uint32_t m_numParameters;
+			uint64_t m_headerSize;
+			uint64_t m_numRows;
+		};
+
+		constexpr char fileMagic[8] = "ODETRAJ";
+		constexpr uint32_t fileVersion = 1;
+		constexpr size_t recordSize = 64;
+		constexpr size_t parameterNameSize = recordSize - sizeof(double);
+		constexpr uint64_t headerAlignment = 4096;
+
+
+		uint64_t GetHeaderSize(size_t numRecords)
+		{
+			const uint64_t size = sizeof(FileHeader) + numRecords * recordSize;
+			return (size + headerAlignment - 1) / headerAlignment * headerAlignment;
+		}
+
+
+		void WriteName(char* pRecord, const std::string& name, size_t maxSize)
+		{
+			const size_t size = std::min(name.size(), maxSize - 1);
+			memcpy(pRecord, name.data(), size);
+			pRecord[size] = '\0';
+		}
+
+
+		std::string ReadName(const char* pRecord, size_t maxSize)
+		{
+			return std::string(pRecord, strnlen(pRecord, maxSize));
+		}
+
+
+
+#if defined(_WIN32)
+		// the name is UTF-8, which the ANSI functions would read in the system code page
+		intptr_t OpenFile(const char* pFileName, bool isWrite)
+		{
+			const std::wstring fileName = std::filesystem::u8path(pFileName).wstring();
+			const HANDLE file = CreateFileW(fileName.c_str(), isWrite ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ, nullptr,
+				isWrite ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			return (file == INVALID_HANDLE_VALUE) ? -1 : reinterpret_cast<intptr_t>(file);
+		}
+
+
+		void CloseFile(intptr_t file)
+		{
+			CloseHandle(reinterpret_cast<HANDLE>(file));
+		}
+
+
+		// a file can't be resized while any of it is mapped
+		bool ResizeFile(intptr_t file, uint64_t size)
+		{
+			LARGE_INTEGER position;
+			position.QuadPart = static_cast<LONGLONG>(size);
+			return SetFilePointerEx(reinterpret_cast<HANDLE>(file), position, nullptr, FILE_BEGIN) && SetEndOfFile(reinterpret_cast<HANDLE>(file));
+		}
+
+
+		uint64_t GetFileSize(intptr_t file)
+		{
+			LARGE_INTEGER size;
+			return GetFileSizeEx(reinterpret_cast<HANDLE>(file), &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+		}
+
+
+		uint64_t GetMappingAlignment()
+		{
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return info.dwAllocationGranularity;
+		}
+
+
+		// the view keeps the mapping object alive so its handle is closed straight away
+		void* MapFile(intptr_t file, uint64_t offset, size_t size, bool isWrite)
+		{
+			const HANDLE mapping = CreateFileMappingA(reinterpret_cast<HANDLE>(file), nullptr, isWrite ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+			if (!mapping)
+				return nullptr;
+
+			void* pView = MapViewOfFile(mapping, isWrite ? FILE_MAP_WRITE : FILE_MAP_READ, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset), size);
+			CloseHandle(mapping);
+			return pView;
+		}
+
+
+		void UnmapFile(const void* pMapping, size_t size)
+		{
+			UnmapViewOfFile(pMapping);
+		}
+#else
+		intptr_t OpenFile(const char* pFileName, bool isWrite)
+		{
+			return open(pFileName, isWrite ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY, 0644);
+		}
+
+
+		void CloseFile(intptr_t file)
+		{
+			close(static_cast<int>(file));
+		}
+
+
+		bool ResizeFile(intptr_t file, uint64_t size)
+		{
+			return ftruncate(static_cast<int>(file), static_cast<off_t>(size)) == 0;
+		}
+
+
+		uint64_t GetFileSize(intptr_t file)
+		{
+			struct stat status;
+			return (fstat(static_cast<int>(file), &status) == 0) ? static_cast<uint64_t>(status.st_size) : 0;
+		}
+
+
+		uint64_t GetMappingAlignment()
+		{
+			return static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+		}
+
+
+		void* MapFile(intptr_t file, uint64_t offset, size_t size, bool isWrite)
+		{
+			void* pMapping = mmap(nullptr, size, isWrite ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, static_cast<int>(file), static_cast<off_t>(offset));
+			return (pMapping == MAP_FAILED) ? nullptr : pMapping;
+		}
+
+
+		void UnmapFile(const void* pMapping, size_t size)
+		{
+			munmap(const_cast<void*>(pMapping), size);
+		}
+#endif
+	}
+
+
+
+	MappedTrajectoryWriter::~MappedTrajectoryWriter()
+	{
+		Close();
+	}
+
+
+	bool MappedTrajectoryWriter::Open(const char* pFileName, const TrajectoryFileInfo& info, unsigned int rowsPerChunk)
+	{
+		Close();
+
+		m_file = OpenFile(pFileName, true);
+		if (m_file == invalidFile)
+			return false;
+
+		m_numColumns = 1 + static_cast<unsigned int>(info.m_columnNames.size());
+		m_rowsPerChunk = std::max(1u, rowsPerChunk);
+		m_headerSize = GetHeaderSize(2 + info.m_columnNames.size() + info.m_parameters.size());
+		m_chunkSize = static_cast<uint64_t>(m_numColumns) * m_rowsPerChunk * sizeof(float);
+		m_numRows = 0;
+		m_chunkRow = m_rowsPerChunk;		// the first sample maps the first chunk
+		m_isFailed = false;
+
+		char* pHeader = ResizeFile(m_file, m_headerSize) ? static_cast<char*>(MapFile(m_file, 0, static_cast<size_t>(m_headerSize), true)) : nullptr;
+		if (!pHeader)
+		{
+			CloseFile(m_file);
+			m_file = invalidFile;
+			return false;
+		}
+
+		FileHeader header = {};
+		memcpy(header.m_magic, fileMagic, sizeof(fileMagic));
+		header.m_version = fileVersion;
+		header.m_numColumns = m_numColumns;
+		header.m_rowsPerChunk = m_rowsPerChunk;
+		header.m_numParameters = static_cast<uint32_t>(info.m_parameters.size());
+		header.m_headerSize = m_headerSize;
+		header.m_numRows = 0;
+		memcpy(pHeader, &header, sizeof(header));
+
+		char* pRecord = pHeader + sizeof(FileHeader);
+		WriteName(pRecord, info.m_systemName, recordSize);
+		WriteName(pRecord += recordSize, info.m_methodName, recordSize);
+		for (const std::string& columnName : info.m_columnNames)
+			WriteName(pRecord += recordSize, columnName, recordSize);
+		for (const std::pair<std::string, double>& parameter : info.m_parameters)
+		{
+			WriteName(pRecord += recordSize, parameter.first, parameterNameSize);
+			memcpy(pRecord + parameterNameSize, &parameter.second, sizeof(double));
+		}
+
+		UnmapFile(pHeader, static_cast<size_t>(m_headerSize));
+		return true;
+	}
+
+
+	bool MappedTrajectoryWriter::Close()
+	{
+		if (m_file == invalidFile)
+			return false;
+
+		UnmapChunk();
+
+		// the rows only count once they're all written so a file cut short reads back as empty
+		char* pHeader = static_cast<char*>(MapFile(m_file, 0, static_cast<size_t>(m_headerSize), true));
+		if (pHeader)
+		{
+			memcpy(pHeader + offsetof(FileHeader, m_numRows), &m_numRows, sizeof(m_numRows));
+			UnmapFile(pHeader, static_cast<size_t>(m_headerSize));
+		}
+
+		CloseFile(m_file);
+		m_file = invalidFile;
+		return pHeader && !m_isFailed;
+	}
+
+
+	void MappedTrajectoryWriter::AddSample(float time, const float* values)
+	{
+		if (m_chunkRow == m_rowsPerChunk && !MapChunk(m_numRows / m_rowsPerChunk))
+			return;
+
+		float* pRow = m_pChunk + m_chunkRow;
+		pRow[0] = time;
+		for (unsigned int column = 1; column < m_numColumns; ++column)
+			pRow[column * m_rowsPerChunk] = values[column - 1];
+
+		++m_chunkRow;
+		++m_numRows;
+	}
+
+
+	// the file grows a chunk at a time, the mapping starts at the alignment the system needs below the chunk
+	bool MappedTrajectoryWriter::MapChunk(uint64_t chunkIndex)
+	{
+		UnmapChunk();
+		if (m_file == invalidFile || m_isFailed)
+			return false;
+
+		const uint64_t chunkOffset = m_headerSize + chunkIndex * m_chunkSize;
+		const uint64_t alignment = GetMappingAlignment();
+		const uint64_t mappingOffset = chunkOffset / alignment * alignment;
+		m_mappingSize = static_cast<size_t>(chunkOffset + m_chunkSize - mappingOffset);
+
+		m_pMapping = ResizeFile(m_file, chunkOffset + m_chunkSize) ? MapFile(m_file, mappingOffset, m_mappingSize, true) : nullptr;
+		if (!m_pMapping)
+		{
+			m_isFailed = true;
+			return false;
+		}
+
+		m_pChunk = reinterpret_cast<float*>(static_cast<char*>(m_pMapping) + (chunkOffset - mappingOffset));
+		m_chunkRow = 0;
+		return true;
+	}
+
+
+	void MappedTrajectoryWriter::UnmapChunk()
+	{
+		if (m_pMapping)
+			UnmapFile(m_pMapping, m_mappingSize);
+
+		m_pMapping = nullptr;
+		m_pChunk = nullptr;
+		m_mappingSize = 0;
+	}
+
+
+
+	MappedTrajectoryReader::~MappedTrajectoryReader()
+	{
+		Close();
+	}
+
+
+	bool MappedTrajectoryReader::Open(const char* pFileName)
+	{
+		Close();
+
+		const intptr_t file = OpenFile(pFileName, false);
+		if (file == -1)
+			return false;
+
+		const uint64_t fileSize = GetFileSize(file);
+		const void* pMapping = (fileSize >= sizeof(FileHeader)) ? MapFile(file, 0, static_cast<size_t>(fileSize), false) : nullptr;
+		CloseFile(file);
+		if (!pMapping)
+			return false;
+
+		m_pMapping = pMapping;
+		m_mappingSize = static_cast<size_t>(fileSize);
+
+		FileHeader header;
+		memcpy(&header, pMapping, sizeof(header));
+		const uint64_t numChunks = (header.m_rowsPerChunk > 0) ? (header.m_numRows + header.m_rowsPerChunk - 1) / header.m_rowsPerChunk : 0;
+		const uint64_t chunkSize = static_cast<uint64_t>(header.m_numColumns) * header.m_rowsPerChunk * sizeof(float);
+		const size_t numRecords = 1 + static_cast<size_t>(header.m_numColumns) + header.m_numParameters;
+		const bool isValid = (memcmp(header.m_magic, fileMagic, sizeof(fileMagic)) == 0) && (header.m_version == fileVersion)
+			&& (header.m_numColumns > 0) && (header.m_rowsPerChunk > 0) && (header.m_headerSize == GetHeaderSize(numRecords))
+			&& (header.m_headerSize + numChunks * chunkSize <= fileSize);
+		if (!isValid)
+		{
+			Close();
+			return false;
+		}
+
+		m_numRows = header.m_numRows;
+		m_numColumns = header.m_numColumns;
+		m_rowsPerChunk = header.m_rowsPerChunk;
+		m_pChunks = reinterpret_cast<const float*>(static_cast<const char*>(pMapping) + header.m_headerSize);
+
+		const char* pRecord = static_cast<const char*>(pMapping) + sizeof(FileHeader);
+		m_info.m_systemName = ReadName(pRecord, recordSize);
+		m_info.m_methodName = ReadName(pRecord += recordSize, recordSize);
+		for (unsigned int column = 1; column < m_numColumns; ++column)
+			m_info.m_columnNames.push_back(ReadName(pRecord += recordSize, recordSize));
+		for (uint32_t parameter = 0; parameter < header.m_numParameters; ++parameter)
+		{
+			double value;
+			pRecord += recordSize;
+			memcpy(&value, pRecord + parameterNameSize, sizeof(double));
+			m_info.m_parameters.emplace_back(ReadName(pRecord, parameterNameSize), value);
+		}
+		return true;
+	}
+
+
+	void MappedTrajectoryReader::Close()
+	{
+		if (m_pMapping)
+			UnmapFile(m_pMapping, m_mappingSize);
+
+		m_info = TrajectoryFileInfo();
+		m_pMapping = nullptr;
+		m_mappingSize = 0;
+		m_pChunks = nullptr;
+		m_numRows = 0;
+		m_numColumns = 0;
+		m_rowsPerChunk = 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+
+#include <algorithm>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+namespace ODESystem
+{
+	// Receives the samples of a trajectory as it is integrated, one row of a time and a value per state
+	// column at a time.
+	struct ITrajectorySink
+	{
+		virtual ~ITrajectorySink() {}
+		virtual void AddSample(float time, const float* values) = 0;
+	};
+
+
+	// what a trajectory file records besides its samples, the column names exclude the time
+	struct TrajectoryFileInfo
+	{
+		std::string m_systemName;
+		std::string m_methodName;
+		std::vector<std::string> m_columnNames;
+		std::vector<std::pair<std::string, double>> m_parameters;
+	};
+
+
+	// Streams the samples into a file of fixed size chunks, each holding the time column followed by the
+	// state columns for the same rows, so a column of a chunk is a contiguous array of floats.  Only the
+	// chunk being filled is mapped and the operating system writes the ones already unmapped back in the
+	// background, so the memory used stays the same however long the run.  The number of rows is written
+	// to the header on Close, which the destructor calls.
+	class MappedTrajectoryWriter final : public ITrajectorySink
+	{
+	public:
+		MappedTrajectoryWriter() {}
+		MappedTrajectoryWriter(const MappedTrajectoryWriter&) = delete;
+		MappedTrajectoryWriter& operator = (const MappedTrajectoryWriter&) = delete;
+		virtual ~MappedTrajectoryWriter() override;
+
+		bool Open(const char* pFileName, const TrajectoryFileInfo& info, unsigned int rowsPerChunk = 16384);
+		bool Close();
+		bool IsOpen() const { return m_file != invalidFile; }
+
+		virtual void AddSample(float time, const float* values) override;
+
+		uint64_t GetNumRows() const { return m_numRows; }
+
+	private:
+		bool MapChunk(uint64_t chunkIndex);
+		void UnmapChunk();
+
+		static constexpr intptr_t invalidFile = -1;
+
+		intptr_t m_file = invalidFile;
+		void* m_pMapping = nullptr;
+		size_t m_mappingSize = 0;
+		float* m_pChunk = nullptr;
+		uint64_t m_headerSize = 0;
+		uint64_t m_chunkSize = 0;
+		uint64_t m_numRows = 0;
+		unsigned int m_numColumns = 0;
+		unsigned int m_rowsPerChunk = 0;
+		unsigned int m_chunkRow = 0;
+		bool m_isFailed = false;
+	};
+
+
+	// Maps a whole trajectory file read only, the columns are read straight from the mapping.
+	class MappedTrajectoryReader
+	{
+	public:
+		MappedTrajectoryReader() {}
+		MappedTrajectoryReader(const MappedTrajectoryReader&) = delete;
+		MappedTrajectoryReader& operator = (const MappedTrajectoryReader&) = delete;
+		~MappedTrajectoryReader();
+
+		bool Open(const char* pFileName);
+		void Close();
+		bool IsOpen() const { return m_pMapping != nullptr; }
+
+		const TrajectoryFileInfo& GetInfo() const { return m_info; }
+		uint64_t GetNumRows() const { return m_numRows; }
+		unsigned int GetNumColumns() const { return m_numColumns; }		// including the time
+		unsigned int GetRowsPerChunk() const { return m_rowsPerChunk; }
+		uint64_t GetNumChunks() const { return (m_numRows + m_rowsPerChunk - 1) / m_rowsPerChunk; }
+
+		// column 0 is the time, only the first GetNumChunkRows of the last chunk are valid
+		const float* GetChunkColumn(uint64_t chunkIndex, unsigned int column) const
+		{
+			return m_pChunks + (chunkIndex * m_numColumns + column) * m_rowsPerChunk;
+		}
+
+		unsigned int GetNumChunkRows(uint64_t chunkIndex) const
+		{
+			return static_cast<unsigned int>(std::min<uint64_t>(m_rowsPerChunk, m_numRows - chunkIndex * m_rowsPerChunk));
+		}
+
+		float GetValue(uint64_t row, unsigned int column) const
+		{
+			return GetChunkColumn(row / m_rowsPerChunk, column)[row % m_rowsPerChunk];
+		}
+
+	private:
+		TrajectoryFileInfo m_info;
+		const void* m_pMapping = nullptr;
+		size_t m_mappingSize = 0;
+		const float* m_pChunks = nullptr;
+		uint64_t m_numRows = 0;
+		unsigned int m_numColumns = 0;
+		unsigned int m_rowsPerChunk = 0;
+	};
+}
\ No newline at end of file
@@ -1,116 +1,140 @@
 #include "Widgets/Solvers/ODEWidget.h"
+#include "Widgets/Solvers/ODETrajectoryCache.h"
 #include "Widgets/EncyclopediaWidget.h"
+#include "Functions/VectorMath.h"
 #include <implot.h>
 #include <glm/gtx/color_space.hpp>
 #include <glm/ext.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <type_traits>
 
 
 
 namespace ODESystem
 {
-	void SingleSpringMassSystem::GetDerivatives(FixedSpringDerivatives& derivatives) const 
-	{ 
-		derivatives[(int)EStateDerivative::Position] = m_massPos; 
-		derivatives[(int)EStateDerivative::Speed] = m_massSpeed; 
-	}
-
-
-	float SingleSpringMassSystem::GetNthDerivative(const FixedSpringDerivatives& derivatives) const
-	{ 
-		return -(derivatives[(int)EStateDerivative::Position] * m_springConstant + derivatives[(int)EStateDerivative::Speed] * m_damping); 
-	}
+	// Exp and SinCos run over blocks of samples that stay in the cache between the passes
+	constexpr size_t analyticalBlockSize = 256;
 
 
-	void SingleSpringMassSystem::SetDerivatives(const FixedSpringDerivatives& derivatives)
+	// sin(w * t) / w which tends to t for critically damped systems, as the weights of sin(w * t) and t
+	template<typename S>
+	static std::array<S, 2> GetSinOverFrequencyWeights(S angularFrequency)
 	{
-		m_massPos = derivatives[(int)EStateDerivative::Position];
-		m_massSpeed = derivatives[(int)EStateDerivative::Speed];
+		constexpr S epsilon = S(1.0e-6);
+		return (angularFrequency > epsilon) ? std::array<S, 2>{ S(1) / angularFrequency, S(0) } : std::array<S, 2>{ S(0), S(1) };
 	}
 
 
-	void SingleSpringMassSystem::SolveAnalytical(const std::vector<float>& timeData, std::vector<float>& posData) const
+	template<typename S>
+	void SingleSpringMassSystemT<S>::SolveAnalytical(const std::vector<S>& timeData, std::vector<S>& posData) const
 	{
-		const glm::u32 numAnalyticalSamples = static_cast<glm::u32>(timeData.size());
+		const size_t numAnalyticalSamples = timeData.size();
+		posData.resize(numAnalyticalSamples);
+
+		// the sine term satisfies the zero starting speed
+		const S angularFrequency = std::sqrt(m_springConstant - S(0.25) * m_damping * m_damping);
+		const std::array<S, 2> weights = GetSinOverFrequencyWeights(angularFrequency);
+		const S halfDamping = S(0.5) * m_damping;
+		if constexpr (std::is_same_v<S, float>)
+		{
+			float decays[analyticalBlockSize];
+			float phases[analyticalBlockSize];
+			float sines[analyticalBlockSize];
+			float cosines[analyticalBlockSize];
+
+			for (size_t start = 0; start < numAnalyticalSamples; start += analyticalBlockSize)
+			{
+				const size_t count = std::min(analyticalBlockSize, numAnalyticalSamples - start);
+				const float* times = timeData.data() + start;
+				for (size_t i = 0; i < count; ++i)
+				{
+					decays[i] = -halfDamping * times[i];
+					phases[i] = angularFrequency * times[i];
+				}
 
-		posData.clear();
-		posData.reserve(numAnalyticalSamples);
+				VectorMath::Exp(decays, decays, count);
+				VectorMath::SinCos(phases, sines, cosines, count);
 
-		const float angularFrequency = sqrtf(m_springConstant - 0.25f * m_damping * m_damping);
-		for (glm::u32 i = 0; i < numAnalyticalSamples; ++i)
+				float* positions = posData.data() + start;
+				for (size_t i = 0; i < count; ++i)
+					positions[i] = decays[i] * (cosines[i] + halfDamping * (weights[0] * sines[i] + weights[1] * times[i]));
+			}
+		}
+		else
 		{
-			const float time = timeData[i];
-			const float pos = expf(-0.5f * m_damping * time) * cosf(angularFrequency * time);
-			posData.push_back(pos);
+			for (size_t i = 0; i < numAnalyticalSamples; ++i)
+			{
+				const S time = timeData[i];
+				posData[i] = std::exp(-halfDamping * time) * (std::cos(angularFrequency * time) + halfDamping * (weights[0] * std::sin(angularFrequency * time) + weights[1] * time));
+			}
 		}
 	}
 
 
-	void SingleSpringMassSystem::Reset(float springConstant, float damping) 
+	template<typename S>
+	void SingleSpringMassSystemT<S>::Reset(S springConstant, S damping) 
 	{ 
-		m_massPos = 1.0f; 
-		m_massSpeed = 0.0f; 
+		m_massPos = S(1); 
+		m_massSpeed = S(0); 
 		m_springConstant = springConstant;
 		m_damping = damping;
 	}
 
 
+	template struct SingleSpringMassSystemT<float>;
+	template struct SingleSpringMassSystemT<double>;
 
-	void CoupledSpringMassSystem::GetDerivatives(CoupledSpringDerivatives& derivatives) const
-	{ 
-		derivatives[(int)EStateDerivative::Position].m_data[0] = m_massPos[0];
-		derivatives[(int)EStateDerivative::Position].m_data[1] = m_massPos[1];
-		derivatives[(int)EStateDerivative::Speed].m_data[0] = m_massSpeed[0]; 
-		derivatives[(int)EStateDerivative::Speed].m_data[1] = m_massSpeed[1]; 
-	}
-
-
-	StateData<float, 2> CoupledSpringMassSystem::GetNthDerivative(const CoupledSpringDerivatives& derivatives) const
-	{ 
-		StateData<float, 2> accelerations;
-		accelerations.m_data[0] = -m_springConstant * (2.0f * derivatives[(int)EStateDerivative::Position].m_data[0] - derivatives[(int)EStateDerivative::Position].m_data[1]) 
-			- m_damping * derivatives[(int)EStateDerivative::Speed].m_data[0];
-		accelerations.m_data[1] = -m_springConstant * (2.0f * derivatives[(int)EStateDerivative::Position].m_data[1] - derivatives[(int)EStateDerivative::Position].m_data[0]) 
-			- m_damping * derivatives[(int)EStateDerivative::Speed].m_data[1];
-		return accelerations;
-	}
-
-
-	void CoupledSpringMassSystem::SetDerivatives(const CoupledSpringDerivatives& derivatives)
-	{
-		m_massPos[0] = derivatives[(int)EStateDerivative::Position].m_data[0];
-		m_massPos[1] = derivatives[(int)EStateDerivative::Position].m_data[1];
-		m_massSpeed[0] = derivatives[(int)EStateDerivative::Speed].m_data[0];
-		m_massSpeed[1] = derivatives[(int)EStateDerivative::Speed].m_data[1];
-	}
 
 
 	void CoupledSpringMassSystem::SolveAnalytical(const std::vector<float>& timeData, std::vector<float>& posData0, std::vector<float>& posData1) const
 	{
-		const glm::u32 numAnalyticalSamples = static_cast<glm::u32>(timeData.size());
-
-		posData0.clear();
-		posData1.clear();
-		posData0.reserve(numAnalyticalSamples);
-		posData1.reserve(numAnalyticalSamples);
+		const size_t numAnalyticalSamples = timeData.size();
+		posData0.resize(numAnalyticalSamples);
+		posData1.resize(numAnalyticalSamples);
 
+		// both modes start in phase
 		constexpr float a[2] = { 1.0f, 1.0f };		// amplitude
-		constexpr float p[2] = { 0.0f, 0.0f };		// phase
 		
 		const float w[2] = { 
 			sqrtf(m_springConstant - 0.25f * m_damping * m_damping), 
 			sqrtf(3.0f * m_springConstant - 0.25f * m_damping * m_damping) };
+		const std::array<float, 2> weights[2] = { GetSinOverFrequencyWeights(w[0]), GetSinOverFrequencyWeights(w[1]) };
+		const float halfDamping = 0.5f * m_damping;
+
+		float decays[analyticalBlockSize];
+		float phases[2][analyticalBlockSize];
+		float sines[2][analyticalBlockSize];
+		float cosines[2][analyticalBlockSize];
 
-		for (glm::u32 i = 0; i < numAnalyticalSamples; ++i)
+		for (size_t start = 0; start < numAnalyticalSamples; start += analyticalBlockSize)
 		{
-			const float time = timeData[i];
-			
-			const float q[2] = {
-				a[0] * cosf(w[0] * time + p[0]),
-				a[1] * cosf(w[1] * time + p[1]) };
-
-			const float dampingFactor = expf(-0.5f * m_damping * time);
-			posData0.push_back(dampingFactor * 0.5f * (q[0] + q[1]));
-			posData1.push_back(dampingFactor * 0.5f * (q[0] - q[1]));
+			const size_t count = std::min(analyticalBlockSize, numAnalyticalSamples - start);
+			const float* times = timeData.data() + start;
+			for (size_t i = 0; i < count; ++i)
+			{
+				decays[i] = -halfDamping * times[i];
+				phases[0][i] = w[0] * times[i];
+				phases[1][i] = w[1] * times[i];
+			}
+
+			VectorMath::Exp(decays, decays, count);
+			VectorMath::SinCos(phases[0], sines[0], cosines[0], count);
+			VectorMath::SinCos(phases[1], sines[1], cosines[1], count);
+
+			float* positions0 = posData0.data() + start;
+			float* positions1 = posData1.data() + start;
+			for (size_t i = 0; i < count; ++i)
+			{
+				const float q[2] = {
+					a[0] * (cosines[0][i] + halfDamping * (weights[0][0] * sines[0][i] + weights[0][1] * times[i])),
+					a[1] * (cosines[1][i] + halfDamping * (weights[1][0] * sines[1][i] + weights[1][1] * times[i])) };
+
+				positions0[i] = decays[i] * 0.5f * (q[0] + q[1]);
+				positions1[i] = decays[i] * 0.5f * (q[0] - q[1]);
+			}
 		}
 	}
 
@@ -124,6 +148,107 @@ namespace ODESystem
 		m_springConstant = springConstant;
 		m_damping = damping;
 	}
+
+
+
+	void SingleSpringMassBatch::GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const
+	{
+		const size_t size = GetSize();
+		const float* __restrict positions = derivatives[(int)EStateDerivative::Position];
+		const float* __restrict speeds = derivatives[(int)EStateDerivative::Speed];
+		const float* __restrict springConstants = m_springConstant.data();
+		const float* __restrict dampings = m_damping.data();
+		float* __restrict accelerations = nthDerivatives;
+
+		for (size_t i = 0; i < size; ++i)
+			accelerations[i] = -(positions[i] * springConstants[i] + speeds[i] * dampings[i]);
+	}
+
+
+	void SingleSpringMassBatch::Reset(size_t numSystems, float springConstant, float damping)
+	{
+		Resize(numSystems);
+		m_springConstant.assign(numSystems, springConstant);
+		m_damping.assign(numSystems, damping);
+
+		float* positions = GetDerivatives((int)EStateDerivative::Position);
+		float* speeds = GetDerivatives((int)EStateDerivative::Speed);
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			positions[i] = 1.0f;
+			speeds[i] = 0.0f;
+		}
+	}
+
+
+
+	void CoupledSpringMassBatch::GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const
+	{
+		const size_t numSystems = GetNumSystems();
+		const float* __restrict positions0 = derivatives[(int)EStateDerivative::Position];
+		const float* __restrict positions1 = positions0 + numSystems;
+		const float* __restrict speeds0 = derivatives[(int)EStateDerivative::Speed];
+		const float* __restrict speeds1 = speeds0 + numSystems;
+		const float* __restrict springConstants = m_springConstant.data();
+		const float* __restrict dampings = m_damping.data();
+		float* __restrict accelerations0 = nthDerivatives;
+		float* __restrict accelerations1 = nthDerivatives + numSystems;
+
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			accelerations0[i] = -springConstants[i] * (2.0f * positions0[i] - positions1[i]) - dampings[i] * speeds0[i];
+			accelerations1[i] = -springConstants[i] * (2.0f * positions1[i] - positions0[i]) - dampings[i] * speeds1[i];
+		}
+	}
+
+
+	void CoupledSpringMassBatch::Reset(size_t numSystems, float springConstant, float damping)
+	{
+		Resize(2 * numSystems);
+		m_springConstant.assign(numSystems, springConstant);
+		m_damping.assign(numSystems, damping);
+
+		float* positions = GetDerivatives((int)EStateDerivative::Position);
+		float* speeds = GetDerivatives((int)EStateDerivative::Speed);
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			positions[i] = 1.0f;
+			positions[numSystems + i] = 0.0f;
+			speeds[i] = 0.0f;
+			speeds[numSystems + i] = 0.0f;
+		}
+	}
+
+
+	const char* GetSpringMethodName(ESpringMethod method)
+	{
+		switch (method)
+		{
+		case ESpringMethod::ExplicitEuler: return "Explicit Euler";
+		case ESpringMethod::ExplicitMidpoint: return "Explicit Midpoint";
+		case ESpringMethod::ExplicitRK4: return "Explicit RK4";
+		case ESpringMethod::SemiImplicitEuler: return "Semi-Implicit Euler";
+		case ESpringMethod::VelocityVerlet: return "Velocity Verlet";
+		case ESpringMethod::Ruth4: return "Ruth 4";
+		case ESpringMethod::Kutta3: return "Kutta 3";
+		case ESpringMethod::SSPRK3: return "SSP RK3";
+		case ESpringMethod::ThreeEighthsRK4: return "RK4 3/8 Rule";
+		case ESpringMethod::DormandPrince5: return "Dormand-Prince 5";
+		case ESpringMethod::Nystrom4: return "Runge-Kutta-Nystrom 4";
+		case ESpringMethod::PEFRL4: return "PEFRL 4";
+		case ESpringMethod::BlanesMoan4: return "Blanes-Moan 4";
+		case ESpringMethod::Yoshida6: return "Yoshida 6";
+		case ESpringMethod::Yoshida8: return "Yoshida 8";
+		case ESpringMethod::BogackiShampine32: return "Bogacki-Shampine 3(2)";
+		case ESpringMethod::DormandPrince54: return "Dormand-Prince 5(4)";
+		case ESpringMethod::BackwardEuler: return "Backward Euler";
+		case ESpringMethod::ImplicitMidpoint: return "Implicit Midpoint";
+		case ESpringMethod::Trapezoidal: return "Trapezoidal";
+		case ESpringMethod::BDF4: return "BDF 4";
+		case ESpringMethod::TransitionMatrix: return "Transition Matrix (exact)";
+		default: return "";
+		}
+	}
 }
 
 
@@ -132,39 +257,36 @@ ODEWidget::ODEWidget(std::weak_ptr<MessageBus> pMessageBus)
 	: IWindowWidget(pMessageBus) 
 {
 	// fill out method names
-	m_methodNames[static_cast<int>(EMethod::ExplicitEuler)] = "Explicit Euler";
-	m_methodNames[static_cast<int>(EMethod::ExplicitMidpoint)] = "Explicit Midpoint";
-	m_methodNames[static_cast<int>(EMethod::ExplicitRK4)] = "Explicit RK4";
-	m_methodNames[static_cast<int>(EMethod::SemiImplicitEuler)] = "Semi-Implicit Euler";
-	m_methodNames[static_cast<int>(EMethod::VelocityVerlet)] = "Velocity Verlet";
-	m_methodNames[static_cast<int>(EMethod::Ruth4)] = "Ruth 4";
+	for (int methodIndex = 0; methodIndex < static_cast<int>(EMethod::NUM_METHODS); ++methodIndex)
+		m_methodNames[methodIndex] = ODESystem::GetSpringMethodName(static_cast<EMethod>(methodIndex));
 
 	// fill out system names
 	m_systemNames[static_cast<int>(ESystem::SingleSpringMass)] = "Single Spring Mass";
 	m_systemNames[static_cast<int>(ESystem::CoupledSpringMass)] = "Coupled Spring Mass";
 
-	// fill out spring methods
-	m_singleSpringMassMethods[static_cast<int>(EMethod::ExplicitEuler)] = ODE::ExplicitEuler<float, 2>;
-	m_singleSpringMassMethods[static_cast<int>(EMethod::ExplicitMidpoint)] = ODE::ExplicitMidpoint<float, 2>;
-	m_singleSpringMassMethods[static_cast<int>(EMethod::ExplicitRK4)] = ODE::ExplicitRK4<float, 2>;
-	m_singleSpringMassMethods[static_cast<int>(EMethod::SemiImplicitEuler)] = ODE::SemiImplicitEuler<float, 2>;
-	m_singleSpringMassMethods[static_cast<int>(EMethod::VelocityVerlet)] = ODE::VelocityVerlet<float>;
-	m_singleSpringMassMethods[static_cast<int>(EMethod::Ruth4)] = ODE::Ruth4<float>;
-
-	m_coupledSpringMassMethods[static_cast<int>(EMethod::ExplicitEuler)] = ODE::ExplicitEuler<ODESystem::StateData<float, 2>, 2>;
-	m_coupledSpringMassMethods[static_cast<int>(EMethod::ExplicitMidpoint)] = ODE::ExplicitMidpoint<ODESystem::StateData<float, 2>, 2>;
-	m_coupledSpringMassMethods[static_cast<int>(EMethod::ExplicitRK4)] = ODE::ExplicitRK4<ODESystem::StateData<float, 2>, 2>;
-	m_coupledSpringMassMethods[static_cast<int>(EMethod::SemiImplicitEuler)] = ODE::SemiImplicitEuler<ODESystem::StateData<float, 2>, 2>;
-	m_coupledSpringMassMethods[static_cast<int>(EMethod::VelocityVerlet)] = ODE::VelocityVerlet<ODESystem::StateData<float, 2>>;
-	m_coupledSpringMassMethods[static_cast<int>(EMethod::Ruth4)] = ODE::Ruth4<ODESystem::StateData<float, 2>>;
-
 	// set default renderable methods
-	m_methodRenderMask |= 1 << static_cast<glm::u32>(EMethod::ExplicitEuler);
-	m_methodRenderMask |= 1 << static_cast<glm::u32>(EMethod::ExplicitMidpoint);
-	m_methodRenderMask |= 1 << static_cast<glm::u32>(EMethod::ExplicitRK4);
+	m_settings.m_methodRenderMask |= 1 << static_cast<glm::u32>(EMethod::ExplicitEuler);
+	m_settings.m_methodRenderMask |= 1 << static_cast<glm::u32>(EMethod::ExplicitMidpoint);
+	m_settings.m_methodRenderMask |= 1 << static_cast<glm::u32>(EMethod::ExplicitRK4);
+
+	// generate starting samples up front so the first frame has something to draw, then hand over to the worker
+	constexpr size_t trajectoryCacheBudget = 64 * 1024 * 1024;
+	m_pTrajectoryCache = std::make_unique<ODESystem::TrajectoryCache>(trajectoryCacheBudget);
+	m_pFrontSamples = std::make_unique<SampleData>();
+	GenerateSamples(m_settings, m_requestId, *m_pFrontSamples);
+	m_sampleWorker = std::thread(&ODEWidget::SampleWorkerLoop, this);
+}
 
-	// generate starting samples
-	GenerateSamples();
+
+ODEWidget::~ODEWidget()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sampleMutex);
+		m_isStopping = true;
+		++m_requestId;
+	}
+	m_sampleRequested.notify_one();
+	m_sampleWorker.join();
 }
 
 
@@ -187,6 +309,45 @@ void ODEWidget::RenderContents(float deltaTime)
 		SendMessage("OpenWindow Encyclopedia OrdinaryDifferentialEquations");
 	}
 
+	ImGui::SameLine();
+	if (ImGui::Button("[BENCHMARKS]"))
+	{
+		SendMessage("OpenWindow ODEBenchmarks");
+	}
+
+	// exports straight from the controls, which the cached trajectories may not have caught up with
+	ImGui::SameLine();
+	if (ImGui::Button("[EXPORT]") && !m_isExporting)
+		RequestExport();
+
+	// swap in finished samples and pick up the result of a finished export
+	{
+		std::lock_guard<std::mutex> lock(m_sampleMutex);
+		if (m_isBackSamplesReady)
+		{
+			std::swap(m_pFrontSamples, m_pBackSamples);
+			m_isBackSamplesReady = false;
+		}
+
+		if (m_isExportResultReady)
+		{
+			m_exportMessage.swap(m_exportResult);
+			m_isExportResultReady = false;
+			m_isExporting = false;
+		}
+	}
+
+	if (m_isExporting || !m_exportMessage.empty())
+	{
+		ImGui::SameLine();
+		ImGui::TextUnformatted(m_isExporting ? "Exporting..." : m_exportMessage.c_str());
+	}
+
+	const SampleData& samples = *m_pFrontSamples;
+	ImGui::SameLine();
+	ImGui::Text("%s%zu cached trajectories (%.1f MB)", (samples.m_requestId != m_requestId) ? "Generating... " : "",
+		samples.m_numCachedTrajectories, samples.m_cacheMemorySize / (1024.0 * 1024.0));
+
 	// draw plot
 	const ImVec2 plotSize(960.0f, 480.0f);
 	ImPlot::SetNextAxisLimits(ImAxis_Y1, -3.0f, 3.0f);
@@ -195,51 +356,51 @@ void ODEWidget::RenderContents(float deltaTime)
 	{
 		// setup legend and axes
 		ImPlot::SetupLegend(ImPlotLocation_South, ImPlotLegendFlags_Outside);
-		const int numMethodSamples = static_cast<int>(m_methodTimeData.size());
+		const int numMethodSamples = static_cast<int>(samples.m_methodTimeData.size());
 		constexpr int numMethods = static_cast<int>(EMethod::NUM_METHODS);
 
-		if (m_system == ESystem::SingleSpringMass)
+		if (samples.m_settings.m_system == ESystem::SingleSpringMass)
 		{
 			// draw analytical data
-			const int numAnalyticalSamples = static_cast<int>(m_analyticalTimeData.size());
+			const int numAnalyticalSamples = static_cast<int>(samples.m_analyticalTimeData.size());
 			const glm::vec3 analyticalColour = glm::rgbColor(glm::vec3(0.0f, 0.0f, 0.5f));
 			ImPlot::SetNextLineStyle(ImVec4(analyticalColour.r, analyticalColour.g, analyticalColour.b, 1.0f));
-			ImPlot::PlotLine("Analytical", m_analyticalTimeData.data(), m_analyticalSingleSpringMassData.data(), numAnalyticalSamples);
+			ImPlot::PlotLine("Analytical", samples.m_analyticalTimeData.data(), samples.m_analyticalSingleSpringMassData.data(), numAnalyticalSamples);
 
 			// draw method data
 			for (int methodIndex = 0; methodIndex < numMethods; ++methodIndex)
 			{
-				if (m_methodRenderMask & (1 << methodIndex))
+				if (samples.m_settings.m_methodRenderMask & (1 << methodIndex))
 				{
 					const glm::vec3 methodColour = glm::rgbColor(glm::vec3(360.0f * methodIndex / (float)numMethods, 0.8f, 0.8f));
 					ImPlot::SetNextLineStyle(ImVec4(methodColour.r, methodColour.g, methodColour.b, 1.0f));
-					ImPlot::PlotLine(m_methodNames[methodIndex], m_methodTimeData.data(), m_singleSpringMassData[methodIndex].data(), numMethodSamples);
+					ImPlot::PlotLine(m_methodNames[methodIndex], samples.m_methodTimeData.data(), samples.m_singleSpringMassData[methodIndex].data(), numMethodSamples);
 				}
 			}
 		}
-		else if (m_system == ESystem::CoupledSpringMass)
+		else if (samples.m_settings.m_system == ESystem::CoupledSpringMass)
 		{
 			// draw analytical data
-			const int numAnalyticalSamples = static_cast<int>(m_analyticalTimeData.size());
+			const int numAnalyticalSamples = static_cast<int>(samples.m_analyticalTimeData.size());
 			const glm::vec3 analyticalColour = glm::rgbColor(glm::vec3(0.0f, 0.0f, 0.5f));
 			ImPlot::SetNextLineStyle(ImVec4(analyticalColour.r, analyticalColour.g, analyticalColour.b, 1.0f));
-			ImPlot::PlotLine("Analytical_0", m_analyticalTimeData.data(), m_analyticalCoupledSpringMassData[0].data(), numAnalyticalSamples);
+			ImPlot::PlotLine("Analytical_0", samples.m_analyticalTimeData.data(), samples.m_analyticalCoupledSpringMassData[0].data(), numAnalyticalSamples);
 			ImPlot::SetNextLineStyle(ImVec4(analyticalColour.r, analyticalColour.g, analyticalColour.b, 1.0f));
-			ImPlot::PlotLine("Analytical_1", m_analyticalTimeData.data(), m_analyticalCoupledSpringMassData[1].data(), numAnalyticalSamples);
+			ImPlot::PlotLine("Analytical_1", samples.m_analyticalTimeData.data(), samples.m_analyticalCoupledSpringMassData[1].data(), numAnalyticalSamples);
 
 			// draw method data
 			for (int methodIndex = 0; methodIndex < numMethods; ++methodIndex)
 			{
-				if (m_methodRenderMask & (1 << methodIndex))
+				if (samples.m_settings.m_methodRenderMask & (1 << methodIndex))
 				{
 					const std::string name0 = std::string(m_methodNames[methodIndex]) + "_0";
 					const std::string name1 = std::string(m_methodNames[methodIndex]) + "_1";
 
 					const glm::vec3 methodColour = glm::rgbColor(glm::vec3(360.0f * methodIndex / (float)numMethods, 0.8f, 0.8f));
 					ImPlot::SetNextLineStyle(ImVec4(methodColour.r, methodColour.g, methodColour.b, 1.0f));
-					ImPlot::PlotLine(name0.c_str(), m_methodTimeData.data(), m_coupledSpringMassData[methodIndex][0].data(), numMethodSamples);
+					ImPlot::PlotLine(name0.c_str(), samples.m_methodTimeData.data(), samples.m_coupledSpringMassData[methodIndex][0].data(), numMethodSamples);
 					ImPlot::SetNextLineStyle(ImVec4(methodColour.r, methodColour.g, methodColour.b, 1.0f));
-					ImPlot::PlotLine(name1.c_str(), m_methodTimeData.data(), m_coupledSpringMassData[methodIndex][1].data(), numMethodSamples);
+					ImPlot::PlotLine(name1.c_str(), samples.m_methodTimeData.data(), samples.m_coupledSpringMassData[methodIndex][1].data(), numMethodSamples);
 				}
 			}
 		}
@@ -251,97 +412,335 @@ void ODEWidget::RenderContents(float deltaTime)
 	// create controls
 	bool isDirty = false;
             
-	int systemIndex = static_cast<int>(m_system);
-	ImGui::Combo("System", &systemIndex, &m_systemNames[0], static_cast<int>(ESystem::NUM_SYSTEMS));
-	m_system = static_cast<ESystem>(systemIndex);
+	int systemIndex = static_cast<int>(m_settings.m_system);
+	isDirty |= ImGui::Combo("System", &systemIndex, &m_systemNames[0], static_cast<int>(ESystem::NUM_SYSTEMS));
+	m_settings.m_system = static_cast<ESystem>(systemIndex);
 
-	isDirty |= ImGui::SliderFloat("Duration", &m_duration, 0.1f, 120.0f);
-	isDirty |= ImGui::SliderFloat("FPS", &m_fps, 1.0f, 240.0f);
-	isDirty |= ImGui::SliderFloat("Spring Constant", &m_springConstant, 1.0f, 1000.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
-	isDirty |= ImGui::SliderFloat("Damping", &m_damping, 0.0f, 2.0f);
+	isDirty |= ImGui::SliderFloat("Duration", &m_settings.m_duration, 0.1f, 120.0f);
+	isDirty |= ImGui::SliderFloat("FPS", &m_settings.m_fps, 1.0f, 240.0f);
+	isDirty |= ImGui::SliderFloat("Spring Constant", &m_settings.m_springConstant, 1.0f, 1000.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
+	isDirty |= ImGui::SliderFloat("Damping", &m_settings.m_damping, 0.0f, 2.0f);
+	isDirty |= ImGui::SliderFloat("Adaptive Tolerance", &m_settings.m_tolerance, 1.0e-8f, 1.0e-1f, "%.1e", ImGuiSliderFlags_Logarithmic);
+	isDirty |= ImGui::Checkbox("Dense Output", &m_settings.m_isDenseOutput);
 
 	ImGui::Separator();
 
 	for (int methodIndex = 0; methodIndex < static_cast<int>(EMethod::NUM_METHODS); ++methodIndex)
 	{
 		const glm::u32 methodBit = (1 << methodIndex);
-		bool renderMethod = (m_methodRenderMask & methodBit) != 0;
-		ImGui::Checkbox(m_methodNames[methodIndex], &renderMethod);
-		if (renderMethod) { m_methodRenderMask |= methodBit; }
-		else { m_methodRenderMask &= ~methodBit; }
+		bool renderMethod = (m_settings.m_methodRenderMask & methodBit) != 0;
+		isDirty |= ImGui::Checkbox(m_methodNames[methodIndex], &renderMethod);
+		if (renderMethod) { m_settings.m_methodRenderMask |= methodBit; }
+		else { m_settings.m_methodRenderMask &= ~methodBit; }
 	}
 
 	// generate samples if needed
 	if (isDirty)
-		GenerateSamples();
+		RequestSamples();
+}
+
+
+void ODEWidget::RequestSamples()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sampleMutex);
+		m_requestedSettings = m_settings;
+		m_hasRequest = true;
+		++m_requestId;
+	}
+	m_sampleRequested.notify_one();
+}
+
+
+void ODEWidget::RequestExport()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sampleMutex);
+		m_exportSettings = m_settings;
+		m_hasExportRequest = true;
+	}
+	m_isExporting = true;
+	m_sampleRequested.notify_one();
+}
+
+
+void ODEWidget::SampleWorkerLoop()
+{
+	constexpr const char* pExportDirectory = "Trajectories";
+
+	std::unique_ptr<SampleData> pSamples = std::make_unique<SampleData>();
+	while (true)
+	{
+		SampleSettings settings;
+		SampleSettings exportSettings;
+		glm::u32 requestId = 0;
+		bool hasRequest = false;
+		bool hasExportRequest = false;
+		{
+			std::unique_lock<std::mutex> lock(m_sampleMutex);
+			m_sampleRequested.wait(lock, [this]() { return m_hasRequest || m_hasExportRequest || m_isStopping; });
+			if (m_isStopping)
+				return;
+
+			settings = m_requestedSettings;
+			requestId = m_requestId;
+			hasRequest = m_hasRequest;
+			m_hasRequest = false;
+
+			exportSettings = m_exportSettings;
+			hasExportRequest = m_hasExportRequest;
+			m_hasExportRequest = false;
+		}
+
+		// an export regenerates every trajectory it writes rather than sharing the cache with the samples
+		if (hasExportRequest)
+		{
+			const unsigned int numExported = ExportTrajectories(exportSettings, pExportDirectory);
+			std::lock_guard<std::mutex> lock(m_sampleMutex);
+			m_exportResult = "Exported " + std::to_string(numExported) + " trajectories to " + pExportDirectory;
+			m_isExportResultReady = true;
+		}
+
+		if (!hasRequest || !GenerateSamples(settings, requestId, *pSamples))
+			continue;
+
+		// a ready buffer that hasn't been swapped in yet is older than this one so it gets recycled
+		std::lock_guard<std::mutex> lock(m_sampleMutex);
+		if (!IsRequestCancelled(requestId))
+		{
+			if (!m_pBackSamples)
+				m_pBackSamples = std::make_unique<SampleData>();
+			std::swap(m_pBackSamples, pSamples);
+			m_isBackSamplesReady = true;
+		}
+	}
 }
 
 
-void ODEWidget::GenerateSamples()
+bool ODEWidget::GenerateSamples(const SampleSettings& settings, glm::u32 requestId, SampleData& samples)
 {
-	// generate analytical samples
+	samples.m_settings = settings;
+
+	// generate analytical samples for the active system
 	constexpr float analyticalDeltaTime = 1.0f / 120.0f;
-	const glm::u32 numAnalyticalSamples = 1 + static_cast<glm::u32>(ceilf(m_duration / analyticalDeltaTime));
+	const glm::u32 numAnalyticalSamples = 1 + static_cast<glm::u32>(ceilf(settings.m_duration / analyticalDeltaTime));
 
-	m_analyticalTimeData.clear();
-	m_analyticalTimeData.reserve(numAnalyticalSamples);
+	samples.m_analyticalTimeData.clear();
+	samples.m_analyticalTimeData.reserve(numAnalyticalSamples);
 	for (glm::u32 i = 0; i < numAnalyticalSamples; ++i)
-		m_analyticalTimeData.push_back(i * analyticalDeltaTime);
-
-	ODESystem::SingleSpringMassSystem singleSpringMassSystem;
-	singleSpringMassSystem.Reset(m_springConstant, m_damping);
-	singleSpringMassSystem.SolveAnalytical(m_analyticalTimeData, m_analyticalSingleSpringMassData);
+		samples.m_analyticalTimeData.push_back(i * analyticalDeltaTime);
 
-	ODESystem::CoupledSpringMassSystem coupledSpringMassSystem;
-	coupledSpringMassSystem.Reset(m_springConstant, m_damping);
-	coupledSpringMassSystem.SolveAnalytical(m_analyticalTimeData, m_analyticalCoupledSpringMassData[0], m_analyticalCoupledSpringMassData[1]);
+	samples.m_analyticalSingleSpringMassData.clear();
+	samples.m_analyticalCoupledSpringMassData[0].clear();
+	samples.m_analyticalCoupledSpringMassData[1].clear();
+	if (settings.m_system == ESystem::SingleSpringMass)
+	{
+		ODESystem::SingleSpringMassSystem singleSpringMassSystem;
+		singleSpringMassSystem.Reset(settings.m_springConstant, settings.m_damping);
+		singleSpringMassSystem.SolveAnalytical(samples.m_analyticalTimeData, samples.m_analyticalSingleSpringMassData);
+	}
+	else if (settings.m_system == ESystem::CoupledSpringMass)
+	{
+		ODESystem::CoupledSpringMassSystem coupledSpringMassSystem;
+		coupledSpringMassSystem.Reset(settings.m_springConstant, settings.m_damping);
+		coupledSpringMassSystem.SolveAnalytical(samples.m_analyticalTimeData, samples.m_analyticalCoupledSpringMassData[0], samples.m_analyticalCoupledSpringMassData[1]);
+	}
 
-	// generate method data
-	const float methodDeltaTime = 1.0f / m_fps;
-	const glm::u32 numMethodSamples = 1 + static_cast<glm::u32>(ceilf(m_duration / methodDeltaTime));
+	// generate method data, with dense output the methods still step once per frame but are plotted
+	// at the analytical sample times by interpolating between frames
+	const float methodDeltaTime = 1.0f / settings.m_fps;
+	const glm::u32 numMethodSteps = 1 + static_cast<glm::u32>(ceilf(settings.m_duration / methodDeltaTime));
+	const glm::u32 numMethodSamples = settings.m_isDenseOutput ? numAnalyticalSamples : numMethodSteps;
 
-	m_methodTimeData.clear();
-	m_methodTimeData.reserve(numMethodSamples);
+	samples.m_methodTimeData.clear();
+	samples.m_methodTimeData.reserve(numMethodSamples);
 
 	for (glm::u32 i = 0; i < numMethodSamples; ++i)
 	{
-		const float time = i * methodDeltaTime;
-		m_methodTimeData.push_back(time);
+		const float time = settings.m_isDenseOutput ? samples.m_analyticalTimeData[i] : i * methodDeltaTime;
+		samples.m_methodTimeData.push_back(time);
 	}
 
+	// Only visible methods are generated, each from a cached trajectory which is extended when the duration
+	// grows.  The trajectories own their copy of the method so the adaptive methods are built with the
+	// requested tolerance.
 	for (int methodIndex = 0; methodIndex < static_cast<int>(EMethod::NUM_METHODS); ++methodIndex)
 	{
-		singleSpringMassSystem.Reset(m_springConstant, m_damping);
-
-		std::vector<float>& data = m_singleSpringMassData[methodIndex];
-		data.clear();
-		data.reserve(numMethodSamples);
+		std::vector<float>& singleData = samples.m_singleSpringMassData[methodIndex];
+		std::vector<float>& coupledData0 = samples.m_coupledSpringMassData[methodIndex][0];
+		std::vector<float>& coupledData1 = samples.m_coupledSpringMassData[methodIndex][1];
+		singleData.clear();
+		coupledData0.clear();
+		coupledData1.clear();
+
+		if ((settings.m_methodRenderMask & (1 << methodIndex)) == 0)
+			continue;
+
+		// a newer request cancels this one, which is checked between methods
+		if (IsRequestCancelled(requestId))
+			return false;
+
+		const EMethod method = static_cast<EMethod>(methodIndex);
+		const bool isAdaptive = ODESystem::IsAdaptiveSpringMethod(method);
+
+		ODESystem::TrajectoryKey key;
+		key.m_system = static_cast<unsigned int>(settings.m_system);
+		key.m_method = static_cast<unsigned int>(methodIndex);
+		key.m_springConstant = settings.m_springConstant;
+		key.m_damping = settings.m_damping;
+		key.m_fps = settings.m_fps;
+		key.m_tolerance = isAdaptive ? settings.m_tolerance : 0.0f;
+		key.m_isDenseOutput = settings.m_isDenseOutput;
+
+		if (settings.m_system == ESystem::SingleSpringMass)
+		{
+			ODESystem::SingleSpringMassTrajectory& trajectory = m_pTrajectoryCache->Get<ODESystem::SingleSpringMassTrajectory>(key, [&]()
+			{
+				return CreateSingleSpringMassTrajectory(settings, method);
+			});
+			trajectory.Extend(numMethodSteps);
 
-		const ODESystem::FixedSpringMethod springMethod = m_singleSpringMassMethods[methodIndex];
-		for (glm::u32 i = 0; i < numMethodSamples; ++i)
+			singleData.reserve(numMethodSamples);
+			if (settings.m_isDenseOutput)
+			{
+				size_t hint = 0;
+				ODESystem::FixedSpringDerivatives derivatives;
+				for (float time : samples.m_methodTimeData)
+				{
+					trajectory.m_denseOutput.Evaluate(time, derivatives, hint);
+					singleData.push_back(derivatives[(int)ODESystem::EStateDerivative::Position]);
+				}
+			}
+			else
+			{
+				singleData.assign(trajectory.m_positions.begin(), trajectory.m_positions.begin() + numMethodSamples);
+			}
+		}
+		else if (settings.m_system == ESystem::CoupledSpringMass)
 		{
-			data.push_back(singleSpringMassSystem.m_massPos);
-			springMethod(singleSpringMassSystem, methodDeltaTime);
+			ODESystem::CoupledSpringMassTrajectory& trajectory = m_pTrajectoryCache->Get<ODESystem::CoupledSpringMassTrajectory>(key, [&]()
+			{
+				return CreateCoupledSpringMassTrajectory(settings, method);
+			});
+			trajectory.Extend(numMethodSteps);
+
+			coupledData0.reserve(numMethodSamples);
+			coupledData1.reserve(numMethodSamples);
+			if (settings.m_isDenseOutput)
+			{
+				size_t hint = 0;
+				ODESystem::CoupledSpringDerivatives derivatives;
+				for (float time : samples.m_methodTimeData)
+				{
+					trajectory.m_denseOutput.Evaluate(time, derivatives, hint);
+					coupledData0.push_back(derivatives[(int)ODESystem::EStateDerivative::Position].m_data[0]);
+					coupledData1.push_back(derivatives[(int)ODESystem::EStateDerivative::Position].m_data[1]);
+				}
+			}
+			else
+			{
+				for (glm::u32 i = 0; i < numMethodSamples; ++i)
+				{
+					coupledData0.push_back(trajectory.m_positions[i].m_data[0]);
+					coupledData1.push_back(trajectory.m_positions[i].m_data[1]);
+				}
+			}
 		}
 	}
 
+	m_pTrajectoryCache->Trim();
+	samples.m_numCachedTrajectories = m_pTrajectoryCache->GetNumEntries();
+	samples.m_cacheMemorySize = m_pTrajectoryCache->GetMemorySize();
+	samples.m_requestId = requestId;
+	return true;
+}
+
+
+std::unique_ptr<ODESystem::SingleSpringMassTrajectory> ODEWidget::CreateSingleSpringMassTrajectory(const SampleSettings& settings, EMethod method) const
+{
+	ODE::AdaptiveSettings adaptiveSettings;
+	adaptiveSettings.m_absTolerance = settings.m_tolerance;
+	adaptiveSettings.m_relTolerance = settings.m_tolerance;
+
+	ODESystem::SingleSpringMassSystem system;
+	system.Reset(settings.m_springConstant, settings.m_damping);
+
+	const ODESystem::FixedSpringMethod springMethod = ODESystem::MakeSpringMethod<float>(method, adaptiveSettings);
+
+	return std::make_unique<ODESystem::SingleSpringMassTrajectory>(system, springMethod, 1.0f / settings.m_fps, settings.m_isDenseOutput);
+}
+
+
+std::unique_ptr<ODESystem::CoupledSpringMassTrajectory> ODEWidget::CreateCoupledSpringMassTrajectory(const SampleSettings& settings, EMethod method) const
+{
+	ODE::AdaptiveSettings adaptiveSettings;
+	adaptiveSettings.m_absTolerance = settings.m_tolerance;
+	adaptiveSettings.m_relTolerance = settings.m_tolerance;
+
+	ODESystem::CoupledSpringMassSystem system;
+	system.Reset(settings.m_springConstant, settings.m_damping);
+
+	const ODESystem::FreeSpringMethod springMethod = ODESystem::MakeSpringMethod<ODESystem::StateData<float, 2>>(method, adaptiveSettings);
+
+	return std::make_unique<ODESystem::CoupledSpringMassTrajectory>(system, springMethod, 1.0f / settings.m_fps, settings.m_isDenseOutput);
+}
+
+
+unsigned int ODEWidget::ExportTrajectories(const SampleSettings& settings, const char* pDirectory) const
+{
+	std::error_code error;
+	std::filesystem::create_directories(pDirectory, error);
+
+	const float methodDeltaTime = 1.0f / settings.m_fps;
+	const glm::u32 numMethodSteps = 1 + static_cast<glm::u32>(ceilf(settings.m_duration / methodDeltaTime));
+
+	unsigned int numExported = 0;
 	for (int methodIndex = 0; methodIndex < static_cast<int>(EMethod::NUM_METHODS); ++methodIndex)
 	{
-		coupledSpringMassSystem.Reset(m_springConstant, m_damping);
-
-		std::vector<float>& data0 = m_coupledSpringMassData[methodIndex][0];
-		std::vector<float>& data1 = m_coupledSpringMassData[methodIndex][1];
-		data0.clear();
-		data0.reserve(numMethodSamples);
-		data1.clear();
-		data1.reserve(numMethodSamples);
+		if ((settings.m_methodRenderMask & (1 << methodIndex)) == 0)
+			continue;
+
+		const EMethod method = static_cast<EMethod>(methodIndex);
+		const bool isAdaptive = ODESystem::IsAdaptiveSpringMethod(method);
+
+		ODESystem::TrajectoryFileInfo info;
+		info.m_systemName = m_systemNames[static_cast<int>(settings.m_system)];
+		info.m_methodName = m_methodNames[methodIndex];
+		info.m_parameters = {
+			{ "SpringConstant", settings.m_springConstant },
+			{ "Damping", settings.m_damping },
+			{ "StepSize", methodDeltaTime },
+			{ "Tolerance", isAdaptive ? settings.m_tolerance : 0.0f } };
+
+		// the names are made safe for any file system
+		std::string fileName = info.m_systemName + " - " + info.m_methodName;
+		std::replace_if(fileName.begin(), fileName.end(), [](char c) { return !isalnum(static_cast<unsigned char>(c)) && c != ' ' && c != '-'; }, '_');
+		const std::string path = (std::filesystem::u8path(pDirectory) / std::filesystem::u8path(fileName + ".odet")).u8string();
+
+		ODESystem::MappedTrajectoryWriter writer;
+		if (settings.m_system == ESystem::SingleSpringMass)
+		{
+			std::unique_ptr<ODESystem::SingleSpringMassTrajectory> pTrajectory = CreateSingleSpringMassTrajectory(settings, method);
+			pTrajectory->GetColumnNames(info.m_columnNames);
+			if (!writer.Open(path.c_str(), info))
+				continue;
 
-		const ODESystem::FreeSpringMethod springMethod = m_coupledSpringMassMethods[methodIndex];
-		for (glm::u32 i = 0; i < numMethodSamples; ++i)
+			pTrajectory->m_pSink = &writer;
+			pTrajectory->Extend(numMethodSteps);
+		}
+		else if (settings.m_system == ESystem::CoupledSpringMass)
 		{
-			data0.push_back(coupledSpringMassSystem.m_massPos[0]);
-			data1.push_back(coupledSpringMassSystem.m_massPos[1]);
-			springMethod(coupledSpringMassSystem, methodDeltaTime);
+			std::unique_ptr<ODESystem::CoupledSpringMassTrajectory> pTrajectory = CreateCoupledSpringMassTrajectory(settings, method);
+			pTrajectory->GetColumnNames(info.m_columnNames);
+			if (!writer.Open(path.c_str(), info))
+				continue;
+
+			pTrajectory->m_pSink = &writer;
+			pTrajectory->Extend(numMethodSteps);
 		}
+
+		if (writer.Close())
+			++numExported;
 	}
+	return numExported;
 }
\ No newline at end of file
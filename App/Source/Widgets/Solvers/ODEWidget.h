@@ -1,10 +1,31 @@
 #pragma once
 
 
+#include "Functions/Dual.h"
 #include "Solvers/ODE.h"
+#include "Solvers/ODEAdaptive.h"
+#include "Solvers/ODEBatch.h"
+#include "Solvers/ODEDenseOutput.h"
+#include "Solvers/ODEEvents.h"
+#include "Solvers/ODEExpression.h"
+#include "Solvers/ODEImplicit.h"
+#include "Solvers/ODELinear.h"
+#include "Solvers/ODEMixedPrecision.h"
+#include "Solvers/ODERungeKutta.h"
+#include "Solvers/ODESymplectic.h"
 #include "Widgets/WindowWidget.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 
 
@@ -19,71 +40,425 @@ namespace ODESystem
 	};
 
 
+	// Fixed size state whose arithmetic is lazy, see ODEExpression.h, so the combinations of stages in the
+	// methods are evaluated in one pass whatever the number of components.
 	template<typename T, unsigned int N>
-	struct StateData
+	struct StateData : ODE::Expression<StateData<T, N>>
 	{
-		std::array<T, N> m_data = {};
+		typedef T Scalar;
+		static constexpr unsigned int size = N;
+		static constexpr bool isLeaf = true;
 
-		StateData<T, N> operator * (float rhs) const
+		std::array<T, N> m_data;
+
+		StateData()
+			: m_data{}
+		{
+		}
+
+		// m_data isn't zeroed first so converting from an expression is a single pass over the components
+		template<typename E>
+		StateData(const ODE::Expression<E>& expression)
 		{
-			StateData<T, N> result;
+			static_assert(E::size == N);
+			const E& source = expression.Derived();
 			for (unsigned int i = 0; i < N; ++i)
+				m_data[i] = source[i];
+		}
+
+		// the expression may read from this state, and evaluating into a local first lets the compiler keep
+		// small states in registers as it can see nothing is written until the end
+		template<typename E>
+		StateData<T, N>& operator = (const ODE::Expression<E>& expression)
+		{
+			static_assert(E::size == N);
+			const E& source = expression.Derived();
+			std::array<T, N> values;
+			for (unsigned int i = 0; i < N; ++i)
+				values[i] = source[i];
+			m_data = values;
+			return *this;
+		}
+
+		template<typename E>
+		StateData<T, N>& operator += (const ODE::Expression<E>& expression)
+		{
+			static_assert(E::size == N);
+			const E& source = expression.Derived();
+			std::array<T, N> values;
+			for (unsigned int i = 0; i < N; ++i)
+				values[i] = m_data[i] + source[i];
+			m_data = values;
+			return *this;
+		}
+
+		T operator [] (unsigned int index) const
+		{
+			return m_data[index];
+		}
+	};
+
+
+	template<typename T, unsigned int N>
+	unsigned int GetNumComponents(const StateData<T, N>& value)
+	{
+		return N;
+	}
+
+
+	template<typename T, unsigned int N>
+	T GetComponent(const StateData<T, N>& value, unsigned int index)
+	{
+		return value.m_data[index];
+	}
+
+
+	template<typename T, unsigned int N>
+	void SetComponent(StateData<T, N>& value, unsigned int index, T component)
+	{
+		value.m_data[index] = component;
+	}
+
+
+	template<typename T, unsigned int N>
+	float ScaledErrorSquared(const StateData<T, N>& error, const StateData<T, N>& value0, const StateData<T, N>& value1, float absTolerance, float relTolerance, unsigned int& numComponents)
+	{
+		float errorSquared = 0.0f;
+		for (unsigned int i = 0; i < N; ++i)
+			errorSquared += ODE::ScaledErrorSquared(error.m_data[i], value0.m_data[i], value1.m_data[i], absTolerance, relTolerance, numComponents);
+		return errorSquared;
+	}
+
+
+	// Runtime sized counterpart of StateData for systems too large to fix at compile time.  The operators
+	// on temporaries reuse their storage so chained expressions in the methods don't allocate at every step.
+	template<typename T>
+	struct DynamicStateData
+	{
+		std::vector<T> m_data;
+
+		DynamicStateData<T> operator * (T rhs) const &
+		{
+			DynamicStateData<T> result;
+			result.m_data.resize(m_data.size());
+			for (size_t i = 0; i < m_data.size(); ++i)
 				result.m_data[i] = m_data[i] * rhs;
 			return result;
 		}
 
-		StateData<T, N> operator + (const StateData<T, N>& rhs) const
+		DynamicStateData<T> operator * (T rhs) &&
 		{
-			StateData<T, N> result;
-			for (unsigned int i = 0; i < N; ++i)
+			for (T& value : m_data)
+				value *= rhs;
+			return std::move(*this);
+		}
+
+		DynamicStateData<T> operator + (const DynamicStateData<T>& rhs) const &
+		{
+			DynamicStateData<T> result;
+			result.m_data.resize(m_data.size());
+			for (size_t i = 0; i < m_data.size(); ++i)
 				result.m_data[i] = m_data[i] + rhs.m_data[i];
 			return result;
 		}
 
-		StateData<T, N>& operator += (const StateData<T, N>& rhs)
+		DynamicStateData<T> operator + (const DynamicStateData<T>& rhs) &&
 		{
-			for (unsigned int i = 0; i < N; ++i)
+			*this += rhs;
+			return std::move(*this);
+		}
+
+		DynamicStateData<T>& operator += (const DynamicStateData<T>& rhs)
+		{
+			for (size_t i = 0; i < m_data.size(); ++i)
 				m_data[i] += rhs.m_data[i];
 			return *this;
 		}
 	};
 
 
+	template<typename T>
+	unsigned int GetNumComponents(const DynamicStateData<T>& value)
+	{
+		return static_cast<unsigned int>(value.m_data.size());
+	}
+
+
+	template<typename T>
+	T GetComponent(const DynamicStateData<T>& value, unsigned int index)
+	{
+		return value.m_data[index];
+	}
+
+
+	template<typename T>
+	void SetComponent(DynamicStateData<T>& value, unsigned int index, T component)
+	{
+		value.m_data[index] = component;
+	}
+
+
+	template<typename T>
+	float ScaledErrorSquared(const DynamicStateData<T>& error, const DynamicStateData<T>& value0, const DynamicStateData<T>& value1, float absTolerance, float relTolerance, unsigned int& numComponents)
+	{
+		float errorSquared = 0.0f;
+		for (size_t i = 0; i < error.m_data.size(); ++i)
+			errorSquared += ODE::ScaledErrorSquared(error.m_data[i], value0.m_data[i], value1.m_data[i], absTolerance, relTolerance, numComponents);
+		return errorSquared;
+	}
+
+
+	template<typename Tableau, typename T>
+	auto MakeAdaptiveMethod(const ODE::AdaptiveSettings& settings)
+	{
+		// each copy of the method owns its own integrator so every run starts from a fresh step size
+		return [integrator = ODE::AdaptiveRungeKutta<Tableau, T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>(settings)]
+			(ODE::IState<T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>& state, float stepSize) mutable
+		{
+			integrator.Integrate(state, stepSize);
+		};
+	}
+
+
+	// for any integrator that keeps state between calls to Step, the implicit methods and the transition matrix
+	template<typename Integrator, typename T>
+	auto MakeStatefulMethod()
+	{
+		return [integrator = Integrator()](ODE::IState<T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>& state, float stepSize) mutable
+		{
+			integrator.Step(state, stepSize);
+		};
+	}
+
+
 	typedef std::function<void(ODE::IState<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>& state, float stepSize)> FixedSpringMethod;
 	typedef std::function<void(ODE::IState<StateData<float, 2>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>& state, float stepSize)> FreeSpringMethod;
 
+
+	// Every method the ODE widget offers, which the convergence suite runs as well so the two can't drift
+	// apart.  The adaptive methods are built for the settings and the others ignore them.
+	enum class ESpringMethod : unsigned int
+	{
+		ExplicitEuler,
+		ExplicitMidpoint,
+		ExplicitRK4,
+		SemiImplicitEuler,
+		VelocityVerlet,
+		Ruth4,
+		Kutta3,
+		SSPRK3,
+		ThreeEighthsRK4,
+		DormandPrince5,
+		Nystrom4,
+		PEFRL4,
+		BlanesMoan4,
+		Yoshida6,
+		Yoshida8,
+		BogackiShampine32,
+		DormandPrince54,
+		BackwardEuler,
+		ImplicitMidpoint,
+		Trapezoidal,
+		BDF4,
+		TransitionMatrix,
+
+		NUM_METHODS
+	};
+
+
+	template<typename T>
+	using SpringMethod = std::function<void(ODE::IState<T, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>& state, float stepSize)>;
+
+	const char* GetSpringMethodName(ESpringMethod method);
+
+	inline bool IsAdaptiveSpringMethod(ESpringMethod method)
+	{
+		return method == ESpringMethod::BogackiShampine32 || method == ESpringMethod::DormandPrince54;
+	}
+
+	template<typename T>
+	SpringMethod<T> MakeSpringMethod(ESpringMethod method, const ODE::AdaptiveSettings& adaptiveSettings)
+	{
+		switch (method)
+		{
+		case ESpringMethod::ExplicitEuler: return ODE::ExplicitEuler<T, 2>;
+		case ESpringMethod::ExplicitMidpoint: return ODE::ExplicitMidpoint<T, 2>;
+		case ESpringMethod::ExplicitRK4: return ODE::ExplicitRK4<T, 2>;
+		case ESpringMethod::SemiImplicitEuler: return ODE::SemiImplicitEuler<T, 2>;
+		case ESpringMethod::VelocityVerlet: return ODE::VelocityVerlet<T>;
+		case ESpringMethod::Ruth4: return ODE::Ruth4<T>;
+		case ESpringMethod::Kutta3: return ODE::ExplicitRungeKutta<ODE::Kutta3, T, 2>;
+		case ESpringMethod::SSPRK3: return ODE::ExplicitRungeKutta<ODE::SSPRK3, T, 2>;
+		case ESpringMethod::ThreeEighthsRK4: return ODE::ExplicitRungeKutta<ODE::ThreeEighthsRK4, T, 2>;
+		case ESpringMethod::DormandPrince5: return ODE::ExplicitRungeKutta<ODE::DormandPrince5, T, 2>;
+		case ESpringMethod::Nystrom4: return ODE::RungeKuttaNystrom<ODE::Nystrom4, T>;
+		case ESpringMethod::PEFRL4: return ODE::SymplecticSplitting<ODE::PEFRL4, T>;
+		case ESpringMethod::BlanesMoan4: return ODE::SymplecticSplitting<ODE::BlanesMoan4, T>;
+		case ESpringMethod::Yoshida6: return ODE::SymplecticSplitting<ODE::LeapfrogComposition<ODE::Yoshida6>, T>;
+		case ESpringMethod::Yoshida8: return ODE::SymplecticSplitting<ODE::LeapfrogComposition<ODE::Yoshida8>, T>;
+		case ESpringMethod::BackwardEuler: return MakeStatefulMethod<ODE::BackwardEuler<T, 2>, T>();
+		case ESpringMethod::ImplicitMidpoint: return MakeStatefulMethod<ODE::ImplicitMidpoint<T, 2>, T>();
+		case ESpringMethod::Trapezoidal: return MakeStatefulMethod<ODE::Trapezoidal<T, 2>, T>();
+		case ESpringMethod::BDF4: return MakeStatefulMethod<ODE::BDF<T, 2>, T>();
+		case ESpringMethod::TransitionMatrix: return MakeStatefulMethod<ODE::TransitionMatrix<T, 2>, T>();
+		case ESpringMethod::BogackiShampine32: return MakeAdaptiveMethod<ODE::BogackiShampine32, T>(adaptiveSettings);
+		case ESpringMethod::DormandPrince54: return MakeAdaptiveMethod<ODE::DormandPrince54, T>(adaptiveSettings);
+		default: return SpringMethod<T>();
+		}
+	}
+
 	typedef std::array<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> FixedSpringDerivatives;
 	typedef std::array<StateData<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> CoupledSpringDerivatives;
 
 
-	struct SingleSpringMassSystem : ODE::IState<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	// The systems are final and define their derivative functions here so that methods given the concrete
+	// type dispatch statically and can inline them.  Passing them as an ODE::IState still uses the vtable.
+	// The single spring is templated on its scalar type so that the precision of the methods can be compared,
+	// only the float and double versions are instantiated with the analytical solution.  Over a dual number
+	// the methods carry the sensitivities to whatever parameters are seeded through the integration.
+	template<typename S>
+	struct SingleSpringMassSystemT final : ODE::IState<S, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
 	{
-		float m_massPos = 1.0f;
-		float m_massSpeed = 0.0f;
-		float m_springConstant = 1.0f;
-		float m_damping = 0.0f;
+		typedef std::array<S, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> Derivatives;
 
-		virtual void GetDerivatives(FixedSpringDerivatives& derivatives) const override;
-		virtual float GetNthDerivative(const FixedSpringDerivatives& derivatives) const override;
-		virtual void SetDerivatives(const FixedSpringDerivatives& derivatives) override;
-		void SolveAnalytical(const std::vector<float>& timeData, std::vector<float>& posData) const;
-		void Reset(float springConstant, float damping);
+		S m_massPos = S(1);
+		S m_massSpeed = S(0);
+		S m_springConstant = S(1);
+		S m_damping = S(0);
+
+		virtual void GetDerivatives(Derivatives& derivatives) const override
+		{
+			derivatives[(int)EStateDerivative::Position] = m_massPos;
+			derivatives[(int)EStateDerivative::Speed] = m_massSpeed;
+		}
+
+		virtual S GetNthDerivative(const Derivatives& derivatives) const override
+		{
+			return EvaluateNthDerivative(derivatives);
+		}
+
+		// a single pass with a tangent lane per derivative, nested duals aren't needed so S = Dual has none
+		virtual bool GetNthDerivativeJacobian(const Derivatives& derivatives, ODE::ScalarType<S>* jacobian) const override
+		{
+			if constexpr (std::is_floating_point_v<S>)
+			{
+				typedef AutoDiff::Dual<S, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> Dual;
+				const std::array<Dual, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)> seeded = {
+					Dual(derivatives[(int)EStateDerivative::Position], (int)EStateDerivative::Position),
+					Dual(derivatives[(int)EStateDerivative::Speed], (int)EStateDerivative::Speed) };
+
+				const Dual nthDerivative = EvaluateNthDerivative(seeded);
+				std::copy(nthDerivative.m_tangents.begin(), nthDerivative.m_tangents.end(), jacobian);
+				return true;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		template<typename U>
+		U EvaluateNthDerivative(const std::array<U, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>& derivatives) const
+		{
+			return -(derivatives[(int)EStateDerivative::Position] * m_springConstant + derivatives[(int)EStateDerivative::Speed] * m_damping);
+		}
+
+		virtual void SetDerivatives(const Derivatives& derivatives) override
+		{
+			m_massPos = derivatives[(int)EStateDerivative::Position];
+			m_massSpeed = derivatives[(int)EStateDerivative::Speed];
+		}
+
+		void SolveAnalytical(const std::vector<S>& timeData, std::vector<S>& posData) const;
+		void Reset(S springConstant, S damping);
 	};
 
+	typedef SingleSpringMassSystemT<float> SingleSpringMassSystem;
+	typedef SingleSpringMassSystemT<double> SingleSpringMassSystemDouble;
+
 
-	struct CoupledSpringMassSystem : ODE::IState<StateData<float, 2>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	struct CoupledSpringMassSystem final : ODE::IState<StateData<float, 2>, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
 	{
 		float m_massPos[2] = { 1.0f, 1.0f };
 		float m_massSpeed[2] = { 0.0f, 0.0f };
 		float m_springConstant = 1.0f;
 		float m_damping = 0.0f;
 
-		virtual void GetDerivatives(CoupledSpringDerivatives& derivatives) const override;
-		virtual StateData<float, 2> GetNthDerivative(const CoupledSpringDerivatives& derivatives) const override;
-		virtual void SetDerivatives(const CoupledSpringDerivatives& derivatives) override;
+		virtual void GetDerivatives(CoupledSpringDerivatives& derivatives) const override
+		{
+			derivatives[(int)EStateDerivative::Position].m_data[0] = m_massPos[0];
+			derivatives[(int)EStateDerivative::Position].m_data[1] = m_massPos[1];
+			derivatives[(int)EStateDerivative::Speed].m_data[0] = m_massSpeed[0];
+			derivatives[(int)EStateDerivative::Speed].m_data[1] = m_massSpeed[1];
+		}
+
+		virtual StateData<float, 2> GetNthDerivative(const CoupledSpringDerivatives& derivatives) const override
+		{
+			StateData<float, 2> accelerations;
+			accelerations.m_data = EvaluateAccelerations(derivatives[(int)EStateDerivative::Position].m_data, derivatives[(int)EStateDerivative::Speed].m_data);
+			return accelerations;
+		}
+
+		// a lane per component of every derivative, in the order the jacobian's columns take them
+		virtual bool GetNthDerivativeJacobian(const CoupledSpringDerivatives& derivatives, float* jacobian) const override
+		{
+			typedef AutoDiff::Dual<float, 4> Dual;
+			const std::array<Dual, 2> positions = { Dual(derivatives[(int)EStateDerivative::Position].m_data[0], 0), Dual(derivatives[(int)EStateDerivative::Position].m_data[1], 1) };
+			const std::array<Dual, 2> speeds = { Dual(derivatives[(int)EStateDerivative::Speed].m_data[0], 2), Dual(derivatives[(int)EStateDerivative::Speed].m_data[1], 3) };
+
+			const std::array<Dual, 2> accelerations = EvaluateAccelerations(positions, speeds);
+			for (unsigned int row = 0; row < 2; ++row)
+				std::copy(accelerations[row].m_tangents.begin(), accelerations[row].m_tangents.end(), jacobian + row * Dual::numLanes);
+			return true;
+		}
+
+		template<typename U>
+		std::array<U, 2> EvaluateAccelerations(const std::array<U, 2>& positions, const std::array<U, 2>& speeds) const
+		{
+			return {
+				-m_springConstant * (2.0f * positions[0] - positions[1]) - m_damping * speeds[0],
+				-m_springConstant * (2.0f * positions[1] - positions[0]) - m_damping * speeds[1] };
+		}
+
+		virtual void SetDerivatives(const CoupledSpringDerivatives& derivatives) override
+		{
+			m_massPos[0] = derivatives[(int)EStateDerivative::Position].m_data[0];
+			m_massPos[1] = derivatives[(int)EStateDerivative::Position].m_data[1];
+			m_massSpeed[0] = derivatives[(int)EStateDerivative::Speed].m_data[0];
+			m_massSpeed[1] = derivatives[(int)EStateDerivative::Speed].m_data[1];
+		}
+
 		void SolveAnalytical(const std::vector<float>& timeData, std::vector<float>& posData0, std::vector<float>& posData1) const;
 		void Reset(float springConstant, float damping);
 	};
+
+
+	struct SingleSpringMassBatch : ODEBatch::IState<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	{
+		std::vector<float> m_springConstant;
+		std::vector<float> m_damping;
+
+		virtual void GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const override;
+		void Reset(size_t numSystems, float springConstant, float damping);
+	};
+
+
+	// positions and speeds hold every system's first mass followed by every system's second mass
+	struct CoupledSpringMassBatch : ODEBatch::IState<float, static_cast<unsigned int>(EStateDerivative::NUM_DERIVATIVES)>
+	{
+		std::vector<float> m_springConstant;
+		std::vector<float> m_damping;
+
+		virtual void GetNthDerivatives(const std::array<const float*, 2>& derivatives, float* nthDerivatives) const override;
+		void Reset(size_t numSystems, float springConstant, float damping);
+		size_t GetNumSystems() const { return m_springConstant.size(); }
+	};
+
+
+	template<typename System, typename T>
+	struct Trajectory;
+
+	class TrajectoryCache;
 }
 
 
@@ -92,25 +467,14 @@ class ODEWidget : public IWindowWidget
 {
 public:
 	ODEWidget(std::weak_ptr<MessageBus> pMessageBus);
+	virtual ~ODEWidget() override;
 
 private:
 	virtual void OnMessage(const MessageType& message) override;
 	virtual const char* GetWindowName() const override;
 	virtual void RenderContents(float deltaTime) override;
 
-	void GenerateSamples();
-
-	enum class EMethod : unsigned int
-	{
-		ExplicitEuler,
-		ExplicitMidpoint,
-		ExplicitRK4,
-		SemiImplicitEuler,
-		VelocityVerlet,
-		Ruth4,
-
-		NUM_METHODS
-	};
+	typedef ODESystem::ESpringMethod EMethod;
 
 	enum class ESystem : unsigned int
 	{
@@ -120,21 +484,75 @@ private:
 		NUM_SYSTEMS
 	};
 
-	std::vector<float> m_analyticalTimeData;
-	std::vector<float> m_methodTimeData;
-	std::vector<float> m_analyticalSingleSpringMassData;
-	std::vector<float> m_analyticalCoupledSpringMassData[2];
+	// copy of the controls a set of samples is generated from, so the sliders can keep moving while the
+	// worker runs
+	struct SampleSettings
+	{
+		ESystem m_system = ESystem::SingleSpringMass;
+		glm::u32 m_methodRenderMask = 0;
+		float m_duration = 60.0f;
+		float m_fps = 60.0f;
+		float m_springConstant = 1.0f;
+		float m_damping = 0.1f;
+		float m_tolerance = 1.0e-4f;
+		bool m_isDenseOutput = false;
+	};
+
+	// only the active system and the methods in the render mask are filled in
+	struct SampleData
+	{
+		glm::u32 m_requestId = 0;
+		SampleSettings m_settings;
+		size_t m_numCachedTrajectories = 0;
+		size_t m_cacheMemorySize = 0;
+		std::vector<float> m_analyticalTimeData;
+		std::vector<float> m_methodTimeData;
+		std::vector<float> m_analyticalSingleSpringMassData;
+		std::vector<float> m_analyticalCoupledSpringMassData[2];
+		std::array<std::vector<float>, static_cast<int>(EMethod::NUM_METHODS)> m_singleSpringMassData;
+		std::array<std::vector<float>[2], static_cast<int>(EMethod::NUM_METHODS)> m_coupledSpringMassData;
+	};
+
+	void RequestSamples();
+	void RequestExport();
+	void SampleWorkerLoop();
+	bool GenerateSamples(const SampleSettings& settings, glm::u32 requestId, SampleData& samples);
+	bool IsRequestCancelled(glm::u32 requestId) const { return requestId != m_requestId; }
+
+	// the adaptive methods are built with the tolerance in the settings
+	std::unique_ptr<ODESystem::Trajectory<ODESystem::SingleSpringMassSystem, float>> CreateSingleSpringMassTrajectory(const SampleSettings& settings, EMethod method) const;
+	std::unique_ptr<ODESystem::Trajectory<ODESystem::CoupledSpringMassSystem, ODESystem::StateData<float, 2>>> CreateCoupledSpringMassTrajectory(const SampleSettings& settings, EMethod method) const;
+
+	// streams every visible method of the active system to its own trajectory file, returns the number written
+	unsigned int ExportTrajectories(const SampleSettings& settings, const char* pDirectory) const;
+
 	std::array<const char*, static_cast<int>(EMethod::NUM_METHODS)> m_methodNames;
 	std::array<const char*, static_cast<int>(ESystem::NUM_SYSTEMS)> m_systemNames;
-	std::array<std::vector<float>, static_cast<int>(EMethod::NUM_METHODS)> m_singleSpringMassData;
-	std::array<std::vector<float>[2], static_cast<int>(EMethod::NUM_METHODS)> m_coupledSpringMassData;
-	std::array<ODESystem::FixedSpringMethod, static_cast<int>(EMethod::NUM_METHODS)> m_singleSpringMassMethods;
-	std::array<ODESystem::FreeSpringMethod, static_cast<int>(EMethod::NUM_METHODS)> m_coupledSpringMassMethods;
-
-	ESystem m_system = ESystem::SingleSpringMass;
-	float m_duration = 60.0f;
-	float m_fps = 60.0f;
-	float m_springConstant = 1.0f;
-	float m_damping = 0.1f;
-	glm::u32 m_methodRenderMask = 0;
+
+	SampleSettings m_settings;
+	std::string m_exportMessage;
+	bool m_isExporting = false;
+
+	// Samples are generated on a worker thread so moving a slider never stalls the frame.  The plot keeps
+	// drawing the front buffer while the worker fills a buffer of its own, which is handed over as the back
+	// buffer once complete and swapped in at the start of the next frame.  Every request bumps the request
+	// id, which cancels any older request still running.  Exports are posted to the same worker and their
+	// message is picked up with the samples.
+	std::unique_ptr<SampleData> m_pFrontSamples;
+	std::unique_ptr<SampleData> m_pBackSamples;
+	std::atomic<glm::u32> m_requestId = 0;
+	SampleSettings m_requestedSettings;
+	bool m_hasRequest = false;
+	bool m_isBackSamplesReady = false;
+	SampleSettings m_exportSettings;
+	std::string m_exportResult;
+	bool m_hasExportRequest = false;
+	bool m_isExportResultReady = false;
+	bool m_isStopping = false;
+	std::mutex m_sampleMutex;
+	std::condition_variable m_sampleRequested;
+	std::thread m_sampleWorker;
+
+	// only used by whichever thread is generating samples
+	std::unique_ptr<ODESystem::TrajectoryCache> m_pTrajectoryCache;
 };
\ No newline at end of file
@@ -0,0 +1,306 @@
+#pragma once
+
+
+#include <math.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+
+
+// Forward mode automatic differentiation.  A dual number carries a value and its derivatives with respect to
+// M inputs, one per tangent lane, and every operation applies the chain rule to all the lanes at once.
+// Seeding input i with a 1 in lane i then gives the whole row of partial derivatives of any result from a
+// single evaluation, exact to rounding, rather than one evaluation per input with finite differences.  The
+// lanes are a fixed size array so the loops over them unroll and vectorise.
+//
+// S may itself be a dual, which nests to give second derivatives in the manner of hyper-dual numbers.
+namespace AutoDiff
+{
+	template<typename S, unsigned int M>
+	struct Dual
+	{
+		typedef S Value;
+		static constexpr unsigned int numLanes = M;
+
+		S m_value = S(0);
+		std::array<S, M> m_tangents = {};
+
+		constexpr Dual()
+		{
+		}
+
+		// constants have no derivatives, which also lets plain values mix with duals in expressions
+		constexpr Dual(const S& value)
+			: m_value(value)
+		{
+		}
+
+		// an input, with respect to which lane holds the derivatives
+		constexpr Dual(const S& value, unsigned int lane)
+			: m_value(value)
+		{
+			m_tangents[lane] = S(1);
+		}
+
+		constexpr Dual<S, M>& operator += (const Dual<S, M>& rhs)
+		{
+			m_value += rhs.m_value;
+			for (unsigned int i = 0; i < M; ++i)
+				m_tangents[i] += rhs.m_tangents[i];
+			return *this;
+		}
+
+		constexpr Dual<S, M>& operator -= (const Dual<S, M>& rhs)
+		{
+			m_value -= rhs.m_value;
+			for (unsigned int i = 0; i < M; ++i)
+				m_tangents[i] -= rhs.m_tangents[i];
+			return *this;
+		}
+
+		constexpr Dual<S, M>& operator *= (const Dual<S, M>& rhs)
+		{
+			for (unsigned int i = 0; i < M; ++i)
+				m_tangents[i] = m_tangents[i] * rhs.m_value + m_value * rhs.m_tangents[i];
+			m_value *= rhs.m_value;
+			return *this;
+		}
+
+		constexpr Dual<S, M>& operator /= (const Dual<S, M>& rhs)
+		{
+			const S inverse = S(1) / rhs.m_value;
+			m_value *= inverse;
+			for (unsigned int i = 0; i < M; ++i)
+				m_tangents[i] = (m_tangents[i] - m_value * rhs.m_tangents[i]) * inverse;
+			return *this;
+		}
+	};
+
+
+	// the value with every level of derivatives stripped off
+	template<typename S>
+	std::enable_if_t<std::is_floating_point_v<S>, S> GetPrimal(const S& value)
+	{
+		return value;
+	}
+
+	template<typename S, unsigned int M>
+	auto GetPrimal(const Dual<S, M>& value)
+	{
+		return GetPrimal(value.m_value);
+	}
+
+
+	// ARITHMETIC
+
+	// The scalar operands are the dual's own value type, which isn't deduced so that literals and other
+	// arithmetic types convert to it.  Scaling by a constant skips the product rule.
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator - (const Dual<S, M>& value)
+	{
+		Dual<S, M> result;
+		result.m_value = -value.m_value;
+		for (unsigned int i = 0; i < M; ++i)
+			result.m_tangents[i] = -value.m_tangents[i];
+		return result;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator + (Dual<S, M> lhs, const Dual<S, M>& rhs)
+	{
+		return lhs += rhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator + (Dual<S, M> lhs, const typename Dual<S, M>::Value& rhs)
+	{
+		lhs.m_value += rhs;
+		return lhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator + (const typename Dual<S, M>::Value& lhs, Dual<S, M> rhs)
+	{
+		rhs.m_value += lhs;
+		return rhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator - (Dual<S, M> lhs, const Dual<S, M>& rhs)
+	{
+		return lhs -= rhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator - (Dual<S, M> lhs, const typename Dual<S, M>::Value& rhs)
+	{
+		lhs.m_value -= rhs;
+		return lhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator - (const typename Dual<S, M>::Value& lhs, const Dual<S, M>& rhs)
+	{
+		return -rhs + lhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator * (Dual<S, M> lhs, const Dual<S, M>& rhs)
+	{
+		return lhs *= rhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator * (Dual<S, M> lhs, const typename Dual<S, M>::Value& rhs)
+	{
+		lhs.m_value *= rhs;
+		for (unsigned int i = 0; i < M; ++i)
+			lhs.m_tangents[i] *= rhs;
+		return lhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator * (const typename Dual<S, M>::Value& lhs, const Dual<S, M>& rhs)
+	{
+		return rhs * lhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator / (Dual<S, M> lhs, const Dual<S, M>& rhs)
+	{
+		return lhs /= rhs;
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator / (const Dual<S, M>& lhs, const typename Dual<S, M>::Value& rhs)
+	{
+		return lhs * (S(1) / rhs);
+	}
+
+	template<typename S, unsigned int M>
+	constexpr Dual<S, M> operator / (const typename Dual<S, M>::Value& lhs, const Dual<S, M>& rhs)
+	{
+		return Dual<S, M>(lhs) /= rhs;
+	}
+
+
+	// COMPARISON
+
+	// only the values take part, so branches in the differentiated code follow the values as they would
+	// without the derivatives
+	template<typename S, unsigned int M>
+	bool operator == (const Dual<S, M>& lhs, const Dual<S, M>& rhs) { return lhs.m_value == rhs.m_value; }
+	template<typename S, unsigned int M>
+	bool operator != (const Dual<S, M>& lhs, const Dual<S, M>& rhs) { return lhs.m_value != rhs.m_value; }
+	template<typename S, unsigned int M>
+	bool operator < (const Dual<S, M>& lhs, const Dual<S, M>& rhs) { return lhs.m_value < rhs.m_value; }
+	template<typename S, unsigned int M>
+	bool operator > (const Dual<S, M>& lhs, const Dual<S, M>& rhs) { return lhs.m_value > rhs.m_value; }
+	template<typename S, unsigned int M>
+	bool operator <= (const Dual<S, M>& lhs, const Dual<S, M>& rhs) { return lhs.m_value <= rhs.m_value; }
+	template<typename S, unsigned int M>
+	bool operator >= (const Dual<S, M>& lhs, const Dual<S, M>& rhs) { return lhs.m_value >= rhs.m_value; }
+
+
+	// FUNCTIONS
+
+	// f(x) with f'(x) applied to every lane, the unqualified calls on the value find the nested dual
+	// overloads through argument dependent lookup
+	template<typename S, unsigned int M>
+	Dual<S, M> ApplyChainRule(const Dual<S, M>& value, const S& result, const S& slope)
+	{
+		Dual<S, M> chained;
+		chained.m_value = result;
+		for (unsigned int i = 0; i < M; ++i)
+			chained.m_tangents[i] = value.m_tangents[i] * slope;
+		return chained;
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> sqrt(const Dual<S, M>& value)
+	{
+		using std::sqrt;
+		const S root = sqrt(value.m_value);
+		return ApplyChainRule(value, root, S(0.5) / root);
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> exp(const Dual<S, M>& value)
+	{
+		using std::exp;
+		const S result = exp(value.m_value);
+		return ApplyChainRule(value, result, result);
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> log(const Dual<S, M>& value)
+	{
+		using std::log;
+		return ApplyChainRule(value, log(value.m_value), S(1) / value.m_value);
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> sin(const Dual<S, M>& value)
+	{
+		using std::sin;
+		using std::cos;
+		return ApplyChainRule(value, sin(value.m_value), cos(value.m_value));
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> cos(const Dual<S, M>& value)
+	{
+		using std::sin;
+		using std::cos;
+		return ApplyChainRule(value, cos(value.m_value), -sin(value.m_value));
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> abs(const Dual<S, M>& value)
+	{
+		return (value.m_value < S(0)) ? -value : value;
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> pow(const Dual<S, M>& value, const typename Dual<S, M>::Value& exponent)
+	{
+		using std::pow;
+		return ApplyChainRule(value, pow(value.m_value, exponent), exponent * pow(value.m_value, exponent - S(1)));
+	}
+
+
+	// ODE STATES
+
+	// A dual is a single component to the ODE methods, so its step size and coefficients are duals too and
+	// the methods carry the derivatives through every step.  Seeding the initial state or the parameters of
+	// a system then gives the sensitivities of the whole trajectory to them.
+	template<typename S, unsigned int M>
+	unsigned int GetNumComponents(const Dual<S, M>& value)
+	{
+		return 1;
+	}
+
+	template<typename S, unsigned int M>
+	Dual<S, M> GetComponent(const Dual<S, M>& value, unsigned int index)
+	{
+		return value;
+	}
+
+	template<typename S, unsigned int M>
+	void SetComponent(Dual<S, M>& value, unsigned int index, const Dual<S, M>& component)
+	{
+		value = component;
+	}
+
+	// the error control of the adaptive methods only looks at the values
+	template<typename S, unsigned int M>
+	float ScaledErrorSquared(const Dual<S, M>& error, const Dual<S, M>& value0, const Dual<S, M>& value1, float absTolerance, float relTolerance, unsigned int& numComponents)
+	{
+		const float scale = absTolerance + relTolerance * std::max(fabsf(static_cast<float>(GetPrimal(value0))), fabsf(static_cast<float>(GetPrimal(value1))));
+		const float scaledError = static_cast<float>(GetPrimal(error)) / scale;
+		++numComponents;
+		return scaledError * scaledError;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "Functions/Random.h"
+#include "Functions/VectorMath.h"
+#include <algorithm>
+#include <math.h>
+
+
+
+namespace Random
+{
+	static constexpr uint64_t multiplier0 = 0xD2511F53u;
+	static constexpr uint64_t multiplier1 = 0xCD9E8D57u;
+	static constexpr uint32_t weyl0 = 0x9E3779B9u;
+	static constexpr uint32_t weyl1 = 0xBB67AE85u;
+	static constexpr unsigned int numRounds = 10;
+
+
+	std::array<uint32_t, 4> Philox4x32(const std::array<uint32_t, 4>& counter, const std::array<uint32_t, 2>& key)
+	{
+		std::array<uint32_t, 4> words = counter;
+		std::array<uint32_t, 2> roundKey = key;
+		for (unsigned int round = 0; round < numRounds; ++round)
+		{
+			const uint64_t product0 = multiplier0 * words[0];
+			const uint64_t product1 = multiplier1 * words[2];
+			words = {
+				static_cast<uint32_t>(product1 >> 32) ^ words[1] ^ roundKey[0],
+				static_cast<uint32_t>(product1),
+				static_cast<uint32_t>(product0 >> 32) ^ words[3] ^ roundKey[1],
+				static_cast<uint32_t>(product0) };
+			roundKey[0] += weyl0;
+			roundKey[1] += weyl1;
+		}
+		return words;
+	}
+
+
+	void FillNormals(uint64_t seed, uint64_t position, uint64_t firstStream, float* normals, size_t count)
+	{
+		// streams per pass, the transcendentals run over a pass at a time
+		constexpr size_t blockSize = 256;
+		constexpr float uniformScale = 1.0f / 16777216.0f;
+		constexpr float twoPi = 6.28318530717958647f;
+
+		const std::array<uint32_t, 2> key = { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+		const uint64_t endStream = firstStream + count;
+
+		float radii[blockSize / 2];
+		float angles[blockSize / 2];
+		float sines[blockSize / 2];
+		float cosines[blockSize / 2];
+
+		for (uint64_t stream = firstStream & ~uint64_t(3); stream < endStream; stream += blockSize)
+		{
+			const size_t numStreams = static_cast<size_t>(std::min<uint64_t>(blockSize, (endStream - stream + 3) & ~uint64_t(3)));
+			const size_t numPairs = numStreams / 2;
+
+			// Philox4x32 across the groups of the pass, with the rounds outside so the loop over groups
+			// vectorises
+			constexpr size_t maxGroups = blockSize / 4;
+			const size_t numGroups = numStreams / 4;
+			uint32_t words[4][maxGroups];
+			for (size_t group = 0; group < numGroups; ++group)
+			{
+				const uint64_t counter = stream / 4 + group;
+				words[0][group] = static_cast<uint32_t>(counter);
+				words[1][group] = static_cast<uint32_t>(counter >> 32);
+				words[2][group] = static_cast<uint32_t>(position);
+				words[3][group] = static_cast<uint32_t>(position >> 32);
+			}
+
+			std::array<uint32_t, 2> roundKey = key;
+			for (unsigned int round = 0; round < numRounds; ++round)
+			{
+				for (size_t group = 0; group < numGroups; ++group)
+				{
+					const uint64_t product0 = multiplier0 * words[0][group];
+					const uint64_t product1 = multiplier1 * words[2][group];
+					words[0][group] = static_cast<uint32_t>(product1 >> 32) ^ words[1][group] ^ roundKey[0];
+					words[1][group] = static_cast<uint32_t>(product1);
+					words[2][group] = static_cast<uint32_t>(product0 >> 32) ^ words[3][group] ^ roundKey[1];
+					words[3][group] = static_cast<uint32_t>(product0);
+				}
+				roundKey[0] += weyl0;
+				roundKey[1] += weyl1;
+			}
+
+			// the top 24 bits of each word give a uniform number with every value exact in a float, the
+			// radius one is offset to (0, 1] so its log is finite
+			for (size_t group = 0; group < numGroups; ++group)
+			{
+				for (unsigned int pair = 0; pair < 2; ++pair)
+				{
+					radii[2 * group + pair] = static_cast<float>((words[2 * pair][group] >> 8) + 1) * uniformScale;
+					angles[2 * group + pair] = static_cast<float>(words[2 * pair + 1][group] >> 8) * (uniformScale * twoPi);
+				}
+			}
+
+			VectorMath::Log(radii, radii, numPairs);
+			for (size_t i = 0; i < numPairs; ++i)
+				radii[i] = sqrtf(-2.0f * radii[i]);
+			VectorMath::SinCos(angles, sines, cosines, numPairs);
+
+			const uint64_t begin = std::max(stream, firstStream);
+			const uint64_t end = std::min<uint64_t>(stream + numStreams, endStream);
+			for (uint64_t s = begin; s < end; ++s)
+			{
+				const size_t i = static_cast<size_t>(s - stream);
+				normals[s - firstStream] = radii[i / 2] * ((i % 2 == 0) ? cosines[i / 2] : sines[i / 2]);
+			}
+		}
+	}
+};
\ No newline at end of file
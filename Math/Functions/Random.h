@@ -0,0 +1,22 @@
+#pragma once
+
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+
+
+// Counter based random numbers, where each number is a pure function of a key and its position rather than
+// the next state of a sequence.  Parallel work can then draw from independent streams in any order and
+// with any split between threads and always get the same numbers.
+namespace Random
+{
+	// Philox4x32-10 of Salmon, Moraes, Dror and Shaw, four 32 bit words from a 128 bit counter
+	std::array<uint32_t, 4> Philox4x32(const std::array<uint32_t, 4>& counter, const std::array<uint32_t, 2>& key);
+
+	// Standard normal numbers at one position of the streams [firstStream, firstStream + count).  Every
+	// four streams share a Philox block at that position, turned into normals by the Box-Muller transform
+	// using the VectorMath kernels.
+	void FillNormals(uint64_t seed, uint64_t position, uint64_t firstStream, float* normals, size_t count);
+};
\ No newline at end of file
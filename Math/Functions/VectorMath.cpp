@@ -0,0 +1,176 @@
+#include "Functions/VectorMath.h"
+#include "Functions/VectorMathKernels.h"
+#include <emmintrin.h>
+#include <math.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+
+namespace VectorMath
+{
+	namespace Detail
+	{
+		// defined in VectorMathAVX2.cpp, which is the only file built for AVX2
+		void ExpAVX2(const float* values, float* results, size_t count);
+		void LogAVX2(const float* values, float* results, size_t count);
+		void SinCosAVX2(const float* values, float* sines, float* cosines, size_t count);
+
+
+		void ExpScalar(const float* values, float* results, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+				results[i] = expf(values[i]);
+		}
+
+
+		void LogScalar(const float* values, float* results, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+				results[i] = logf(values[i]);
+		}
+
+
+		void SinCosScalar(const float* values, float* sines, float* cosines, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				const float value = values[i];
+				sines[i] = sinf(value);
+				cosines[i] = cosf(value);
+			}
+		}
+	};
+
+
+	namespace
+	{
+		struct SSE2
+		{
+			typedef __m128 Float;
+			typedef __m128i Int;
+			static constexpr size_t width = 4;
+
+			static Float Load(const float* values) { return _mm_loadu_ps(values); }
+			static void Store(float* values, Float a) { _mm_storeu_ps(values, a); }
+			static Float Set(float value) { return _mm_set1_ps(value); }
+			static Int SetInt(int value) { return _mm_set1_epi32(value); }
+
+			static Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+			static Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+			static Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+			static Float MulAdd(Float a, Float b, Float c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+			static Float Max(Float a, Float b) { return _mm_max_ps(a, b); }
+
+			static Float And(Float a, Float b) { return _mm_and_ps(a, b); }
+			static Float AndNot(Float a, Float b) { return _mm_andnot_ps(a, b); }
+			static Float Or(Float a, Float b) { return _mm_or_ps(a, b); }
+			static Float Xor(Float a, Float b) { return _mm_xor_ps(a, b); }
+			static Float Less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+			static Float LessEqual(Float a, Float b) { return _mm_cmple_ps(a, b); }
+			static bool AllTrue(Float mask) { return _mm_movemask_ps(mask) == 0xf; }
+
+			static Int ConvertRound(Float a) { return _mm_cvtps_epi32(a); }
+			static Int ConvertTruncate(Float a) { return _mm_cvttps_epi32(a); }
+			static Float ToFloat(Int a) { return _mm_cvtepi32_ps(a); }
+			static Float CastToFloat(Int a) { return _mm_castsi128_ps(a); }
+			static Int CastToInt(Float a) { return _mm_castps_si128(a); }
+
+			static Int IntAdd(Int a, Int b) { return _mm_add_epi32(a, b); }
+			static Int IntSub(Int a, Int b) { return _mm_sub_epi32(a, b); }
+			static Int IntAnd(Int a, Int b) { return _mm_and_si128(a, b); }
+			static Int IntOr(Int a, Int b) { return _mm_or_si128(a, b); }
+			static Int IntAndNot(Int a, Int b) { return _mm_andnot_si128(a, b); }
+			static Int IntEqual(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+			template<int Shift> static Int ShiftLeft(Int a) { return _mm_slli_epi32(a, Shift); }
+			template<int Shift> static Int ShiftRight(Int a) { return _mm_srli_epi32(a, Shift); }
+		};
+
+
+		bool IsAVX2Supported()
+		{
+#if defined(_MSC_VER)
+			// the OS also has to save the upper halves of the registers, which XGETBV reports
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			__cpuid(info, 1);
+			const bool isFMA = (info[2] & (1 << 12)) != 0;
+			const bool isOSXSave = (info[2] & (1 << 27)) != 0;
+			const bool isAVX = (info[2] & (1 << 28)) != 0;
+			if (!isFMA || !isOSXSave || !isAVX || (_xgetbv(0) & 0x6) != 0x6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+		}
+
+
+		EInstructionSet& GetSelectedInstructionSet()
+		{
+			static EInstructionSet instructionSet = IsAVX2Supported() ? EInstructionSet::AVX2 : EInstructionSet::SSE2;
+			return instructionSet;
+		}
+	}
+
+
+	void Exp(const float* values, float* results, size_t count)
+	{
+		if (GetSelectedInstructionSet() == EInstructionSet::AVX2)
+			Detail::ExpAVX2(values, results, count);
+		else
+			Detail::Exp<SSE2>(values, results, count);
+	}
+
+
+	void Log(const float* values, float* results, size_t count)
+	{
+		if (GetSelectedInstructionSet() == EInstructionSet::AVX2)
+			Detail::LogAVX2(values, results, count);
+		else
+			Detail::Log<SSE2>(values, results, count);
+	}
+
+
+	void SinCos(const float* values, float* sines, float* cosines, size_t count)
+	{
+		if (GetSelectedInstructionSet() == EInstructionSet::AVX2)
+			Detail::SinCosAVX2(values, sines, cosines, count);
+		else
+			Detail::SinCos<SSE2>(values, sines, cosines, count);
+	}
+
+
+	EInstructionSet GetInstructionSet()
+	{
+		return GetSelectedInstructionSet();
+	}
+
+
+	bool IsSupported(EInstructionSet instructionSet)
+	{
+		static const bool isAVX2Supported = IsAVX2Supported();
+		return (instructionSet == EInstructionSet::SSE2) || (instructionSet == EInstructionSet::AVX2 && isAVX2Supported);
+	}
+
+
+	void SetInstructionSet(EInstructionSet instructionSet)
+	{
+		if (IsSupported(instructionSet))
+			GetSelectedInstructionSet() = instructionSet;
+	}
+
+
+	const char* GetName(EInstructionSet instructionSet)
+	{
+		constexpr const char* names[] = { "SSE2", "AVX2" };
+		return (instructionSet < EInstructionSet::NUM_INSTRUCTION_SETS) ? names[static_cast<unsigned int>(instructionSet)] : "";
+	}
+};
\ No newline at end of file
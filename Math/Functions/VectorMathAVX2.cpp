@@ -0,0 +1,73 @@
+#include "Functions/VectorMathKernels.h"
+#include <immintrin.h>
+
+
+
+// built with AVX2 enabled (/arch:AVX2) and only called once VectorMath.cpp has checked the CPU supports it
+namespace VectorMath
+{
+	namespace
+	{
+		struct AVX2
+		{
+			typedef __m256 Float;
+			typedef __m256i Int;
+			static constexpr size_t width = 8;
+
+			static Float Load(const float* values) { return _mm256_loadu_ps(values); }
+			static void Store(float* values, Float a) { _mm256_storeu_ps(values, a); }
+			static Float Set(float value) { return _mm256_set1_ps(value); }
+			static Int SetInt(int value) { return _mm256_set1_epi32(value); }
+
+			static Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+			static Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+			static Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+			static Float MulAdd(Float a, Float b, Float c) { return _mm256_fmadd_ps(a, b, c); }
+			static Float Max(Float a, Float b) { return _mm256_max_ps(a, b); }
+
+			static Float And(Float a, Float b) { return _mm256_and_ps(a, b); }
+			static Float AndNot(Float a, Float b) { return _mm256_andnot_ps(a, b); }
+			static Float Or(Float a, Float b) { return _mm256_or_ps(a, b); }
+			static Float Xor(Float a, Float b) { return _mm256_xor_ps(a, b); }
+			static Float Less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+			static Float LessEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+			static bool AllTrue(Float mask) { return _mm256_movemask_ps(mask) == 0xff; }
+
+			static Int ConvertRound(Float a) { return _mm256_cvtps_epi32(a); }
+			static Int ConvertTruncate(Float a) { return _mm256_cvttps_epi32(a); }
+			static Float ToFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+			static Float CastToFloat(Int a) { return _mm256_castsi256_ps(a); }
+			static Int CastToInt(Float a) { return _mm256_castps_si256(a); }
+
+			static Int IntAdd(Int a, Int b) { return _mm256_add_epi32(a, b); }
+			static Int IntSub(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+			static Int IntAnd(Int a, Int b) { return _mm256_and_si256(a, b); }
+			static Int IntOr(Int a, Int b) { return _mm256_or_si256(a, b); }
+			static Int IntAndNot(Int a, Int b) { return _mm256_andnot_si256(a, b); }
+			static Int IntEqual(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+			template<int Shift> static Int ShiftLeft(Int a) { return _mm256_slli_epi32(a, Shift); }
+			template<int Shift> static Int ShiftRight(Int a) { return _mm256_srli_epi32(a, Shift); }
+		};
+	}
+
+
+	namespace Detail
+	{
+		void ExpAVX2(const float* values, float* results, size_t count)
+		{
+			Exp<AVX2>(values, results, count);
+		}
+
+
+		void LogAVX2(const float* values, float* results, size_t count)
+		{
+			Log<AVX2>(values, results, count);
+		}
+
+
+		void SinCosAVX2(const float* values, float* sines, float* cosines, size_t count)
+		{
+			SinCos<AVX2>(values, sines, cosines, count);
+		}
+	};
+};
\ No newline at end of file
@@ -0,0 +1,226 @@
+#pragma once
+
+
+#include <stddef.h>
+#include <string.h>
+
+
+
+// Kernels shared by the instruction sets, only included by VectorMath.cpp and VectorMathAVX2.cpp.  Each
+// translation unit instantiates them on its own lane type, which wraps the intrinsics, so the AVX2 code
+// never ends up in a function the SSE2 path could call.  For the same reason nothing here uses inline
+// functions from other headers, the C library fallbacks live in VectorMath.cpp.
+namespace VectorMath
+{
+	namespace Detail
+	{
+		void ExpScalar(const float* values, float* results, size_t count);
+		void LogScalar(const float* values, float* results, size_t count);
+		void SinCosScalar(const float* values, float* sines, float* cosines, size_t count);
+
+
+		// range reduction x = n ln(2) + r, with ln(2) split so n ln2Hi is exact, then a degree 7
+		// polynomial for e^r on |r| <= ln(2) / 2 and the exponent bits built from n
+		template<typename V>
+		bool ExpBlock(const float* values, float* results)
+		{
+			typedef typename V::Float Float;
+			typedef typename V::Int Int;
+
+			constexpr float minValue = -87.3365448f;		// smallest normal result
+			constexpr float maxValue = 88.3762626f;			// keeps n <= 127
+			constexpr float log2e = 1.44269504088896341f;
+			constexpr float ln2Hi = 0.693359375f;
+			constexpr float ln2Lo = -2.12194440e-4f;
+
+			const Float x0 = V::Load(values);
+
+			// NaN fails the compare as well
+			if (!V::AllTrue(V::LessEqual(x0, V::Set(maxValue))))
+				return false;
+
+			const Float underflow = V::Less(x0, V::Set(minValue));
+			Float x = V::Max(x0, V::Set(minValue));
+
+			const Int n = V::ConvertRound(V::Mul(x, V::Set(log2e)));
+			const Float fn = V::ToFloat(n);
+			x = V::MulAdd(fn, V::Set(-ln2Hi), x);
+			x = V::MulAdd(fn, V::Set(-ln2Lo), x);
+
+			Float p = V::Set(1.9875691500e-4f);
+			p = V::MulAdd(p, x, V::Set(1.3981999507e-3f));
+			p = V::MulAdd(p, x, V::Set(8.3334519073e-3f));
+			p = V::MulAdd(p, x, V::Set(4.1665795894e-2f));
+			p = V::MulAdd(p, x, V::Set(1.6666665459e-1f));
+			p = V::MulAdd(p, x, V::Set(5.0000001201e-1f));
+			const Float y = V::Add(V::MulAdd(p, V::Mul(x, x), x), V::Set(1.0f));
+
+			const Float scale = V::CastToFloat(V::template ShiftLeft<23>(V::IntAdd(n, V::SetInt(127))));
+			V::Store(results, V::AndNot(underflow, V::Mul(y, scale)));
+			return true;
+		}
+
+
+		// x = m 2^e with m in [sqrt(1/2), sqrt(2)), then log(m) from a degree 9 polynomial in m - 1 and the
+		// exponent added back with ln(2) split as for Exp
+		template<typename V>
+		bool LogBlock(const float* values, float* results)
+		{
+			typedef typename V::Float Float;
+			typedef typename V::Int Int;
+
+			constexpr float minValue = 1.17549435e-38f;		// smallest normal
+			constexpr float maxValue = 3.40282347e+38f;
+			constexpr float sqrtHalf = 0.707106781186547524f;
+			constexpr float ln2Hi = 0.693359375f;
+			constexpr float ln2Lo = -2.12194440e-4f;
+
+			const Float x0 = V::Load(values);
+
+			// zero, negative, subnormal, infinite and NaN lanes all fail one of the compares
+			if (!V::AllTrue(V::And(V::LessEqual(V::Set(minValue), x0), V::LessEqual(x0, V::Set(maxValue)))))
+				return false;
+
+			// the exponent of the mantissa is swapped for that of 0.5 so it lands in [0.5, 1)
+			const Int bits = V::CastToInt(x0);
+			const Int exponent = V::IntSub(V::template ShiftRight<23>(bits), V::SetInt(126));
+			Float x = V::CastToFloat(V::IntOr(V::IntAnd(bits, V::SetInt(0x007fffff)), V::SetInt(0x3f000000)));
+
+			const Float isSmall = V::Less(x, V::Set(sqrtHalf));
+			const Float e = V::Sub(V::ToFloat(exponent), V::And(isSmall, V::Set(1.0f)));
+			x = V::Add(V::Sub(x, V::Set(1.0f)), V::And(isSmall, x));
+
+			const Float z = V::Mul(x, x);
+			Float p = V::Set(7.0376836292e-2f);
+			p = V::MulAdd(p, x, V::Set(-1.1514610310e-1f));
+			p = V::MulAdd(p, x, V::Set(1.1676998740e-1f));
+			p = V::MulAdd(p, x, V::Set(-1.2420140846e-1f));
+			p = V::MulAdd(p, x, V::Set(1.4249322787e-1f));
+			p = V::MulAdd(p, x, V::Set(-1.6668057665e-1f));
+			p = V::MulAdd(p, x, V::Set(2.0000714765e-1f));
+			p = V::MulAdd(p, x, V::Set(-2.4999993993e-1f));
+			p = V::MulAdd(p, x, V::Set(3.3333331174e-1f));
+
+			Float y = V::Mul(V::Mul(p, x), z);
+			y = V::MulAdd(e, V::Set(ln2Lo), y);
+			y = V::MulAdd(z, V::Set(-0.5f), y);
+			V::Store(results, V::MulAdd(e, V::Set(ln2Hi), V::Add(x, y)));
+			return true;
+		}
+
+
+		// Reduction to |r| <= pi / 4 by the nearest even multiple j of pi / 4, with pi / 4 split in three
+		// so the reduction stays exact while j fits in the 16 bits the leading part leaves.  The quadrant
+		// bits of j pick which polynomial each of sine and cosine take and their signs.
+		template<typename V>
+		bool SinCosBlock(const float* values, float* sines, float* cosines)
+		{
+			typedef typename V::Float Float;
+			typedef typename V::Int Int;
+
+			constexpr float maxValue = 8192.0f;
+			constexpr float fourOverPi = 1.27323954473516f;
+			constexpr float dp1 = 0.78515625f;
+			constexpr float dp2 = 2.4187564849853515625e-4f;
+			constexpr float dp3 = 3.77489497744594108e-8f;
+
+			const Float signMask = V::CastToFloat(V::SetInt(static_cast<int>(0x80000000u)));
+			const Float x0 = V::Load(values);
+			const Float x = V::AndNot(signMask, x0);
+
+			if (!V::AllTrue(V::LessEqual(x, V::Set(maxValue))))
+				return false;
+
+			Int j = V::ConvertTruncate(V::Mul(x, V::Set(fourOverPi)));
+			j = V::IntAnd(V::IntAdd(j, V::SetInt(1)), V::SetInt(~1));
+			const Float fj = V::ToFloat(j);
+
+			const Float sinSign = V::Xor(V::And(x0, signMask), V::CastToFloat(V::template ShiftLeft<29>(V::IntAnd(j, V::SetInt(4)))));
+			const Float cosSign = V::CastToFloat(V::template ShiftLeft<29>(V::IntAndNot(V::IntSub(j, V::SetInt(2)), V::SetInt(4))));
+			const Float isSinPolynomial = V::CastToFloat(V::IntEqual(V::IntAnd(j, V::SetInt(2)), V::SetInt(0)));
+
+			Float r = V::MulAdd(fj, V::Set(-dp1), x);
+			r = V::MulAdd(fj, V::Set(-dp2), r);
+			r = V::MulAdd(fj, V::Set(-dp3), r);
+			const Float z = V::Mul(r, r);
+
+			Float c = V::Set(2.443315711809948e-5f);
+			c = V::MulAdd(c, z, V::Set(-1.388731625493765e-3f));
+			c = V::MulAdd(c, z, V::Set(4.166664568298827e-2f));
+			c = V::MulAdd(c, V::Mul(z, z), V::MulAdd(z, V::Set(-0.5f), V::Set(1.0f)));
+
+			Float s = V::Set(-1.9515295891e-4f);
+			s = V::MulAdd(s, z, V::Set(8.3321608736e-3f));
+			s = V::MulAdd(s, z, V::Set(-1.6666654611e-1f));
+			s = V::MulAdd(s, V::Mul(z, r), r);
+
+			const Float sine = V::Or(V::And(isSinPolynomial, s), V::AndNot(isSinPolynomial, c));
+			const Float cosine = V::Or(V::And(isSinPolynomial, c), V::AndNot(isSinPolynomial, s));
+			V::Store(sines, V::Xor(sine, sinSign));
+			V::Store(cosines, V::Xor(cosine, cosSign));
+			return true;
+		}
+
+
+		// the tail runs as a whole block padded with ones, which every kernel accepts
+		template<typename V, typename Block, typename Scalar>
+		void Apply(const float* values, float* results, size_t count, const Block& block, const Scalar& scalar)
+		{
+			size_t i = 0;
+			for (; i + V::width <= count; i += V::width)
+			{
+				if (!block(values + i, results + i))
+					scalar(values + i, results + i, V::width);
+			}
+
+			if (i < count)
+			{
+				float buffer[V::width];
+				for (size_t j = 0; j < V::width; ++j)
+					buffer[j] = 1.0f;
+				memcpy(buffer, values + i, (count - i) * sizeof(float));
+				if (!block(buffer, buffer))
+					scalar(buffer, buffer, V::width);
+				memcpy(results + i, buffer, (count - i) * sizeof(float));
+			}
+		}
+
+
+		template<typename V>
+		void Exp(const float* values, float* results, size_t count)
+		{
+			Apply<V>(values, results, count, [](const float* blockValues, float* blockResults) { return ExpBlock<V>(blockValues, blockResults); }, ExpScalar);
+		}
+
+
+		template<typename V>
+		void Log(const float* values, float* results, size_t count)
+		{
+			Apply<V>(values, results, count, [](const float* blockValues, float* blockResults) { return LogBlock<V>(blockValues, blockResults); }, LogScalar);
+		}
+
+
+		template<typename V>
+		void SinCos(const float* values, float* sines, float* cosines, size_t count)
+		{
+			size_t i = 0;
+			for (; i + V::width <= count; i += V::width)
+			{
+				if (!SinCosBlock<V>(values + i, sines + i, cosines + i))
+					SinCosScalar(values + i, sines + i, cosines + i, V::width);
+			}
+
+			if (i < count)
+			{
+				float buffer[V::width] = {};
+				float sineBuffer[V::width];
+				float cosineBuffer[V::width];
+				memcpy(buffer, values + i, (count - i) * sizeof(float));
+				if (!SinCosBlock<V>(buffer, sineBuffer, cosineBuffer))
+					SinCosScalar(buffer, sineBuffer, cosineBuffer, V::width);
+				memcpy(sines + i, sineBuffer, (count - i) * sizeof(float));
+				memcpy(cosines + i, cosineBuffer, (count - i) * sizeof(float));
+			}
+		}
+	};
+};
\ No newline at end of file
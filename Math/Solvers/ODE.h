@@ -3,11 +3,46 @@
 
 #include <math.h>
 #include <array>
+#include <type_traits>
+#include <utility>
 
 
 
 namespace ODE
 {
+	// flattened access to the scalar components of a derivative, compound T provide overloads in their own namespace
+	template<typename Scalar>
+	std::enable_if_t<std::is_floating_point_v<Scalar>, unsigned int> GetNumComponents(const Scalar& value)
+	{
+		return 1;
+	}
+
+	template<typename Scalar>
+	std::enable_if_t<std::is_floating_point_v<Scalar>, Scalar> GetComponent(const Scalar& value, unsigned int index)
+	{
+		return value;
+	}
+
+	template<typename Scalar>
+	std::enable_if_t<std::is_floating_point_v<Scalar>> SetComponent(Scalar& value, unsigned int index, Scalar component)
+	{
+		value = component;
+	}
+
+
+	// the floating point type of each component of T which the step size and coefficients are expressed in
+	template<typename T>
+	using ScalarType = std::decay_t<decltype(GetComponent(std::declval<const T&>(), 0u))>;
+
+
+	// The methods below are templated on the state type and only require it to provide the three functions
+	// of IState.  Passing a system through an IState reference dispatches through the vtable, while passing
+	// a concrete type whose functions aren't virtual (or are marked final) lets the derivative function be
+	// inlined into the method.
+	//
+	// The jacobian of the nth derivative is optional, a row per component of T holding the partial
+	// derivatives with respect to every component of the chained derivatives in order.  The implicit methods
+	// use it when it's given rather than estimating it with finite differences.
 	template<typename T, unsigned int N>
 	struct IState
 	{
@@ -15,13 +50,24 @@ namespace ODE
 		virtual void GetDerivatives(std::array<T, N>& derivatives) const = 0;
 		virtual T GetNthDerivative(const std::array<T, N>& derivatives) const = 0;
 		virtual void SetDerivatives(const std::array<T, N>& derivatives) = 0;
+		virtual bool GetNthDerivativeJacobian(const std::array<T, N>& derivatives, ScalarType<T>* jacobian) const { return false; }
 	};
 
 
+	// evaluates the time derivative of every entry in the chained derivative layout
+	template<typename T, unsigned int N, typename State>
+	void EvaluateDerivatives(const State& state, const std::array<T, N>& derivatives, std::array<T, N>& rates)
+	{
+		for (unsigned int i = 0; i < N - 1; ++i)
+			rates[i] = derivatives[i + 1];
+		rates[N - 1] = state.GetNthDerivative(derivatives);
+	}
+
+
 	// 1ST ORDER
 
-	template<typename T, unsigned int N>
-	void ExplicitEuler(IState<T, N>& state, float stepSize)
+	template<typename T, unsigned int N, typename State = IState<T, N>>
+	void ExplicitEuler(State& state, ScalarType<T> stepSize)
 	{
 		static_assert(N > 0);
 
@@ -37,8 +83,8 @@ namespace ODE
 	}
 
 
-	template<typename T, unsigned int N>
-	void SemiImplicitEuler(IState<T, N>& state, float stepSize)
+	template<typename T, unsigned int N, typename State = IState<T, N>>
+	void SemiImplicitEuler(State& state, ScalarType<T> stepSize)
 	{
 		static_assert(N > 0);
 
@@ -55,8 +101,8 @@ namespace ODE
 
 	// 2ND ORDER
 
-	template<typename T, unsigned int N>
-	void ExplicitMidpoint(IState<T, N>& state, float stepSize)
+	template<typename T, unsigned int N, typename State = IState<T, N>>
+	void ExplicitMidpoint(State& state, ScalarType<T> stepSize)
 	{
 		static_assert(N > 0);
 		
@@ -68,7 +114,7 @@ namespace ODE
 			k1[i] = derivatives[i + 1];
 		k1[N - 1] = state.GetNthDerivative(derivatives);
 
-		const float halfStepSize = 0.5f * stepSize;
+		const ScalarType<T> halfStepSize = ScalarType<T>(0.5) * stepSize;
 
 		std::array<T, N> dataMid;
 		for (unsigned int i = 0; i < N; ++i)
@@ -86,17 +132,17 @@ namespace ODE
 	}
 
 
-	template<typename T>
-	void VelocityVerlet(IState<T, 2>& state, float stepSize)
+	template<typename T, typename State = IState<T, 2>>
+	void VelocityVerlet(State& state, ScalarType<T> stepSize)
 	{
 		std::array<T, 2> derivatives;
 		state.GetDerivatives(derivatives);
 
 		const T nthDerivative0 = state.GetNthDerivative(derivatives);
-		derivatives[0] += derivatives[1] * stepSize + nthDerivative0 * stepSize * stepSize * 0.5f;
+		derivatives[0] += derivatives[1] * stepSize + nthDerivative0 * stepSize * stepSize * ScalarType<T>(0.5);
 
 		const T nthDerivative1 = state.GetNthDerivative(derivatives);
-		derivatives[1] += (nthDerivative0 + nthDerivative1) * stepSize * 0.5f;
+		derivatives[1] += (nthDerivative0 + nthDerivative1) * stepSize * ScalarType<T>(0.5);
 
 		state.SetDerivatives(derivatives);
 	}
@@ -104,8 +150,8 @@ namespace ODE
 
 	// 4TH ORDER
 
-	template<typename T, unsigned int N>
-	void ExplicitRK4(IState<T, N>& state, float stepSize)
+	template<typename T, unsigned int N, typename State = IState<T, N>>
+	void ExplicitRK4(State& state, ScalarType<T> stepSize)
 	{
 		static_assert(N > 0);
 
@@ -117,7 +163,7 @@ namespace ODE
 			k1[i] = derivatives[i + 1];
 		k1[N - 1] = state.GetNthDerivative(derivatives);
 
-		const float halfStepSize = 0.5f * stepSize;
+		const ScalarType<T> halfStepSize = ScalarType<T>(0.5) * stepSize;
 
 		std::array<T, N> estimateData;
 		for (unsigned int i = 0; i < N; ++i)
@@ -144,21 +190,23 @@ namespace ODE
 			k4[i] = k1[i] + k3[i + 1] * stepSize;
 		k4[N - 1] = state.GetNthDerivative(estimateData);
 
-		constexpr float sixth = 1.0f / 6.0f;
+		typedef ScalarType<T> Scalar;
+		constexpr Scalar sixth = Scalar(1) / Scalar(6);
 		for (unsigned int i = 0; i < N; ++i)
-			derivatives[i] += (k1[i] + k2[i] * 2.0f + k3[i] * 2.0f + k4[i]) * sixth * stepSize;
+			derivatives[i] += (k1[i] + k2[i] * Scalar(2) + k3[i] * Scalar(2) + k4[i]) * sixth * stepSize;
 
 		state.SetDerivatives(derivatives);
 	}
 
 
-	template<typename T>
-	void Ruth4(IState<T, 2>& state, float stepSize)
+	template<typename T, typename State = IState<T, 2>>
+	void Ruth4(State& state, ScalarType<T> stepSize)
 	{
-		constexpr float twoToThird = 1.25992104989f;
-		constexpr float ratio = 1.0f / (2.0f - twoToThird);
-		constexpr float c[4] = { 0.5f * ratio, 0.5f * (1.0f - twoToThird) * ratio, 0.5f * (1.0f - twoToThird) * ratio, 0.5f * ratio };
-		constexpr float d[4] = { 0.0f, ratio, -twoToThird * ratio, ratio };
+		typedef ScalarType<T> Scalar;
+		constexpr Scalar twoToThird = static_cast<Scalar>(1.2599210498948731647672106L);
+		constexpr Scalar ratio = Scalar(1) / (Scalar(2) - twoToThird);
+		constexpr Scalar c[4] = { Scalar(0.5) * ratio, Scalar(0.5) * (Scalar(1) - twoToThird) * ratio, Scalar(0.5) * (Scalar(1) - twoToThird) * ratio, Scalar(0.5) * ratio };
+		constexpr Scalar d[4] = { Scalar(0), ratio, -twoToThird * ratio, ratio };
 
 		std::array<T, 2> derivatives;
 		state.GetDerivatives(derivatives);
@@ -0,0 +1,329 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include "Solvers/ODEDenseOutput.h"
+#include <math.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+
+
+namespace ODE
+{
+	struct AdaptiveSettings
+	{
+		float m_absTolerance = 1.0e-6f;
+		float m_relTolerance = 1.0e-4f;
+		float m_initialStepSize = 0.0f;		// estimated from the starting state when zero
+		float m_minStepSize = 1.0e-6f;		// steps at this size are accepted regardless of error
+		float m_maxStepSize = 1.0f;
+		float m_safetyFactor = 0.9f;
+		float m_minScale = 0.2f;
+		float m_maxScale = 5.0f;
+	};
+
+
+	struct AdaptiveStats
+	{
+		unsigned int m_numAcceptedSteps = 0;
+		unsigned int m_numRejectedSteps = 0;
+		unsigned int m_numEvaluations = 0;
+		bool m_isDiverged = false;				// the error was not finite even at the minimum step size
+	};
+
+
+	// Embedded pairs.  b holds the weights of the propagated solution and e holds the difference between
+	// those weights and the embedded solution's weights, so the error estimate is h * sum(e[i] * k[i]).
+
+	struct BogackiShampine32
+	{
+		static constexpr unsigned int numStages = 4;
+		static constexpr unsigned int order = 3;
+		static constexpr unsigned int embeddedOrder = 2;
+		static constexpr bool isFirstSameAsLast = true;
+
+		static constexpr long double c[numStages] = { 0.0L, 1.0L / 2.0L, 3.0L / 4.0L, 1.0L };
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 1.0L / 2.0L, 0.0L, 0.0L, 0.0L },
+			{ 0.0L, 3.0L / 4.0L, 0.0L, 0.0L },
+			{ 2.0L / 9.0L, 1.0L / 3.0L, 4.0L / 9.0L, 0.0L } };
+		static constexpr long double b[numStages] = { 2.0L / 9.0L, 1.0L / 3.0L, 4.0L / 9.0L, 0.0L };
+		static constexpr long double e[numStages] = { -5.0L / 72.0L, 1.0L / 12.0L, 1.0L / 9.0L, -1.0L / 8.0L };
+	};
+
+
+	struct DormandPrince54
+	{
+		static constexpr unsigned int numStages = 7;
+		static constexpr unsigned int order = 5;
+		static constexpr unsigned int embeddedOrder = 4;
+		static constexpr bool isFirstSameAsLast = true;
+
+		static constexpr long double c[numStages] = { 0.0L, 1.0L / 5.0L, 3.0L / 10.0L, 4.0L / 5.0L, 8.0L / 9.0L, 1.0L, 1.0L };
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 1.0L / 5.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 3.0L / 40.0L, 9.0L / 40.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 44.0L / 45.0L, -56.0L / 15.0L, 32.0L / 9.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 19372.0L / 6561.0L, -25360.0L / 2187.0L, 64448.0L / 6561.0L, -212.0L / 729.0L, 0.0L, 0.0L, 0.0L },
+			{ 9017.0L / 3168.0L, -355.0L / 33.0L, 46732.0L / 5247.0L, 49.0L / 176.0L, -5103.0L / 18656.0L, 0.0L, 0.0L },
+			{ 35.0L / 384.0L, 0.0L, 500.0L / 1113.0L, 125.0L / 192.0L, -2187.0L / 6784.0L, 11.0L / 84.0L, 0.0L } };
+		static constexpr long double b[numStages] = { 35.0L / 384.0L, 0.0L, 500.0L / 1113.0L, 125.0L / 192.0L, -2187.0L / 6784.0L, 11.0L / 84.0L, 0.0L };
+		static constexpr long double e[numStages] = { 71.0L / 57600.0L, 0.0L, -71.0L / 16695.0L, 71.0L / 1920.0L, -17253.0L / 339200.0L, 22.0L / 525.0L, -1.0L / 40.0L };
+	};
+
+
+	// Scaled error contribution of a single component.  States with compound T provide an overload in their
+	// own namespace which is found through argument dependent lookup.
+	template<typename Scalar>
+	std::enable_if_t<std::is_floating_point_v<Scalar>, float> ScaledErrorSquared(Scalar error, Scalar value0, Scalar value1, float absTolerance, float relTolerance, unsigned int& numComponents)
+	{
+		const Scalar scale = absTolerance + relTolerance * std::max(std::abs(value0), std::abs(value1));
+		const float scaledError = static_cast<float>(error / scale);
+		++numComponents;
+		return scaledError * scaledError;
+	}
+
+
+	template<typename Tableau, typename T, unsigned int N>
+	class AdaptiveRungeKutta
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		// everything that carries over from one call to Integrate to the next, restoring it along with the
+		// state resumes a run exactly where it left off
+		struct Checkpoint
+		{
+			AdaptiveStats m_stats;
+			Scalar m_stepSize = Scalar(0);
+			float m_prevErrorNorm = 1.0f;
+			Scalar m_time = Scalar(0);
+		};
+
+		AdaptiveRungeKutta(const AdaptiveSettings& settings = AdaptiveSettings())
+			: m_settings(settings)
+			, m_stepSize(settings.m_initialStepSize)
+		{
+		}
+
+		// Advances the state by exactly duration, taking as many internal steps as the tolerances require.
+		// Every accepted step is added to the dense output if one is given, which costs no extra evaluations
+		// for first same as last pairs.  A step whose error isn't finite is retried at the minimum step size,
+		// and if that fails too the state is left at the last accepted step and the stats are marked diverged.
+		template<typename State>
+		void Integrate(State& state, Scalar duration, DenseOutput<T, N>* pDenseOutput = nullptr)
+		{
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+
+			std::array<std::array<T, N>, Tableau::numStages> k;
+			EvaluateDerivatives<T, N>(state, derivatives, k[0]);
+			++m_stats.m_numEvaluations;
+
+			if (pDenseOutput)
+				pDenseOutput->AddNode(m_time, derivatives, k[0]);
+
+			if (m_stepSize <= Scalar(0))
+				m_stepSize = EstimateInitialStepSize(state, derivatives, k[0]);
+
+			bool hasFirstStage = true;
+			Scalar remaining = duration;
+			while (remaining > Scalar(0))
+			{
+				// clip the final step so we land exactly on the requested duration
+				const bool isClipped = m_stepSize * Scalar(1.00001) >= remaining;
+				const Scalar stepSize = isClipped ? remaining : m_stepSize;
+
+				if (!hasFirstStage)
+				{
+					EvaluateDerivatives<T, N>(state, derivatives, k[0]);
+					++m_stats.m_numEvaluations;
+				}
+
+				std::array<T, N> estimate;
+				for (unsigned int s = 1; s < Tableau::numStages; ++s)
+				{
+					for (unsigned int i = 0; i < N; ++i)
+					{
+						estimate[i] = derivatives[i];
+						for (unsigned int j = 0; j < s; ++j)
+						{
+							if (Tableau::a[s][j] != 0.0f)
+								estimate[i] = estimate[i] + k[j][i] * (static_cast<Scalar>(Tableau::a[s][j]) * stepSize);
+						}
+					}
+					EvaluateDerivatives<T, N>(state, estimate, k[s]);
+					++m_stats.m_numEvaluations;
+				}
+
+				std::array<T, N> nextDerivatives;
+				float errorSquared = 0.0f;
+				unsigned int numComponents = 0;
+				for (unsigned int i = 0; i < N; ++i)
+				{
+					nextDerivatives[i] = derivatives[i];
+					T error = k[0][i] * (static_cast<Scalar>(Tableau::e[0]) * stepSize);
+					for (unsigned int j = 0; j < Tableau::numStages; ++j)
+					{
+						if (Tableau::b[j] != 0.0f)
+							nextDerivatives[i] = nextDerivatives[i] + k[j][i] * (static_cast<Scalar>(Tableau::b[j]) * stepSize);
+						if (j > 0 && Tableau::e[j] != 0.0f)
+							error = error + k[j][i] * (static_cast<Scalar>(Tableau::e[j]) * stepSize);
+					}
+					errorSquared += ScaledErrorSquared(error, derivatives[i], nextDerivatives[i], m_settings.m_absTolerance, m_settings.m_relTolerance, numComponents);
+				}
+				const float errorNorm = sqrtf(errorSquared / numComponents);
+				const bool isFinite = isfinite(errorNorm);
+				if (!isFinite && stepSize <= m_settings.m_minStepSize)
+				{
+					++m_stats.m_numRejectedSteps;
+					m_stats.m_isDiverged = true;
+					break;
+				}
+
+				constexpr float exponent = 1.0f / (Tableau::embeddedOrder + 1);
+				if (isFinite && (errorNorm <= 1.0f || stepSize <= m_settings.m_minStepSize))
+				{
+					// accept step and use a PI controller to propose the next step size
+					derivatives = nextDerivatives;
+					remaining = isClipped ? Scalar(0) : remaining - stepSize;
+					m_time += stepSize;
+					++m_stats.m_numAcceptedSteps;
+
+					if (Tableau::isFirstSameAsLast)
+						k[0] = k[Tableau::numStages - 1];
+					hasFirstStage = Tableau::isFirstSameAsLast;
+
+					if (pDenseOutput)
+					{
+						// the node's rates become the first stage of the next step so they're never wasted
+						if (!hasFirstStage)
+						{
+							EvaluateDerivatives<T, N>(state, derivatives, k[0]);
+							++m_stats.m_numEvaluations;
+							hasFirstStage = true;
+						}
+						pDenseOutput->AddNode(m_time, derivatives, k[0]);
+					}
+
+					const float safeErrorNorm = std::max(errorNorm, 1.0e-4f);
+					const float scale = m_settings.m_safetyFactor * powf(safeErrorNorm, -0.7f * exponent) * powf(m_prevErrorNorm, 0.4f * exponent);
+					m_prevErrorNorm = safeErrorNorm;
+
+					if (!isClipped || stepSize >= m_stepSize)
+						m_stepSize = ClampStepSize(stepSize * Scalar(fminf(fmaxf(scale, m_settings.m_minScale), m_settings.m_maxScale)));
+				}
+				else
+				{
+					// reject step and retry with a smaller step, fmaxf drops a NaN scale for the minimum
+					++m_stats.m_numRejectedSteps;
+					const float scale = m_settings.m_safetyFactor * powf(errorNorm, -exponent);
+					m_stepSize = isFinite ? ClampStepSize(stepSize * Scalar(fmaxf(scale, m_settings.m_minScale))) : Scalar(m_settings.m_minStepSize);
+				}
+			}
+
+			state.SetDerivatives(derivatives);
+		}
+
+		void Reset()
+		{
+			m_stepSize = m_settings.m_initialStepSize;
+			m_prevErrorNorm = 1.0f;
+			m_time = Scalar(0);
+			m_stats = AdaptiveStats();
+		}
+
+		Checkpoint GetCheckpoint() const
+		{
+			Checkpoint checkpoint;
+			checkpoint.m_stats = m_stats;
+			checkpoint.m_stepSize = m_stepSize;
+			checkpoint.m_prevErrorNorm = m_prevErrorNorm;
+			checkpoint.m_time = m_time;
+			return checkpoint;
+		}
+
+		void Restore(const Checkpoint& checkpoint)
+		{
+			m_stats = checkpoint.m_stats;
+			m_stepSize = checkpoint.m_stepSize;
+			m_prevErrorNorm = checkpoint.m_prevErrorNorm;
+			m_time = checkpoint.m_time;
+		}
+
+		const AdaptiveStats& GetStats() const
+		{
+			return m_stats;
+		}
+
+		Scalar GetStepSize() const
+		{
+			return m_stepSize;
+		}
+
+		// total duration integrated since construction or the last reset
+		Scalar GetTime() const
+		{
+			return m_time;
+		}
+
+	private:
+		// written so a NaN step size comes out as the minimum
+		Scalar ClampStepSize(Scalar stepSize) const
+		{
+			return (stepSize >= Scalar(m_settings.m_minStepSize)) ? std::min(stepSize, Scalar(m_settings.m_maxStepSize)) : Scalar(m_settings.m_minStepSize);
+		}
+
+		// Hairer & Wanner's starting step heuristic using a single explicit Euler probe
+		template<typename State>
+		Scalar EstimateInitialStepSize(const State& state, const std::array<T, N>& derivatives, const std::array<T, N>& rates)
+		{
+			float derivativesSquared = 0.0f;
+			float ratesSquared = 0.0f;
+			unsigned int numComponents = 0;
+			unsigned int numRateComponents = 0;
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				derivativesSquared += ScaledErrorSquared(derivatives[i], derivatives[i], derivatives[i], m_settings.m_absTolerance, m_settings.m_relTolerance, numComponents);
+				ratesSquared += ScaledErrorSquared(rates[i], derivatives[i], derivatives[i], m_settings.m_absTolerance, m_settings.m_relTolerance, numRateComponents);
+			}
+			const float derivativesNorm = sqrtf(derivativesSquared / numComponents);
+			const float ratesNorm = sqrtf(ratesSquared / numRateComponents);
+			const Scalar probeStepSize = (derivativesNorm < 1.0e-5f || ratesNorm < 1.0e-5f) ? Scalar(1.0e-6) : Scalar(0.01f * derivativesNorm / ratesNorm);
+
+			std::array<T, N> probe;
+			for (unsigned int i = 0; i < N; ++i)
+				probe[i] = derivatives[i] + rates[i] * probeStepSize;
+
+			std::array<T, N> probeRates;
+			EvaluateDerivatives<T, N>(state, probe, probeRates);
+			++m_stats.m_numEvaluations;
+
+			// T only provides addition and scaling so the difference is formed by scaling with -1
+			float curvatureSquared = 0.0f;
+			numComponents = 0;
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				const T rateChange = probeRates[i] + rates[i] * Scalar(-1);
+				curvatureSquared += ScaledErrorSquared(rateChange, derivatives[i], derivatives[i], m_settings.m_absTolerance, m_settings.m_relTolerance, numComponents);
+			}
+			const float curvatureNorm = static_cast<float>(sqrtf(curvatureSquared / numComponents) / probeStepSize);
+
+			const float maxNorm = std::max(ratesNorm, curvatureNorm);
+			const Scalar orderStepSize = (maxNorm <= 1.0e-15f) ? std::max(Scalar(1.0e-6), probeStepSize * Scalar(1.0e-3))
+				: Scalar(powf(0.01f / maxNorm, 1.0f / (Tableau::order + 1)));
+			return ClampStepSize(std::min(Scalar(100) * probeStepSize, orderStepSize));
+		}
+
+		AdaptiveSettings m_settings;
+		AdaptiveStats m_stats;
+		Scalar m_stepSize = Scalar(0);
+		float m_prevErrorNorm = 1.0f;
+		Scalar m_time = Scalar(0);
+	};
+};
\ No newline at end of file
@@ -0,0 +1,312 @@
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+
+
+namespace ODEBatch
+{
+	// Structure-of-arrays state for many independent systems.  Each derivative order is stored as one
+	// contiguous array across the whole batch, and the nth derivative is evaluated for every system in
+	// a single call so the methods below cost one virtual call per stage rather than per system.
+	template<typename T, unsigned int N>
+	class IState
+	{
+	public:
+		static_assert(N > 0);
+
+		virtual ~IState() {}
+		virtual void GetNthDerivatives(const std::array<const T*, N>& derivatives, T* nthDerivatives) const = 0;
+
+		void Resize(size_t size)
+		{
+			m_size = size;
+			for (std::vector<T>& derivative : m_derivatives)
+				derivative.resize(size);
+		}
+
+		size_t GetSize() const
+		{
+			return m_size;
+		}
+
+		T* GetDerivatives(unsigned int index)
+		{
+			return m_derivatives[index].data();
+		}
+
+		const T* GetDerivatives(unsigned int index) const
+		{
+			return m_derivatives[index].data();
+		}
+
+		std::array<const T*, N> GetAllDerivatives() const
+		{
+			std::array<const T*, N> derivatives;
+			for (unsigned int i = 0; i < N; ++i)
+				derivatives[i] = m_derivatives[i].data();
+			return derivatives;
+		}
+
+		// returns numArrays contiguous arrays of batch size which stay valid until the next call
+		T* GetScratch(unsigned int numArrays)
+		{
+			const size_t scratchSize = numArrays * m_size;
+			if (m_scratch.size() < scratchSize)
+				m_scratch.resize(scratchSize);
+			return m_scratch.data();
+		}
+
+	private:
+		std::array<std::vector<T>, N> m_derivatives;
+		std::vector<T> m_scratch;
+		size_t m_size = 0;
+	};
+
+
+	// 1ST ORDER
+
+	template<typename T, unsigned int N>
+	void ExplicitEuler(IState<T, N>& state, T stepSize)
+	{
+		const size_t size = state.GetSize();
+		T* __restrict nthDerivatives = state.GetScratch(1);
+		state.GetNthDerivatives(state.GetAllDerivatives(), nthDerivatives);
+
+		for (unsigned int i = 0; i < N - 1; ++i)
+		{
+			T* __restrict derivatives = state.GetDerivatives(i);
+			const T* __restrict nextDerivatives = state.GetDerivatives(i + 1);
+			for (size_t j = 0; j < size; ++j)
+				derivatives[j] += nextDerivatives[j] * stepSize;
+		}
+
+		T* __restrict lastDerivatives = state.GetDerivatives(N - 1);
+		for (size_t j = 0; j < size; ++j)
+			lastDerivatives[j] += nthDerivatives[j] * stepSize;
+	}
+
+
+	template<typename T, unsigned int N>
+	void SemiImplicitEuler(IState<T, N>& state, T stepSize)
+	{
+		const size_t size = state.GetSize();
+		T* __restrict nthDerivatives = state.GetScratch(1);
+		state.GetNthDerivatives(state.GetAllDerivatives(), nthDerivatives);
+
+		T* __restrict lastDerivatives = state.GetDerivatives(N - 1);
+		for (size_t j = 0; j < size; ++j)
+			lastDerivatives[j] += nthDerivatives[j] * stepSize;
+
+		for (int i = N - 2; i >= 0; --i)
+		{
+			T* __restrict derivatives = state.GetDerivatives(i);
+			const T* __restrict nextDerivatives = state.GetDerivatives(i + 1);
+			for (size_t j = 0; j < size; ++j)
+				derivatives[j] += nextDerivatives[j] * stepSize;
+		}
+	}
+
+
+	// 2ND ORDER
+
+	template<typename T, unsigned int N>
+	void ExplicitMidpoint(IState<T, N>& state, T stepSize)
+	{
+		// scratch layout: [0, N) midpoint data, N nth derivative
+		const size_t size = state.GetSize();
+		T* scratch = state.GetScratch(N + 1);
+		T* __restrict nthDerivatives = scratch + N * size;
+
+		std::array<const T*, N> dataMid;
+		for (unsigned int i = 0; i < N; ++i)
+			dataMid[i] = scratch + i * size;
+
+		const T halfStepSize = T(0.5) * stepSize;
+
+		state.GetNthDerivatives(state.GetAllDerivatives(), nthDerivatives);
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			T* __restrict mid = scratch + i * size;
+			const T* __restrict derivatives = state.GetDerivatives(i);
+			const T* __restrict k1 = (i < N - 1) ? state.GetDerivatives(i + 1) : nthDerivatives;
+			for (size_t j = 0; j < size; ++j)
+				mid[j] = derivatives[j] + k1[j] * halfStepSize;
+		}
+
+		state.GetNthDerivatives(dataMid, nthDerivatives);
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			T* __restrict derivatives = state.GetDerivatives(i);
+			const T* __restrict k2 = (i < N - 1) ? dataMid[i + 1] : nthDerivatives;
+			for (size_t j = 0; j < size; ++j)
+				derivatives[j] += k2[j] * stepSize;
+		}
+	}
+
+
+	template<typename T>
+	void VelocityVerlet(IState<T, 2>& state, T stepSize)
+	{
+		const size_t size = state.GetSize();
+		T* scratch = state.GetScratch(2);
+		T* __restrict nthDerivatives0 = scratch;
+		T* __restrict nthDerivatives1 = scratch + size;
+		T* __restrict positions = state.GetDerivatives(0);
+		T* __restrict speeds = state.GetDerivatives(1);
+
+		state.GetNthDerivatives(state.GetAllDerivatives(), nthDerivatives0);
+		for (size_t j = 0; j < size; ++j)
+			positions[j] += speeds[j] * stepSize + nthDerivatives0[j] * stepSize * stepSize * T(0.5);
+
+		state.GetNthDerivatives(state.GetAllDerivatives(), nthDerivatives1);
+		for (size_t j = 0; j < size; ++j)
+			speeds[j] += (nthDerivatives0[j] + nthDerivatives1[j]) * stepSize * T(0.5);
+	}
+
+
+	// 4TH ORDER
+
+	template<typename T, unsigned int N>
+	void ExplicitRK4(IState<T, N>& state, T stepSize)
+	{
+		// scratch layout: [0, 4N) k1..k4, [4N, 5N) estimate data
+		const size_t size = state.GetSize();
+		T* scratch = state.GetScratch(5 * N);
+		const auto k = [scratch, size](unsigned int stage, unsigned int i) -> T* { return scratch + (stage * N + i) * size; };
+
+		std::array<const T*, N> estimateData;
+		for (unsigned int i = 0; i < N; ++i)
+			estimateData[i] = scratch + (4 * N + i) * size;
+
+		const T halfStepSize = T(0.5) * stepSize;
+		const T stageScales[3] = { halfStepSize, halfStepSize, stepSize };
+
+		// k1
+		for (unsigned int i = 0; i < N - 1; ++i)
+		{
+			T* __restrict k1 = k(0, i);
+			const T* __restrict nextDerivatives = state.GetDerivatives(i + 1);
+			for (size_t j = 0; j < size; ++j)
+				k1[j] = nextDerivatives[j];
+		}
+		state.GetNthDerivatives(state.GetAllDerivatives(), k(0, N - 1));
+
+		// k2..k4 evaluated at estimates built from the previous stage
+		for (unsigned int stage = 1; stage < 4; ++stage)
+		{
+			const T scale = stageScales[stage - 1];
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				T* __restrict estimate = scratch + (4 * N + i) * size;
+				const T* __restrict derivatives = state.GetDerivatives(i);
+				const T* __restrict kPrev = k(stage - 1, i);
+				for (size_t j = 0; j < size; ++j)
+					estimate[j] = derivatives[j] + kPrev[j] * scale;
+			}
+
+			for (unsigned int i = 0; i < N - 1; ++i)
+			{
+				T* __restrict kStage = k(stage, i);
+				const T* __restrict k1 = k(0, i);
+				const T* __restrict kPrevNext = k(stage - 1, i + 1);
+				for (size_t j = 0; j < size; ++j)
+					kStage[j] = k1[j] + kPrevNext[j] * scale;
+			}
+			state.GetNthDerivatives(estimateData, k(stage, N - 1));
+		}
+
+		constexpr T sixth = T(1) / T(6);
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			T* __restrict derivatives = state.GetDerivatives(i);
+			const T* __restrict k1 = k(0, i);
+			const T* __restrict k2 = k(1, i);
+			const T* __restrict k3 = k(2, i);
+			const T* __restrict k4 = k(3, i);
+			for (size_t j = 0; j < size; ++j)
+				derivatives[j] += (k1[j] + k2[j] * T(2) + k3[j] * T(2) + k4[j]) * sixth * stepSize;
+		}
+	}
+
+
+	template<typename T>
+	void Ruth4(IState<T, 2>& state, T stepSize)
+	{
+		constexpr T twoToThird = static_cast<T>(1.2599210498948731647672106L);
+		constexpr T ratio = T(1) / (T(2) - twoToThird);
+		constexpr T c[4] = { T(0.5) * ratio, T(0.5) * (T(1) - twoToThird) * ratio, T(0.5) * (T(1) - twoToThird) * ratio, T(0.5) * ratio };
+		constexpr T d[4] = { T(0), ratio, -twoToThird * ratio, ratio };
+
+		const size_t size = state.GetSize();
+		T* __restrict nthDerivatives = state.GetScratch(1);
+		T* __restrict positions = state.GetDerivatives(0);
+		T* __restrict speeds = state.GetDerivatives(1);
+
+		for (size_t j = 0; j < size; ++j)
+			positions[j] += speeds[j] * c[0] * stepSize;
+
+		for (int i = 1; i < 4; ++i)
+		{
+			state.GetNthDerivatives(state.GetAllDerivatives(), nthDerivatives);
+			for (size_t j = 0; j < size; ++j)
+			{
+				speeds[j] += nthDerivatives[j] * d[i] * stepSize;
+				positions[j] += speeds[j] * c[i] * stepSize;
+			}
+		}
+	}
+
+
+	// EXACT
+
+	// Advances every system by the transition matrix of a linear system, given as e^(A dt) - I like
+	// ODE::TransitionMatrix stores it, so all of the batch must share the dynamics it was built from.
+	// The rows and columns are ordered by derivative then component, and each derivative array holds
+	// every system's first component followed by every system's second and so on.  Each row of the
+	// product is a run of multiply-adds across the batch.
+	template<typename T, unsigned int N>
+	void TransitionMatrixStep(IState<T, N>& state, const T* transitionMatrix, unsigned int numComponents)
+	{
+		// scratch layout: [0, N) next derivatives
+		const size_t size = state.GetSize();
+		const size_t numSystems = size / numComponents;
+		const unsigned int matrixSize = N * numComponents;
+		T* scratch = state.GetScratch(N);
+
+		// in blocks of systems so the inputs stay in cache across the rows
+		constexpr size_t blockSize = 512;
+		for (size_t blockStart = 0; blockStart < numSystems; blockStart += blockSize)
+		{
+			const size_t blockEnd = std::min(blockStart + blockSize, numSystems);
+			for (unsigned int row = 0; row < matrixSize; ++row)
+			{
+				const size_t rowOffset = (row % numComponents) * numSystems;
+				T* __restrict next = scratch + (row / numComponents) * size + rowOffset;
+				const T* __restrict current = state.GetDerivatives(row / numComponents) + rowOffset;
+				for (size_t j = blockStart; j < blockEnd; ++j)
+					next[j] = current[j];
+
+				for (unsigned int column = 0; column < matrixSize; ++column)
+				{
+					const T weight = transitionMatrix[row * matrixSize + column];
+					const T* __restrict derivatives = state.GetDerivatives(column / numComponents) + (column % numComponents) * numSystems;
+					for (size_t j = blockStart; j < blockEnd; ++j)
+						next[j] += weight * derivatives[j];
+				}
+			}
+		}
+
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			T* __restrict derivatives = state.GetDerivatives(i);
+			const T* __restrict next = scratch + i * size;
+			for (size_t j = 0; j < size; ++j)
+				derivatives[j] = next[j];
+		}
+	}
+};
\ No newline at end of file
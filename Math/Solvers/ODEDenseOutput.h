@@ -0,0 +1,131 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+
+
+namespace ODE
+{
+	// the cubic Hermite curve between two states and their rates a step apart, at t from 0 to 1 across the step
+	template<typename T, unsigned int N>
+	void HermiteInterpolate(const std::array<T, N>& derivatives0, const std::array<T, N>& rates0, const std::array<T, N>& derivatives1, const std::array<T, N>& rates1,
+		ScalarType<T> stepSize, ScalarType<T> t, std::array<T, N>& derivatives)
+	{
+		typedef ScalarType<T> Scalar;
+
+		const Scalar t2 = t * t;
+		const Scalar t3 = t2 * t;
+
+		const Scalar weight0 = Scalar(2) * t3 - Scalar(3) * t2 + Scalar(1);
+		const Scalar weight1 = Scalar(-2) * t3 + Scalar(3) * t2;
+		const Scalar rateWeight0 = (t3 - Scalar(2) * t2 + t) * stepSize;
+		const Scalar rateWeight1 = (t3 - t2) * stepSize;
+
+		for (unsigned int i = 0; i < N; ++i)
+			derivatives[i] = derivatives0[i] * weight0 + derivatives1[i] * weight1 + rates0[i] * rateWeight0 + rates1[i] * rateWeight1;
+	}
+
+
+	// Continuous trajectory built from the state and its rates at the end of every step.  Between two nodes
+	// the state is a cubic Hermite curve, which is 3rd order accurate and continuous in both the state and
+	// its rate, so the trajectory can be sampled at any time without evaluating the derivative function.
+	template<typename T, unsigned int N>
+	class DenseOutput
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		void Clear()
+		{
+			m_times.clear();
+			m_derivatives.clear();
+			m_rates.clear();
+		}
+
+		// nodes must be added in increasing time, a node at the same time as the last one replaces it
+		void AddNode(Scalar time, const std::array<T, N>& derivatives, const std::array<T, N>& rates)
+		{
+			if (!m_times.empty() && time <= m_times.back())
+			{
+				m_derivatives.back() = derivatives;
+				m_rates.back() = rates;
+				return;
+			}
+
+			m_times.push_back(time);
+			m_derivatives.push_back(derivatives);
+			m_rates.push_back(rates);
+		}
+
+		// for methods that don't expose their rates, costs one evaluation of the nth derivative
+		template<typename State>
+		void AddNode(Scalar time, const State& state)
+		{
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+
+			std::array<T, N> rates;
+			EvaluateDerivatives<T, N>(state, derivatives, rates);
+			AddNode(time, derivatives, rates);
+		}
+
+		size_t GetNumNodes() const
+		{
+			return m_times.size();
+		}
+
+		Scalar GetStartTime() const
+		{
+			return m_times.empty() ? Scalar(0) : m_times.front();
+		}
+
+		Scalar GetEndTime() const
+		{
+			return m_times.empty() ? Scalar(0) : m_times.back();
+		}
+
+		// Times outside the trajectory are clamped to its ends.  hint holds the interval found by the last
+		// query so sampling in increasing time only ever walks forwards.
+		void Evaluate(Scalar time, std::array<T, N>& derivatives, size_t& hint) const
+		{
+			const size_t numNodes = m_times.size();
+			if (numNodes == 0)
+				return;
+
+			if (numNodes == 1 || time <= m_times.front())
+			{
+				derivatives = m_derivatives.front();
+				return;
+			}
+
+			if (time >= m_times.back())
+			{
+				derivatives = m_derivatives.back();
+				return;
+			}
+
+			if (hint >= numNodes - 1 || time < m_times[hint])
+				hint = 0;
+			while (time >= m_times[hint + 1])
+				++hint;
+
+			const Scalar stepSize = m_times[hint + 1] - m_times[hint];
+			HermiteInterpolate<T, N>(m_derivatives[hint], m_rates[hint], m_derivatives[hint + 1], m_rates[hint + 1], stepSize, (time - m_times[hint]) / stepSize, derivatives);
+		}
+
+		void Evaluate(Scalar time, std::array<T, N>& derivatives) const
+		{
+			size_t hint = 0;
+			Evaluate(time, derivatives, hint);
+		}
+
+	private:
+		std::vector<Scalar> m_times;
+		std::vector<std::array<T, N>> m_derivatives;
+		std::vector<std::array<T, N>> m_rates;
+	};
+};
\ No newline at end of file
@@ -0,0 +1,311 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include "Solvers/ODEDenseOutput.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+
+
+namespace ODE
+{
+	enum class EEventDirection : unsigned int
+	{
+		Any,
+		Rising,				// from negative to positive
+		Falling
+	};
+
+
+	enum class EEventAction : unsigned int
+	{
+		Record,				// only added to the records
+		Terminate,			// the step is cut at the event and no further steps are taken
+		Restart				// the step is cut at the event and the restart function may change the state
+	};
+
+
+	template<typename Scalar>
+	struct EventRecord
+	{
+		Scalar m_time = Scalar(0);
+		unsigned int m_index = 0;
+	};
+
+
+	// the default restart function, which leaves the state as it is
+	struct NoRestart
+	{
+		template<typename Derivatives>
+		void operator()(unsigned int index, Derivatives& derivatives) const
+		{
+		}
+	};
+
+
+	// Watches M event functions of the state across the steps of any method, where an event is a zero
+	// crossing of one of them.  The function returns all M values at once from the chained derivatives, so
+	// a step where nothing crosses costs one call and M sign tests.  Only when a sign changes are the rates
+	// at both ends evaluated, and the crossing is then located on the cubic Hermite curve of the step (as
+	// DenseOutput uses) by secant iterations kept inside the bracket with the Illinois modification, so it
+	// costs no further derivative evaluations.  A terminal or restart event then retakes the step with the
+	// method up to just before the crossing, so the state keeps the order of the method.
+	template<typename T, unsigned int N, unsigned int M, typename EventFunction>
+	class EventLocator
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		static constexpr unsigned int maxIterations = 32;
+
+		EventLocator(const EventFunction& function)
+			: m_function(function)
+		{
+			m_directions.fill(EEventDirection::Any);
+			m_actions.fill(EEventAction::Record);
+		}
+
+		void SetEvent(unsigned int index, EEventDirection direction, EEventAction action)
+		{
+			m_directions[index] = direction;
+			m_actions[index] = action;
+		}
+
+		// crossings are located to within this fraction of the step size
+		void SetTolerance(Scalar tolerance)
+		{
+			m_tolerance = tolerance;
+		}
+
+		// Takes one step of the method, returning the time actually advanced which is less than the step size
+		// when a terminal or restart event cut it.  The restart function is called with the index of the
+		// event and the state at it, and may move the state off the crossing or reverse its direction.  The
+		// state is left just before the crossing, so when the restart leaves it heading the same way the
+		// event is latched and the same crossing isn't reported again on the next step.
+		template<typename State, typename Method, typename RestartFunction = NoRestart>
+		Scalar Step(State& state, const Method& method, Scalar stepSize, const RestartFunction& restart = RestartFunction())
+		{
+			if (m_isTerminated)
+				return Scalar(0);
+
+			std::array<T, N> derivatives0;
+			state.GetDerivatives(derivatives0);
+			if (!m_hasValues)
+			{
+				m_values = m_function(derivatives0);
+				m_hasValues = true;
+			}
+
+			method(state, stepSize);
+
+			std::array<T, N> derivatives1;
+			state.GetDerivatives(derivatives1);
+			const std::array<Scalar, M> values1 = m_function(derivatives1);
+
+			// a latch only covers the step straight after its restart
+			const std::array<bool, M> isLatched = m_isLatched;
+			m_isLatched.fill(false);
+
+			bool isCrossed = false;
+			for (unsigned int i = 0; i < M; ++i)
+				isCrossed |= !isLatched[i] && IsCrossing(i, m_values[i], values1[i]);
+
+			if (!isCrossed)
+			{
+				m_values = values1;
+				AdvanceTime(stepSize);
+				return stepSize;
+			}
+
+			std::array<T, N> rates0;
+			std::array<T, N> rates1;
+			EvaluateDerivatives<T, N>(state, derivatives0, rates0);
+			EvaluateDerivatives<T, N>(state, derivatives1, rates1);
+
+			// the earliest terminal or restart event cuts the step, events after it are dropped as the
+			// state they crossed in is no longer the one we continue from
+			std::array<Crossing, M> crossings;
+			unsigned int numCrossings = 0;
+			for (unsigned int i = 0; i < M; ++i)
+			{
+				if (!isLatched[i] && IsCrossing(i, m_values[i], values1[i]))
+					crossings[numCrossings++] = Locate(i, derivatives0, rates0, derivatives1, rates1, values1[i], stepSize);
+			}
+			std::sort(crossings.begin(), crossings.begin() + numCrossings, [](const Crossing& lhs, const Crossing& rhs) { return lhs.m_time < rhs.m_time; });
+
+			for (unsigned int c = 0; c < numCrossings; ++c)
+			{
+				const Crossing& crossing = crossings[c];
+				m_records.push_back({ m_time + crossing.m_time, crossing.m_index });
+
+				const EEventAction action = m_actions[crossing.m_index];
+				if (action == EEventAction::Record)
+					continue;
+
+				// retake the step to the side of the crossing the state started on
+				state.SetDerivatives(derivatives0);
+				if (crossing.m_startTime > Scalar(0))
+					method(state, crossing.m_startTime);
+
+				if (action == EEventAction::Restart)
+				{
+					std::array<T, N> derivatives;
+					state.GetDerivatives(derivatives);
+					restart(crossing.m_index, derivatives);
+					state.SetDerivatives(derivatives);
+				}
+
+				std::array<T, N> derivatives;
+				state.GetDerivatives(derivatives);
+				const std::array<Scalar, M> values = m_function(derivatives);
+				if (action == EEventAction::Restart)
+					m_isLatched[crossing.m_index] = (values[crossing.m_index] > Scalar(0)) == (m_values[crossing.m_index] > Scalar(0));
+
+				m_values = values;
+				AdvanceTime(crossing.m_startTime);
+				m_isTerminated = (action == EEventAction::Terminate);
+				return crossing.m_startTime;
+			}
+
+			m_values = values1;
+			AdvanceTime(stepSize);
+			return stepSize;
+		}
+
+		// Steps until duration is reached or a terminal event fires, the last step is clipped to land on
+		// duration.  Restarts can cut steps to nothing, but each one latches its event, so more empty steps in
+		// a row than there are events means the run can't advance and it stops there.
+		template<typename State, typename Method, typename RestartFunction = NoRestart>
+		void Integrate(State& state, const Method& method, Scalar stepSize, Scalar duration, const RestartFunction& restart = RestartFunction())
+		{
+			const Scalar endTime = m_time + duration;
+			unsigned int numEmptySteps = 0;
+			while (!m_isTerminated && m_time < endTime && stepSize > Scalar(0))
+			{
+				const Scalar remaining = endTime - m_time;
+				const bool isClipped = stepSize * Scalar(1.00001) >= remaining;
+				const Scalar stepTaken = Step(state, method, isClipped ? remaining : stepSize, restart);
+				numEmptySteps = (stepTaken > Scalar(0)) ? 0 : numEmptySteps + 1;
+				if (numEmptySteps > M)
+					break;
+
+				if (isClipped && stepTaken == remaining)
+				{
+					m_time = endTime;
+					m_timeCompensation = Scalar(0);
+				}
+			}
+		}
+
+		// forgets the event values, call after changing the state outside of Step
+		void Reset(Scalar time = Scalar(0))
+		{
+			m_time = time;
+			m_timeCompensation = Scalar(0);
+			m_hasValues = false;
+			m_isTerminated = false;
+			m_isLatched.fill(false);
+			m_records.clear();
+		}
+
+		const std::vector<EventRecord<Scalar>>& GetRecords() const { return m_records; }
+		Scalar GetTime() const { return m_time; }
+		bool IsTerminated() const { return m_isTerminated; }
+
+	private:
+		struct Crossing
+		{
+			Scalar m_time = Scalar(0);			// best estimate of the zero
+			Scalar m_startTime = Scalar(0);		// the end of the final bracket on the starting side
+			unsigned int m_index = 0;
+		};
+
+		// Kahan summation, so the event times of long runs of small steps don't pick up the rounding of
+		// every step
+		void AdvanceTime(Scalar duration)
+		{
+			const Scalar correctedDuration = duration - m_timeCompensation;
+			const Scalar time = m_time + correctedDuration;
+			m_timeCompensation = (time - m_time) - correctedDuration;
+			m_time = time;
+		}
+
+		// a value that lands exactly on zero counts as crossed, so the next step starting from zero doesn't
+		// report it again
+		bool IsCrossing(unsigned int index, Scalar value0, Scalar value1) const
+		{
+			const bool isRising = (value0 < Scalar(0)) && (value1 >= Scalar(0));
+			const bool isFalling = (value0 > Scalar(0)) && (value1 <= Scalar(0));
+			switch (m_directions[index])
+			{
+			case EEventDirection::Rising: return isRising;
+			case EEventDirection::Falling: return isFalling;
+			default: return isRising || isFalling;
+			}
+		}
+
+		Crossing Locate(unsigned int index, const std::array<T, N>& derivatives0, const std::array<T, N>& rates0, const std::array<T, N>& derivatives1, const std::array<T, N>& rates1,
+			Scalar value1, Scalar stepSize) const
+		{
+			// a is on the starting side and b on the crossed side, the values used for the secant are
+			// halved on the side which stays put twice in a row so the bracket keeps shrinking from both ends
+			Scalar a = Scalar(0);
+			Scalar b = stepSize;
+			Scalar valueA = m_values[index];
+			Scalar valueB = value1;
+			Scalar secantValueA = valueA;
+			Scalar secantValueB = valueB;
+			const bool isStartPositive = valueA > Scalar(0);
+			int lastSide = 0;
+
+			const Scalar tolerance = m_tolerance * stepSize;
+			std::array<T, N> derivatives;
+			for (unsigned int iteration = 0; iteration < maxIterations && b - a > tolerance; ++iteration)
+			{
+				Scalar t = b - secantValueB * (b - a) / (secantValueB - secantValueA);
+				if (!(t > a && t < b))
+					t = Scalar(0.5) * (a + b);
+
+				HermiteInterpolate<T, N>(derivatives0, rates0, derivatives1, rates1, stepSize, t / stepSize, derivatives);
+				const Scalar value = m_function(derivatives)[index];
+
+				if (isStartPositive ? (value <= Scalar(0)) : (value >= Scalar(0)))
+				{
+					b = t;
+					valueB = secantValueB = value;
+					if (lastSide == -1)
+						secantValueA *= Scalar(0.5);
+					lastSide = -1;
+				}
+				else
+				{
+					a = t;
+					valueA = secantValueA = value;
+					if (lastSide == 1)
+						secantValueB *= Scalar(0.5);
+					lastSide = 1;
+				}
+			}
+
+			Crossing crossing;
+			crossing.m_index = index;
+			crossing.m_startTime = a;
+			crossing.m_time = (valueA != valueB) ? a + (b - a) * valueA / (valueA - valueB) : b;
+			return crossing;
+		}
+
+		EventFunction m_function;
+		std::array<EEventDirection, M> m_directions;
+		std::array<EEventAction, M> m_actions;
+		std::array<Scalar, M> m_values;
+		std::array<bool, M> m_isLatched = {};		// restarted at the end of the last step without leaving its side
+		std::vector<EventRecord<Scalar>> m_records;
+		Scalar m_tolerance = Scalar(1.0e-5);
+		Scalar m_time = Scalar(0);
+		Scalar m_timeCompensation = Scalar(0);
+		bool m_hasValues = false;
+		bool m_isTerminated = false;
+	};
+};
\ No newline at end of file
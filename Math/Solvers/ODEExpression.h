@@ -0,0 +1,95 @@
+#pragma once
+
+
+#include <type_traits>
+
+
+
+namespace ODE
+{
+	// Lazy element wise arithmetic for fixed size vector states.  Sums and scalings only build a small tree
+	// of nodes, which is evaluated one component at a time when it is assigned to a state, so a combination
+	// like (k1 + k2 * 2 + k3 * 2 + k4) * h / 6 runs as a single loop with no temporary states.  Each
+	// component goes through the same operations in the same order as it would eagerly, so the results are
+	// identical.  Inner nodes are held by value and states by reference, so an expression shouldn't be kept
+	// past the statement the states it reads from live in.
+	//
+	// A state takes part by deriving from Expression, defining Scalar, size and operator[], and setting
+	// isLeaf.
+	template<typename E>
+	struct Expression
+	{
+		const E& Derived() const
+		{
+			return static_cast<const E&>(*this);
+		}
+	};
+
+
+	namespace Detail
+	{
+		template<typename E>
+		using ExpressionOperand = std::conditional_t<E::isLeaf, const E&, const E>;
+	};
+
+
+	template<typename L, typename R>
+	struct SumExpression : Expression<SumExpression<L, R>>
+	{
+		typedef typename L::Scalar Scalar;
+		static constexpr unsigned int size = L::size;
+		static constexpr bool isLeaf = false;
+		static_assert(size == R::size);
+
+		Detail::ExpressionOperand<L> m_lhs;
+		Detail::ExpressionOperand<R> m_rhs;
+
+		SumExpression(const L& lhs, const R& rhs)
+			: m_lhs(lhs)
+			, m_rhs(rhs)
+		{
+		}
+
+		Scalar operator [] (unsigned int index) const
+		{
+			return m_lhs[index] + m_rhs[index];
+		}
+	};
+
+
+	template<typename E>
+	struct ScaledExpression : Expression<ScaledExpression<E>>
+	{
+		typedef typename E::Scalar Scalar;
+		static constexpr unsigned int size = E::size;
+		static constexpr bool isLeaf = false;
+
+		Detail::ExpressionOperand<E> m_expression;
+		Scalar m_scale;
+
+		ScaledExpression(const E& expression, Scalar scale)
+			: m_expression(expression)
+			, m_scale(scale)
+		{
+		}
+
+		Scalar operator [] (unsigned int index) const
+		{
+			return m_expression[index] * m_scale;
+		}
+	};
+
+
+	template<typename L, typename R>
+	SumExpression<L, R> operator + (const Expression<L>& lhs, const Expression<R>& rhs)
+	{
+		return SumExpression<L, R>(lhs.Derived(), rhs.Derived());
+	}
+
+
+	template<typename E>
+	ScaledExpression<E> operator * (const Expression<E>& lhs, typename E::Scalar rhs)
+	{
+		return ScaledExpression<E>(lhs.Derived(), rhs);
+	}
+};
\ No newline at end of file
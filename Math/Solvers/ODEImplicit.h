@@ -0,0 +1,496 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include <math.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+
+namespace ODE
+{
+	struct ImplicitSettings
+	{
+		float m_absTolerance = 1.0e-6f;				// newton converges once every update is within tolerance
+		float m_relTolerance = 1.0e-5f;
+		unsigned int m_maxNewtonIterations = 8;
+		float m_maxConvergenceRate = 0.5f;			// slower convergence than this triggers a jacobian refresh
+	};
+
+
+	struct ImplicitStats
+	{
+		unsigned int m_numSteps = 0;
+		unsigned int m_numEvaluations = 0;
+		unsigned int m_numNewtonIterations = 0;
+		unsigned int m_numJacobianUpdates = 0;
+		unsigned int m_numFactorisations = 0;
+		unsigned int m_numConvergenceFailures = 0;
+	};
+
+
+	// whether State gives the jacobian of its nth derivative, see IState
+	template<typename State, typename T, unsigned int N, typename = void>
+	struct HasNthDerivativeJacobian : std::false_type
+	{
+	};
+
+	template<typename State, typename T, unsigned int N>
+	struct HasNthDerivativeJacobian<State, T, N, std::void_t<decltype(std::declval<const State&>().GetNthDerivativeJacobian(std::declval<const std::array<T, N>&>(), std::declval<ScalarType<T>*>()))>>
+		: std::true_type
+	{
+	};
+
+
+	// Solves z = constant + gamma * F(z) where F is the chained derivative function of the state.  Every
+	// implicit method below reduces to this form.  The newton matrix I - gamma * J is LU factorised and kept
+	// between solves, and the jacobian is only rebuilt when newton converges too slowly.
+	template<typename T, unsigned int N>
+	class NewtonSolver
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		NewtonSolver(const ImplicitSettings& settings = ImplicitSettings())
+			: m_settings(settings)
+		{
+		}
+
+		template<typename State>
+		bool Solve(const State& state, const std::array<T, N>& constant, Scalar gamma, std::array<T, N>& estimate)
+		{
+			const unsigned int numComponents = GetNumComponents(estimate[0]);
+			const unsigned int size = N * numComponents;
+			if (size != m_size)
+			{
+				m_size = size;
+				m_hasJacobian = false;
+				m_jacobian.resize(numComponents * size);
+				m_matrix.resize(size * size);
+				m_pivots.resize(size);
+				m_residual.resize(size);
+			}
+
+			bool isJacobianFresh = false;
+			if (!m_hasJacobian)
+			{
+				UpdateJacobian(state, estimate);
+				isJacobianFresh = true;
+			}
+
+			if (!m_isFactorised || gamma != m_factorisedGamma)
+				Factorise(gamma);
+
+			const std::array<T, N> initialEstimate = estimate;
+			while (true)
+			{
+				float prevUpdateNorm = 0.0f;
+				for (unsigned int iteration = 0; iteration < m_settings.m_maxNewtonIterations; ++iteration)
+				{
+					// residual of z - constant - gamma * F(z), negated so the solve returns the update directly
+					std::array<T, N> rates;
+					EvaluateDerivatives<T, N>(state, estimate, rates);
+					++m_stats.m_numEvaluations;
+					++m_stats.m_numNewtonIterations;
+
+					for (unsigned int i = 0; i < N; ++i)
+					{
+						for (unsigned int c = 0; c < numComponents; ++c)
+							m_residual[i * numComponents + c] = GetComponent(constant[i], c) + gamma * GetComponent(rates[i], c) - GetComponent(estimate[i], c);
+					}
+					BackSubstitute(m_residual);
+
+					float updateNorm = 0.0f;
+					for (unsigned int i = 0; i < N; ++i)
+					{
+						for (unsigned int c = 0; c < numComponents; ++c)
+						{
+							const Scalar value = GetComponent(estimate[i], c) + m_residual[i * numComponents + c];
+							SetComponent(estimate[i], c, value);
+							const Scalar scale = m_settings.m_absTolerance + m_settings.m_relTolerance * std::abs(value);
+							updateNorm = std::max(updateNorm, static_cast<float>(std::abs(m_residual[i * numComponents + c]) / scale));
+						}
+					}
+
+					if (updateNorm <= 1.0f)
+						return true;
+
+					if (iteration > 0 && updateNorm > m_settings.m_maxConvergenceRate * prevUpdateNorm)
+						break;
+					prevUpdateNorm = updateNorm;
+				}
+
+				// a fresh jacobian didn't help so give up and keep the last estimate
+				if (isJacobianFresh)
+					break;
+
+				estimate = initialEstimate;
+				UpdateJacobian(state, estimate);
+				Factorise(gamma);
+				isJacobianFresh = true;
+			}
+
+			++m_stats.m_numConvergenceFailures;
+			return false;
+		}
+
+		void Reset()
+		{
+			m_hasJacobian = false;
+			m_isFactorised = false;
+		}
+
+		ImplicitStats& GetStats()
+		{
+			return m_stats;
+		}
+
+		const ImplicitStats& GetStats() const
+		{
+			return m_stats;
+		}
+
+	private:
+		// Only the nth derivative block of the jacobian is needed since the lower derivative rows are identity
+		// blocks.  The state gives the block if it can, otherwise it's estimated with forward differences.
+		template<typename State>
+		void UpdateJacobian(const State& state, const std::array<T, N>& derivatives)
+		{
+			m_hasJacobian = true;
+			m_isFactorised = false;
+			++m_stats.m_numJacobianUpdates;
+
+			if constexpr (HasNthDerivativeJacobian<State, T, N>::value)
+			{
+				if (state.GetNthDerivativeJacobian(derivatives, m_jacobian.data()))
+				{
+					++m_stats.m_numEvaluations;
+					return;
+				}
+			}
+
+			const unsigned int numComponents = m_size / N;
+			const T nthDerivative = state.GetNthDerivative(derivatives);
+			++m_stats.m_numEvaluations;
+
+			// forward differences are most accurate with a perturbation around the square root of the precision
+			const Scalar sqrtEpsilon = std::sqrt(std::numeric_limits<Scalar>::epsilon());
+			std::array<T, N> perturbed = derivatives;
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				for (unsigned int c = 0; c < numComponents; ++c)
+				{
+					const Scalar value = GetComponent(derivatives[i], c);
+					const Scalar perturbation = sqrtEpsilon * std::max(std::abs(value), Scalar(1));
+					SetComponent(perturbed[i], c, value + perturbation);
+
+					const T perturbedNthDerivative = state.GetNthDerivative(perturbed);
+					++m_stats.m_numEvaluations;
+
+					const unsigned int column = i * numComponents + c;
+					for (unsigned int row = 0; row < numComponents; ++row)
+						m_jacobian[row * m_size + column] = (GetComponent(perturbedNthDerivative, row) - GetComponent(nthDerivative, row)) / perturbation;
+
+					SetComponent(perturbed[i], c, value);
+				}
+			}
+		}
+
+		// LU factorisation of I - gamma * J with partial pivoting
+		void Factorise(Scalar gamma)
+		{
+			const unsigned int numComponents = m_size / N;
+			const unsigned int lastBlock = (N - 1) * numComponents;
+
+			std::fill(m_matrix.begin(), m_matrix.end(), Scalar(0));
+			for (unsigned int row = 0; row < m_size; ++row)
+				m_matrix[row * m_size + row] = Scalar(1);
+			for (unsigned int row = 0; row < lastBlock; ++row)
+				m_matrix[row * m_size + row + numComponents] -= gamma;
+			for (unsigned int row = 0; row < numComponents; ++row)
+			{
+				for (unsigned int column = 0; column < m_size; ++column)
+					m_matrix[(lastBlock + row) * m_size + column] -= gamma * m_jacobian[row * m_size + column];
+			}
+
+			for (unsigned int pivot = 0; pivot < m_size; ++pivot)
+			{
+				unsigned int maxRow = pivot;
+				for (unsigned int row = pivot + 1; row < m_size; ++row)
+				{
+					if (std::abs(m_matrix[row * m_size + pivot]) > std::abs(m_matrix[maxRow * m_size + pivot]))
+						maxRow = row;
+				}
+
+				m_pivots[pivot] = maxRow;
+				if (maxRow != pivot)
+				{
+					for (unsigned int column = 0; column < m_size; ++column)
+						std::swap(m_matrix[pivot * m_size + column], m_matrix[maxRow * m_size + column]);
+				}
+
+				const Scalar pivotValue = m_matrix[pivot * m_size + pivot];
+				if (pivotValue == Scalar(0))
+					continue;
+
+				for (unsigned int row = pivot + 1; row < m_size; ++row)
+				{
+					const Scalar factor = m_matrix[row * m_size + pivot] / pivotValue;
+					m_matrix[row * m_size + pivot] = factor;
+					for (unsigned int column = pivot + 1; column < m_size; ++column)
+						m_matrix[row * m_size + column] -= factor * m_matrix[pivot * m_size + column];
+				}
+			}
+
+			m_factorisedGamma = gamma;
+			m_isFactorised = true;
+			++m_stats.m_numFactorisations;
+		}
+
+		void BackSubstitute(std::vector<Scalar>& values) const
+		{
+			for (unsigned int row = 0; row < m_size; ++row)
+				std::swap(values[row], values[m_pivots[row]]);
+
+			for (unsigned int row = 1; row < m_size; ++row)
+			{
+				for (unsigned int column = 0; column < row; ++column)
+					values[row] -= m_matrix[row * m_size + column] * values[column];
+			}
+
+			for (int row = static_cast<int>(m_size) - 1; row >= 0; --row)
+			{
+				for (unsigned int column = row + 1; column < m_size; ++column)
+					values[row] -= m_matrix[row * m_size + column] * values[column];
+				const Scalar pivotValue = m_matrix[row * m_size + row];
+				values[row] = (pivotValue != Scalar(0)) ? values[row] / pivotValue : Scalar(0);
+			}
+		}
+
+		ImplicitSettings m_settings;
+		ImplicitStats m_stats;
+		std::vector<Scalar> m_jacobian;		// nth derivative rows only
+		std::vector<Scalar> m_matrix;		// LU factors of I - gamma * J
+		std::vector<unsigned int> m_pivots;
+		std::vector<Scalar> m_residual;
+		unsigned int m_size = 0;
+		Scalar m_factorisedGamma = Scalar(0);
+		bool m_hasJacobian = false;
+		bool m_isFactorised = false;
+	};
+
+
+	// 1ST ORDER
+
+	template<typename T, unsigned int N>
+	class BackwardEuler
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		BackwardEuler(const ImplicitSettings& settings = ImplicitSettings())
+			: m_solver(settings)
+		{
+		}
+
+		template<typename State>
+		void Step(State& state, Scalar stepSize)
+		{
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+
+			std::array<T, N> nextDerivatives = derivatives;
+			m_solver.Solve(state, derivatives, stepSize, nextDerivatives);
+			++m_solver.GetStats().m_numSteps;
+
+			state.SetDerivatives(nextDerivatives);
+		}
+
+		const ImplicitStats& GetStats() const { return m_solver.GetStats(); }
+
+	private:
+		NewtonSolver<T, N> m_solver;
+	};
+
+
+	// 2ND ORDER
+
+	template<typename T, unsigned int N>
+	class ImplicitMidpoint
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		ImplicitMidpoint(const ImplicitSettings& settings = ImplicitSettings())
+			: m_solver(settings)
+		{
+		}
+
+		template<typename State>
+		void Step(State& state, Scalar stepSize)
+		{
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+
+			// solve for the midpoint then extrapolate through it to the end of the step
+			std::array<T, N> midDerivatives = derivatives;
+			m_solver.Solve(state, derivatives, Scalar(0.5) * stepSize, midDerivatives);
+			++m_solver.GetStats().m_numSteps;
+
+			for (unsigned int i = 0; i < N; ++i)
+				derivatives[i] = midDerivatives[i] * Scalar(2) + derivatives[i] * Scalar(-1);
+
+			state.SetDerivatives(derivatives);
+		}
+
+		const ImplicitStats& GetStats() const { return m_solver.GetStats(); }
+
+	private:
+		NewtonSolver<T, N> m_solver;
+	};
+
+
+	template<typename T, unsigned int N>
+	class Trapezoidal
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		Trapezoidal(const ImplicitSettings& settings = ImplicitSettings())
+			: m_solver(settings)
+		{
+		}
+
+		template<typename State>
+		void Step(State& state, Scalar stepSize)
+		{
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+
+			std::array<T, N> rates;
+			EvaluateDerivatives<T, N>(state, derivatives, rates);
+			++m_solver.GetStats().m_numEvaluations;
+
+			const Scalar halfStepSize = Scalar(0.5) * stepSize;
+			std::array<T, N> constant;
+			for (unsigned int i = 0; i < N; ++i)
+				constant[i] = derivatives[i] + rates[i] * halfStepSize;
+
+			std::array<T, N> nextDerivatives = derivatives;
+			m_solver.Solve(state, constant, halfStepSize, nextDerivatives);
+			++m_solver.GetStats().m_numSteps;
+
+			state.SetDerivatives(nextDerivatives);
+		}
+
+		const ImplicitStats& GetStats() const { return m_solver.GetStats(); }
+
+	private:
+		NewtonSolver<T, N> m_solver;
+	};
+
+
+	// VARIABLE ORDER
+
+	// Backward differentiation formulae.  The order ramps up from 1 to the maximum order as history builds,
+	// and the history restarts whenever the step size changes or the state was modified outside the method.
+	template<typename T, unsigned int N>
+	class BDF
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		static constexpr unsigned int maxSupportedOrder = 4;
+
+		BDF(unsigned int maxOrder = maxSupportedOrder, const ImplicitSettings& settings = ImplicitSettings())
+			: m_solver(settings)
+			, m_maxOrder(std::clamp(maxOrder, 1u, maxSupportedOrder))
+		{
+		}
+
+		template<typename State>
+		void Step(State& state, Scalar stepSize)
+		{
+			// y[n+1] = sum(alpha[j] * y[n-j]) + beta * h * F(y[n+1])
+			constexpr Scalar alpha[maxSupportedOrder][maxSupportedOrder] = {
+				{ Scalar(1), Scalar(0), Scalar(0), Scalar(0) },
+				{ Scalar(4) / Scalar(3), Scalar(-1) / Scalar(3), Scalar(0), Scalar(0) },
+				{ Scalar(18) / Scalar(11), Scalar(-9) / Scalar(11), Scalar(2) / Scalar(11), Scalar(0) },
+				{ Scalar(48) / Scalar(25), Scalar(-36) / Scalar(25), Scalar(16) / Scalar(25), Scalar(-3) / Scalar(25) } };
+			constexpr Scalar beta[maxSupportedOrder] = { Scalar(1), Scalar(2) / Scalar(3), Scalar(6) / Scalar(11), Scalar(12) / Scalar(25) };
+
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+
+			if (stepSize != m_stepSize || m_numHistory == 0 || !IsLastResult(derivatives))
+			{
+				m_stepSize = stepSize;
+				m_numHistory = 0;
+			}
+
+			// shift history and add the current state
+			for (unsigned int i = maxSupportedOrder - 1; i > 0; --i)
+				m_history[i] = m_history[i - 1];
+			m_history[0] = derivatives;
+			m_numHistory = std::min(m_numHistory + 1, maxSupportedOrder);
+
+			const unsigned int order = std::min(m_numHistory, m_maxOrder);
+			std::array<T, N> constant;
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				constant[i] = m_history[0][i] * alpha[order - 1][0];
+				for (unsigned int j = 1; j < order; ++j)
+					constant[i] = constant[i] + m_history[j][i] * alpha[order - 1][j];
+			}
+
+			// linear extrapolation gives newton a better starting point once we have enough history
+			std::array<T, N> nextDerivatives = derivatives;
+			if (m_numHistory > 1)
+			{
+				for (unsigned int i = 0; i < N; ++i)
+					nextDerivatives[i] = m_history[0][i] * Scalar(2) + m_history[1][i] * Scalar(-1);
+			}
+
+			m_solver.Solve(state, constant, beta[order - 1] * stepSize, nextDerivatives);
+			++m_solver.GetStats().m_numSteps;
+
+			state.SetDerivatives(nextDerivatives);
+			m_lastDerivatives = nextDerivatives;
+		}
+
+		void Reset()
+		{
+			m_numHistory = 0;
+			m_solver.Reset();
+		}
+
+		const ImplicitStats& GetStats() const { return m_solver.GetStats(); }
+
+	private:
+		bool IsLastResult(const std::array<T, N>& derivatives) const
+		{
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				for (unsigned int c = 0; c < GetNumComponents(derivatives[i]); ++c)
+				{
+					if (GetComponent(derivatives[i], c) != GetComponent(m_lastDerivatives[i], c))
+						return false;
+				}
+			}
+			return true;
+		}
+
+		NewtonSolver<T, N> m_solver;
+		std::array<std::array<T, N>, maxSupportedOrder> m_history;
+		std::array<T, N> m_lastDerivatives;
+		unsigned int m_maxOrder = maxSupportedOrder;
+		unsigned int m_numHistory = 0;
+		Scalar m_stepSize = Scalar(0);
+	};
+};
\ No newline at end of file
@@ -0,0 +1,219 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+
+
+namespace ODE
+{
+	namespace Detail
+	{
+		// result = lhs * rhs for square row major matrices
+		template<typename Scalar>
+		void MultiplyMatrices(const std::vector<Scalar>& lhs, const std::vector<Scalar>& rhs, unsigned int size, std::vector<Scalar>& result)
+		{
+			result.assign(size * size, Scalar(0));
+			for (unsigned int row = 0; row < size; ++row)
+				for (unsigned int inner = 0; inner < size; ++inner)
+				{
+					const Scalar value = lhs[row * size + inner];
+					for (unsigned int column = 0; column < size; ++column)
+						result[row * size + column] += value * rhs[inner * size + column];
+				}
+		}
+
+
+		// e^matrix by scaling and squaring with the diagonal (6, 6) Pade approximant, Golub and Van Loan's
+		// algorithm 11.3.1.  The matrix is scaled until its infinity norm is at most a half, where the
+		// approximant is accurate to around double precision, and the result is squared back up.
+		template<typename Scalar>
+		void MatrixExponential(std::vector<Scalar>& matrix, unsigned int size)
+		{
+			Scalar norm = Scalar(0);
+			for (unsigned int row = 0; row < size; ++row)
+			{
+				Scalar rowSum = Scalar(0);
+				for (unsigned int column = 0; column < size; ++column)
+					rowSum += std::abs(matrix[row * size + column]);
+				norm = std::max(norm, rowSum);
+			}
+
+			const int numSquarings = (norm > Scalar(0.5)) ? static_cast<int>(std::ceil(std::log2(norm / Scalar(0.5)))) : 0;
+			const Scalar scale = std::ldexp(Scalar(1), -numSquarings);
+			for (Scalar& value : matrix)
+				value *= scale;
+
+			// numerator and denominator of the approximant, which only differ in the signs of the odd powers
+			constexpr unsigned int degree = 6;
+			std::vector<Scalar> numerator(size * size, Scalar(0));
+			std::vector<Scalar> denominator(size * size, Scalar(0));
+			for (unsigned int i = 0; i < size; ++i)
+			{
+				numerator[i * size + i] = Scalar(1);
+				denominator[i * size + i] = Scalar(1);
+			}
+
+			std::vector<Scalar> power = matrix;
+			std::vector<Scalar> nextPower;
+			Scalar coefficient = Scalar(1);
+			for (unsigned int k = 1; k <= degree; ++k)
+			{
+				coefficient *= Scalar(degree - k + 1) / Scalar(k * (2 * degree - k + 1));
+				if (k > 1)
+				{
+					MultiplyMatrices(matrix, power, size, nextPower);
+					power.swap(nextPower);
+				}
+
+				const Scalar sign = (k % 2 == 0) ? Scalar(1) : Scalar(-1);
+				for (unsigned int i = 0; i < size * size; ++i)
+				{
+					numerator[i] += coefficient * power[i];
+					denominator[i] += sign * coefficient * power[i];
+				}
+			}
+
+			// solves denominator * result = numerator by gaussian elimination with partial pivoting
+			for (unsigned int pivot = 0; pivot < size; ++pivot)
+			{
+				unsigned int maxRow = pivot;
+				for (unsigned int row = pivot + 1; row < size; ++row)
+					if (std::abs(denominator[row * size + pivot]) > std::abs(denominator[maxRow * size + pivot]))
+						maxRow = row;
+
+				if (maxRow != pivot)
+					for (unsigned int column = 0; column < size; ++column)
+					{
+						std::swap(denominator[pivot * size + column], denominator[maxRow * size + column]);
+						std::swap(numerator[pivot * size + column], numerator[maxRow * size + column]);
+					}
+
+				for (unsigned int row = pivot + 1; row < size; ++row)
+				{
+					const Scalar factor = denominator[row * size + pivot] / denominator[pivot * size + pivot];
+					for (unsigned int column = pivot; column < size; ++column)
+						denominator[row * size + column] -= factor * denominator[pivot * size + column];
+					for (unsigned int column = 0; column < size; ++column)
+						numerator[row * size + column] -= factor * numerator[pivot * size + column];
+				}
+			}
+
+			for (int row = static_cast<int>(size) - 1; row >= 0; --row)
+				for (unsigned int column = 0; column < size; ++column)
+				{
+					Scalar value = numerator[row * size + column];
+					for (unsigned int inner = row + 1; inner < size; ++inner)
+						value -= denominator[row * size + inner] * matrix[inner * size + column];
+					matrix[row * size + column] = value / denominator[row * size + row];
+				}
+
+			for (int i = 0; i < numSquarings; ++i)
+			{
+				MultiplyMatrices(matrix, matrix, size, nextPower);
+				matrix.swap(nextPower);
+			}
+		}
+	};
+
+
+	// Exact stepping for linear time invariant systems, x' = A x where x is the chained derivatives flattened
+	// to their components.  Over a fixed step the exact update is the transition matrix e^(A dt), so it's
+	// computed once for the step size and then every step is a single matrix-vector product.  The only error
+	// left is rounding the matrix and the product.  The matrix is stored as e^(A dt) - I and its product added
+	// to the state, so the rounding of the matrix is relative to the change over a step rather than to the
+	// state, otherwise the same rounding repeated every step would build up into a drift.  A is read off the
+	// system by evaluating it at each unit vector, which is only exact if the system really is linear and has
+	// no constant term.  The matrix is kept until the step size changes, so call Reset if the system's
+	// parameters change.
+	template<typename T, unsigned int N>
+	class TransitionMatrix
+	{
+	public:
+		typedef ScalarType<T> Scalar;
+
+		template<typename State>
+		void Step(State& state, Scalar stepSize)
+		{
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+			if (!m_hasMatrix || stepSize != m_stepSize)
+				Update(state, derivatives, stepSize);
+
+			const unsigned int numComponents = m_size / N;
+			for (unsigned int i = 0; i < N; ++i)
+				for (unsigned int c = 0; c < numComponents; ++c)
+					m_values[i * numComponents + c] = GetComponent(derivatives[i], c);
+
+			for (unsigned int row = 0; row < m_size; ++row)
+			{
+				Scalar change = Scalar(0);
+				for (unsigned int column = 0; column < m_size; ++column)
+					change += m_matrix[row * m_size + column] * m_values[column];
+				SetComponent(derivatives[row / numComponents], row % numComponents, m_values[row] + change);
+			}
+
+			state.SetDerivatives(derivatives);
+		}
+
+		// derivatives are only used for the number of components, their values don't matter
+		template<typename State>
+		void Update(const State& state, const std::array<T, N>& derivatives, Scalar stepSize)
+		{
+			const unsigned int numComponents = GetNumComponents(derivatives[0]);
+			m_size = N * numComponents;
+			m_values.resize(m_size);
+
+			// built in at least double so a float matrix is only rounded once at the end
+			std::vector<Precise> matrix(m_size * m_size);
+			std::array<T, N> unit = derivatives;
+			for (unsigned int i = 0; i < N; ++i)
+				for (unsigned int c = 0; c < numComponents; ++c)
+					SetComponent(unit[i], c, Scalar(0));
+
+			std::array<T, N> rates;
+			for (unsigned int column = 0; column < m_size; ++column)
+			{
+				SetComponent(unit[column / numComponents], column % numComponents, Scalar(1));
+				EvaluateDerivatives<T, N>(state, unit, rates);
+				SetComponent(unit[column / numComponents], column % numComponents, Scalar(0));
+
+				for (unsigned int row = 0; row < m_size; ++row)
+					matrix[row * m_size + column] = static_cast<Precise>(GetComponent(rates[row / numComponents], row % numComponents)) * stepSize;
+			}
+
+			Detail::MatrixExponential(matrix, m_size);
+			for (unsigned int i = 0; i < m_size; ++i)
+				matrix[i * m_size + i] -= Precise(1);
+
+			m_matrix.resize(m_size * m_size);
+			for (unsigned int i = 0; i < m_size * m_size; ++i)
+				m_matrix[i] = static_cast<Scalar>(matrix[i]);
+			m_stepSize = stepSize;
+			m_hasMatrix = true;
+		}
+
+		void Reset()
+		{
+			m_hasMatrix = false;
+		}
+
+		// e^(A dt) - I, row major with the rows and columns ordered by derivative then component
+		const std::vector<Scalar>& GetMatrix() const { return m_matrix; }
+		unsigned int GetSize() const { return m_size; }
+
+	private:
+		typedef std::common_type_t<Scalar, double> Precise;
+
+		std::vector<Scalar> m_matrix;
+		std::vector<Scalar> m_values;
+		unsigned int m_size = 0;
+		Scalar m_stepSize = Scalar(0);
+		bool m_hasMatrix = false;
+	};
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include <array>
+
+
+
+namespace ODE
+{
+	// Keeps the state of a system in the high precision type while its derivative function is evaluated in
+	// the low precision type.  Over long runs most of the error in a low precision state comes from rounding
+	// each small step into the state, which this avoids, while the force evaluation stays at the cheaper
+	// precision and only contributes its rounding once per evaluation scaled by the step size.
+	// The low precision system is kept in sync after every step so it can still be read from directly.
+	template<typename HighT, typename LowT, unsigned int N, typename LowState = IState<LowT, N>>
+	class MixedPrecisionState final : public IState<HighT, N>
+	{
+	public:
+		MixedPrecisionState(LowState& lowState)
+			: m_lowState(lowState)
+		{
+			Pull();
+		}
+
+		// copies the state from the low precision system after it has been reset or changed outside the methods
+		void Pull()
+		{
+			std::array<LowT, N> lowDerivatives;
+			m_lowState.GetDerivatives(lowDerivatives);
+			for (unsigned int i = 0; i < N; ++i)
+				Convert(lowDerivatives[i], m_derivatives[i]);
+		}
+
+		virtual void GetDerivatives(std::array<HighT, N>& derivatives) const override
+		{
+			derivatives = m_derivatives;
+		}
+
+		virtual HighT GetNthDerivative(const std::array<HighT, N>& derivatives) const override
+		{
+			std::array<LowT, N> lowDerivatives;
+			for (unsigned int i = 0; i < N; ++i)
+				Convert(derivatives[i], lowDerivatives[i]);
+
+			HighT nthDerivative = HighT();
+			Convert(m_lowState.GetNthDerivative(lowDerivatives), nthDerivative);
+			return nthDerivative;
+		}
+
+		virtual void SetDerivatives(const std::array<HighT, N>& derivatives) override
+		{
+			m_derivatives = derivatives;
+
+			std::array<LowT, N> lowDerivatives;
+			for (unsigned int i = 0; i < N; ++i)
+				Convert(derivatives[i], lowDerivatives[i]);
+			m_lowState.SetDerivatives(lowDerivatives);
+		}
+
+	private:
+		template<typename From, typename To>
+		static void Convert(const From& from, To& to)
+		{
+			for (unsigned int c = 0; c < GetNumComponents(from); ++c)
+				SetComponent(to, c, static_cast<ScalarType<To>>(GetComponent(from, c)));
+		}
+
+		LowState& m_lowState;
+		std::array<HighT, N> m_derivatives;
+	};
+};
\ No newline at end of file
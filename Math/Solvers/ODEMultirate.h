@@ -0,0 +1,221 @@
+#pragma once
+
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+
+
+namespace ODEMultirate
+{
+	// the components [m_begin, m_end)
+	struct Range
+	{
+		unsigned int m_begin = 0;
+		unsigned int m_end = 0;
+	};
+
+
+	// Second order state stored as arrays of positions and speeds across the components, like ODEBatch.
+	// The accelerations of some of the components can be evaluated on their own, given as ranges so that a
+	// state can sweep each range as it would the whole, which is what lets the slow components be
+	// evaluated less often than the fast.
+	template<typename T>
+	class IState
+	{
+	public:
+		virtual ~IState() {}
+
+		// only the accelerations of the components in the ranges are written
+		virtual void GetAccelerations(const T* positions, const T* speeds, const std::vector<Range>& ranges, T* accelerations) const = 0;
+
+		// the components outside the ranges whose positions or speeds the accelerations of the ranges read
+		virtual void GetCoupledComponents(const std::vector<Range>& ranges, std::vector<unsigned int>& components) const = 0;
+
+		void Resize(size_t size)
+		{
+			m_positions.resize(size);
+			m_speeds.resize(size);
+		}
+
+		size_t GetSize() const { return m_positions.size(); }
+		T* GetPositions() { return m_positions.data(); }
+		const T* GetPositions() const { return m_positions.data(); }
+		T* GetSpeeds() { return m_speeds.data(); }
+		const T* GetSpeeds() const { return m_speeds.data(); }
+
+	private:
+		std::vector<T> m_positions;
+		std::vector<T> m_speeds;
+	};
+
+
+	// evaluations count component accelerations rather than calls, as a call only evaluates a group
+	struct MultirateStats
+	{
+		unsigned int m_numSteps = 0;
+		uint64_t m_numFastEvaluations = 0;
+		uint64_t m_numSlowEvaluations = 0;
+	};
+
+
+	// Velocity Verlet where the fast components take a number of substeps for every step of the slow ones.
+	// Each step kicks the slow components by half a step and drifts them to the end of the step, then
+	// subcycles the fast components with the slow positions they read interpolated linearly across the
+	// step, and finishes the slow kick from the accelerations at the end.  The slow components are only
+	// evaluated once a step and the fast ones once a substep, since the accelerations at the end of a step
+	// are kept for the start of the next, so a few stiff components no longer set the step of all of them.
+	// The interpolation keeps the method second order, but it is no longer exactly symplectic.
+	//
+	// The fast ranges have to be sorted and not overlap, every other component is slow.  No fast ranges
+	// gives plain velocity Verlet.  The kept accelerations are for the state as last stepped, so Reset has
+	// to be called if the state is changed between steps.
+	template<typename T>
+	class MultirateVerlet
+	{
+	public:
+		MultirateVerlet(const std::vector<Range>& fastRanges = std::vector<Range>(), unsigned int numSubSteps = 1)
+			: m_fastRanges(fastRanges)
+			, m_numSubSteps(std::max(numSubSteps, 1u))
+		{
+		}
+
+		void Step(IState<T>& state, T stepSize)
+		{
+			if (!m_hasAccelerations || m_size != state.GetSize())
+			{
+				Partition(state);
+				Evaluate(state, m_fastRanges, m_stats.m_numFastEvaluations);
+				Evaluate(state, m_slowRanges, m_stats.m_numSlowEvaluations);
+				m_hasAccelerations = true;
+			}
+
+			T* __restrict positions = state.GetPositions();
+			T* __restrict speeds = state.GetSpeeds();
+			T* __restrict accelerations = m_accelerations.data();
+			const unsigned int* interface = m_interfaceComponents.data();
+			const size_t numInterface = m_interfaceComponents.size();
+
+			const T halfStepSize = T(0.5) * stepSize;
+			for (const Range& range : m_slowRanges)
+			{
+				for (unsigned int i = range.m_begin; i < range.m_end; ++i)
+					speeds[i] += accelerations[i] * halfStepSize;
+			}
+
+			for (size_t k = 0; k < numInterface; ++k)
+				m_interfaceStart[k] = positions[interface[k]];
+
+			for (const Range& range : m_slowRanges)
+			{
+				for (unsigned int i = range.m_begin; i < range.m_end; ++i)
+					positions[i] += speeds[i] * stepSize;
+			}
+
+			for (size_t k = 0; k < numInterface; ++k)
+				m_interfaceEnd[k] = positions[interface[k]];
+
+			// only the slow positions the fast accelerations read are interpolated
+			const T subStepSize = stepSize / T(m_numSubSteps);
+			const T halfSubStepSize = T(0.5) * subStepSize;
+			for (unsigned int subStep = 0; subStep < m_numSubSteps; ++subStep)
+			{
+				for (const Range& range : m_fastRanges)
+				{
+					for (unsigned int i = range.m_begin; i < range.m_end; ++i)
+					{
+						speeds[i] += accelerations[i] * halfSubStepSize;
+						positions[i] += speeds[i] * subStepSize;
+					}
+				}
+
+				const T fraction = T(subStep + 1) / T(m_numSubSteps);
+				for (size_t k = 0; k < numInterface; ++k)
+					positions[interface[k]] = m_interfaceStart[k] + (m_interfaceEnd[k] - m_interfaceStart[k]) * fraction;
+
+				Evaluate(state, m_fastRanges, m_stats.m_numFastEvaluations);
+				for (const Range& range : m_fastRanges)
+				{
+					for (unsigned int i = range.m_begin; i < range.m_end; ++i)
+						speeds[i] += accelerations[i] * halfSubStepSize;
+				}
+			}
+
+			for (size_t k = 0; k < numInterface; ++k)
+				positions[interface[k]] = m_interfaceEnd[k];
+
+			Evaluate(state, m_slowRanges, m_stats.m_numSlowEvaluations);
+			for (const Range& range : m_slowRanges)
+			{
+				for (unsigned int i = range.m_begin; i < range.m_end; ++i)
+					speeds[i] += accelerations[i] * halfStepSize;
+			}
+
+			++m_stats.m_numSteps;
+		}
+
+		void Reset()
+		{
+			m_hasAccelerations = false;
+			m_stats = MultirateStats();
+		}
+
+		const MultirateStats& GetStats() const
+		{
+			return m_stats;
+		}
+
+	private:
+		// the slow ranges are the gaps between the fast ones
+		void Partition(const IState<T>& state)
+		{
+			m_size = state.GetSize();
+			m_accelerations.resize(m_size);
+
+			m_slowRanges.clear();
+			unsigned int begin = 0;
+			for (const Range& range : m_fastRanges)
+			{
+				if (range.m_begin > begin)
+					m_slowRanges.push_back({ begin, range.m_begin });
+				begin = std::max(begin, range.m_end);
+			}
+			if (begin < m_size)
+				m_slowRanges.push_back({ begin, static_cast<unsigned int>(m_size) });
+
+			const auto isFast = [this](unsigned int component)
+			{
+				const auto range = std::upper_bound(m_fastRanges.begin(), m_fastRanges.end(), component, [](unsigned int value, const Range& range) { return value < range.m_end; });
+				return range != m_fastRanges.end() && range->m_begin <= component;
+			};
+
+			m_interfaceComponents.clear();
+			state.GetCoupledComponents(m_fastRanges, m_interfaceComponents);
+			m_interfaceComponents.erase(std::remove_if(m_interfaceComponents.begin(), m_interfaceComponents.end(), isFast), m_interfaceComponents.end());
+			std::sort(m_interfaceComponents.begin(), m_interfaceComponents.end());
+			m_interfaceComponents.erase(std::unique(m_interfaceComponents.begin(), m_interfaceComponents.end()), m_interfaceComponents.end());
+			m_interfaceStart.resize(m_interfaceComponents.size());
+			m_interfaceEnd.resize(m_interfaceComponents.size());
+		}
+
+		void Evaluate(const IState<T>& state, const std::vector<Range>& ranges, uint64_t& numEvaluations)
+		{
+			state.GetAccelerations(state.GetPositions(), state.GetSpeeds(), ranges, m_accelerations.data());
+			for (const Range& range : ranges)
+				numEvaluations += range.m_end - range.m_begin;
+		}
+
+		std::vector<Range> m_fastRanges;
+		std::vector<Range> m_slowRanges;
+		std::vector<unsigned int> m_interfaceComponents;
+		std::vector<T> m_interfaceStart;
+		std::vector<T> m_interfaceEnd;
+		std::vector<T> m_accelerations;
+		MultirateStats m_stats;
+		size_t m_size = 0;
+		unsigned int m_numSubSteps = 1;
+		bool m_hasAccelerations = false;
+	};
+};
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include "Solvers/ODEAdaptive.h"
+#include <algorithm>
+#include <array>
+#include <math.h>
+#include <vector>
+
+
+
+namespace ODE
+{
+	struct PararealSettings
+	{
+		unsigned int m_numSlices = 32;
+		unsigned int m_coarseStepsPerSlice = 1;
+		unsigned int m_fineStepsPerSlice = 64;
+		unsigned int m_maxIterations = 8;
+		float m_absTolerance = 1.0e-6f;			// the iterations stop once no slice boundary moves by more than this
+		float m_relTolerance = 1.0e-6f;
+	};
+
+
+	struct PararealStats
+	{
+		unsigned int m_numIterations = 0;
+		unsigned int m_numFineSlices = 0;		// slices run with the fine method over all iterations
+		float m_lastCorrection = INFINITY;		// largest scaled move of a boundary in the last iteration, none before the first
+		bool m_isConverged = false;
+	};
+
+
+	// Parallel in time integration of the state over a duration split into slices.  A cheap coarse method
+	// first runs serially across every slice to guess the state at each boundary.  Every iteration then
+	// runs the accurate fine method over all slices in parallel, each from its current boundary guess, and
+	// sweeps the coarse method serially again to correct the boundaries,
+	//
+	//     U[n + 1] = G(U[n]) + F(U_old[n]) - G(U_old[n])
+	//
+	// After k iterations the first k boundaries match a serial run of the fine method, so the iterations
+	// stop at the slice count at the latest, and the slices already exact aren't run again.  The speedup
+	// comes from stopping after far fewer iterations than there are slices.
+	//
+	// The methods are called as method(state, stepSize) on a copy of the state per slice, so the state has
+	// to be copyable and only read from its own copy.  The parallel loop is called as
+	// parallelFor(count, func) and has to run func(index) for every index in [0, count) before returning,
+	// which keeps this free of any particular thread pool.  sliceStates gets the chained derivatives at every
+	// boundary, the last being the state at the end of the duration.
+	template<typename T, unsigned int N, typename State, typename CoarseMethod, typename FineMethod, typename ParallelFor>
+	PararealStats Parareal(const State& state, ScalarType<T> duration, const PararealSettings& settings, const CoarseMethod& coarseMethod, const FineMethod& fineMethod,
+		const ParallelFor& parallelFor, std::vector<std::array<T, N>>& sliceStates)
+	{
+		typedef ScalarType<T> Scalar;
+
+		const unsigned int numSlices = std::max(1u, settings.m_numSlices);
+		const Scalar sliceDuration = duration / numSlices;
+		const Scalar coarseStepSize = sliceDuration / std::max(1u, settings.m_coarseStepsPerSlice);
+		const Scalar fineStepSize = sliceDuration / std::max(1u, settings.m_fineStepsPerSlice);
+
+		const auto propagate = [&state](const auto& method, unsigned int numSteps, Scalar stepSize, const std::array<T, N>& start, std::array<T, N>& end)
+		{
+			State sliceState = state;
+			sliceState.SetDerivatives(start);
+			for (unsigned int step = 0; step < numSteps; ++step)
+				method(sliceState, stepSize);
+			sliceState.GetDerivatives(end);
+		};
+
+		// the coarse result from each boundary is kept for the correction of the next iteration
+		sliceStates.resize(numSlices + 1);
+		std::vector<std::array<T, N>> coarseStates(numSlices);
+		std::vector<std::array<T, N>> fineStates(numSlices);
+		state.GetDerivatives(sliceStates[0]);
+		for (unsigned int slice = 0; slice < numSlices; ++slice)
+		{
+			propagate(coarseMethod, settings.m_coarseStepsPerSlice, coarseStepSize, sliceStates[slice], coarseStates[slice]);
+			sliceStates[slice + 1] = coarseStates[slice];
+		}
+
+		PararealStats stats;
+		for (unsigned int iteration = 0; iteration < settings.m_maxIterations && iteration < numSlices; ++iteration)
+		{
+			// boundaries up to the iteration count are exact, so only the slices after them run again
+			const unsigned int firstSlice = iteration;
+			parallelFor(numSlices - firstSlice, [&](size_t index)
+			{
+				const unsigned int slice = firstSlice + static_cast<unsigned int>(index);
+				propagate(fineMethod, settings.m_fineStepsPerSlice, fineStepSize, sliceStates[slice], fineStates[slice]);
+			});
+			stats.m_numFineSlices += numSlices - firstSlice;
+			++stats.m_numIterations;
+
+			// the first slice starts from an exact boundary, where the coarse terms cancel
+			float maxCorrectionSquared = 0.0f;
+			for (unsigned int slice = firstSlice; slice < numSlices; ++slice)
+			{
+				std::array<T, N> coarseState = coarseStates[slice];
+				if (slice > firstSlice)
+					propagate(coarseMethod, settings.m_coarseStepsPerSlice, coarseStepSize, sliceStates[slice], coarseState);
+
+				float correctionSquared = 0.0f;
+				unsigned int numComponents = 0;
+				for (unsigned int i = 0; i < N; ++i)
+				{
+					const T next = (slice > firstSlice) ? T(coarseState[i] + fineStates[slice][i] + coarseStates[slice][i] * Scalar(-1)) : fineStates[slice][i];
+					const T correction = next + sliceStates[slice + 1][i] * Scalar(-1);
+					correctionSquared += ScaledErrorSquared(correction, next, sliceStates[slice + 1][i], settings.m_absTolerance, settings.m_relTolerance, numComponents);
+					sliceStates[slice + 1][i] = next;
+				}
+				coarseStates[slice] = coarseState;
+
+				// written so a NaN from a coarse step beyond its stability limit is kept
+				if (!(correctionSquared / numComponents <= maxCorrectionSquared))
+					maxCorrectionSquared = correctionSquared / numComponents;
+			}
+
+			stats.m_lastCorrection = sqrtf(maxCorrectionSquared);
+			if (stats.m_lastCorrection <= 1.0f || isnan(stats.m_lastCorrection))
+				break;
+		}
+
+		// every boundary is exact once the iterations reach the slice count, unless the coarse method diverged
+		stats.m_isConverged = (stats.m_lastCorrection <= 1.0f) || (stats.m_numIterations >= numSlices && !isnan(stats.m_lastCorrection));
+		return stats;
+	}
+};
\ No newline at end of file
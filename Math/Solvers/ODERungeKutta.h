@@ -0,0 +1,349 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include "Solvers/ODEDenseOutput.h"
+#include <array>
+#include <type_traits>
+#include <utility>
+
+
+
+namespace ODE
+{
+	// Explicit Butcher tableaus for the generic engine below.  Each weight in b is multiplied by weightScale
+	// after the stages are summed, which lets the classic methods keep their integer weights and reproduce
+	// the hand written versions in ODE.h exactly.  Zero coefficients are skipped at compile time.  The
+	// coefficients are stored at the highest precision and rounded once to the scalar type of the state.
+
+	struct Euler1
+	{
+		static constexpr unsigned int numStages = 1;
+		static constexpr long double a[numStages][numStages] = { { 0.0L } };
+		static constexpr long double b[numStages] = { 1.0L };
+		static constexpr long double weightScale = 1.0L;
+	};
+
+
+	struct Midpoint2
+	{
+		static constexpr unsigned int numStages = 2;
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L },
+			{ 0.5L, 0.0L } };
+		static constexpr long double b[numStages] = { 0.0L, 1.0L };
+		static constexpr long double weightScale = 1.0L;
+	};
+
+
+	struct Kutta3
+	{
+		static constexpr unsigned int numStages = 3;
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L },
+			{ 0.5L, 0.0L, 0.0L },
+			{ -1.0L, 2.0L, 0.0L } };
+		static constexpr long double b[numStages] = { 1.0L, 4.0L, 1.0L };
+		static constexpr long double weightScale = 1.0L / 6.0L;
+	};
+
+
+	// strong stability preserving, a convex combination of explicit Euler steps
+	struct SSPRK3
+	{
+		static constexpr unsigned int numStages = 3;
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L },
+			{ 1.0L, 0.0L, 0.0L },
+			{ 0.25L, 0.25L, 0.0L } };
+		static constexpr long double b[numStages] = { 1.0L, 1.0L, 4.0L };
+		static constexpr long double weightScale = 1.0L / 6.0L;
+	};
+
+
+	struct ClassicRK4
+	{
+		static constexpr unsigned int numStages = 4;
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 0.5L, 0.0L, 0.0L, 0.0L },
+			{ 0.0L, 0.5L, 0.0L, 0.0L },
+			{ 0.0L, 0.0L, 1.0L, 0.0L } };
+		static constexpr long double b[numStages] = { 1.0L, 2.0L, 2.0L, 1.0L };
+		static constexpr long double weightScale = 1.0L / 6.0L;
+	};
+
+
+	struct ThreeEighthsRK4
+	{
+		static constexpr unsigned int numStages = 4;
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 1.0L / 3.0L, 0.0L, 0.0L, 0.0L },
+			{ -1.0L / 3.0L, 1.0L, 0.0L, 0.0L },
+			{ 1.0L, -1.0L, 1.0L, 0.0L } };
+		static constexpr long double b[numStages] = { 1.0L, 3.0L, 3.0L, 1.0L };
+		static constexpr long double weightScale = 1.0L / 8.0L;
+	};
+
+
+	// the 5th order solution of Dormand-Prince 5(4) at a fixed step, the unused 7th stage is never evaluated
+	struct DormandPrince5
+	{
+		static constexpr unsigned int numStages = 7;
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 1.0L / 5.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 3.0L / 40.0L, 9.0L / 40.0L, 0.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 44.0L / 45.0L, -56.0L / 15.0L, 32.0L / 9.0L, 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 19372.0L / 6561.0L, -25360.0L / 2187.0L, 64448.0L / 6561.0L, -212.0L / 729.0L, 0.0L, 0.0L, 0.0L },
+			{ 9017.0L / 3168.0L, -355.0L / 33.0L, 46732.0L / 5247.0L, 49.0L / 176.0L, -5103.0L / 18656.0L, 0.0L, 0.0L },
+			{ 35.0L / 384.0L, 0.0L, 500.0L / 1113.0L, 125.0L / 192.0L, -2187.0L / 6784.0L, 11.0L / 84.0L, 0.0L } };
+		static constexpr long double b[numStages] = { 35.0L / 384.0L, 0.0L, 500.0L / 1113.0L, 125.0L / 192.0L, -2187.0L / 6784.0L, 11.0L / 84.0L, 0.0L };
+		static constexpr long double weightScale = 1.0L;
+	};
+
+
+	// Runge-Kutta-Nystrom tableaus for y'' = f(y, y').  aBar and bBar build the position from the stage
+	// accelerations scaled by h^2 while a and b build the speed scaled by h, so each stage costs a single
+	// evaluation of the nth derivative.
+	struct Nystrom4
+	{
+		static constexpr unsigned int numStages = 4;
+		static constexpr long double c[numStages] = { 0.0L, 0.5L, 0.5L, 1.0L };
+		static constexpr long double aBar[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 1.0L / 8.0L, 0.0L, 0.0L, 0.0L },
+			{ 1.0L / 8.0L, 0.0L, 0.0L, 0.0L },
+			{ 0.0L, 0.0L, 0.5L, 0.0L } };
+		static constexpr long double a[numStages][numStages] = {
+			{ 0.0L, 0.0L, 0.0L, 0.0L },
+			{ 0.5L, 0.0L, 0.0L, 0.0L },
+			{ 0.0L, 0.5L, 0.0L, 0.0L },
+			{ 0.0L, 0.0L, 1.0L, 0.0L } };
+		static constexpr long double bBar[numStages] = { 1.0L / 6.0L, 1.0L / 6.0L, 1.0L / 6.0L, 0.0L };
+		static constexpr long double b[numStages] = { 1.0L / 6.0L, 1.0L / 3.0L, 1.0L / 3.0L, 1.0L / 6.0L };
+	};
+
+
+	namespace Detail
+	{
+		template<typename Func, unsigned int... Indices>
+		void Unroll(Func&& func, std::integer_sequence<unsigned int, Indices...>)
+		{
+			(func(std::integral_constant<unsigned int, Indices>()), ...);
+		}
+
+
+		// calls func with each index in [0, Count) as a compile time constant
+		template<unsigned int Count, typename Func>
+		void Unroll(Func&& func)
+		{
+			Unroll(std::forward<Func>(func), std::make_integer_sequence<unsigned int, Count>());
+		}
+
+
+		// a stage needs evaluating if it contributes to the result or to a later stage that does
+		template<typename Tableau>
+		constexpr bool IsStageUsed(unsigned int stage)
+		{
+			if (Tableau::b[stage] != 0)
+				return true;
+			for (unsigned int later = stage + 1; later < Tableau::numStages; ++later)
+			{
+				if (Tableau::a[later][stage] != 0 && IsStageUsed<Tableau>(later))
+					return true;
+			}
+			return false;
+		}
+
+
+		template<typename Tableau>
+		constexpr unsigned int GetFirstWeightedStage()
+		{
+			unsigned int stage = 0;
+			while (Tableau::b[stage] == 0)
+				++stage;
+			return stage;
+		}
+
+
+		// the first earlier stage that the given stage's estimate depends on
+		template<typename Tableau>
+		constexpr unsigned int GetFirstDependency(unsigned int stage)
+		{
+			unsigned int previous = 0;
+			while (Tableau::a[stage][previous] == 0)
+				++previous;
+			return previous;
+		}
+
+
+		// sums the weighted rates left to right as a single expression so no partial sums are stored, for
+		// states with lazy arithmetic the whole sum is evaluated in the final assignment
+		template<typename Tableau, typename T, unsigned int Stage, typename Rate, typename PartialSum>
+		auto WeightedSumFrom(const Rate& rate, unsigned int i, const PartialSum& partialSum)
+		{
+			if constexpr (Stage == Tableau::numStages)
+				return partialSum;
+			else if constexpr (Tableau::b[Stage] == 0)
+				return WeightedSumFrom<Tableau, T, Stage + 1>(rate, i, partialSum);
+			else if constexpr (Tableau::b[Stage] == 1)
+				return WeightedSumFrom<Tableau, T, Stage + 1>(rate, i, partialSum + rate(std::integral_constant<unsigned int, Stage>(), i));
+			else
+				return WeightedSumFrom<Tableau, T, Stage + 1>(rate, i, partialSum + rate(std::integral_constant<unsigned int, Stage>(), i) * static_cast<ScalarType<T>>(Tableau::b[Stage]));
+		}
+
+
+		template<typename Tableau, typename T, typename Rate>
+		auto WeightedSum(const Rate& rate, unsigned int i)
+		{
+			constexpr unsigned int first = GetFirstWeightedStage<Tableau>();
+			if constexpr (Tableau::b[first] == 1)
+				return WeightedSumFrom<Tableau, T, first + 1>(rate, i, rate(std::integral_constant<unsigned int, first>(), i));
+			else
+				return WeightedSumFrom<Tableau, T, first + 1>(rate, i, rate(std::integral_constant<unsigned int, first>(), i) * static_cast<ScalarType<T>>(Tableau::b[first]));
+		}
+
+
+		template<typename Tableau, typename T, unsigned int N, bool IsRecording, typename State>
+		void ExplicitRungeKuttaStep(State& state, ScalarType<T> stepSize, DenseOutput<T, N>* pDenseOutput, ScalarType<T> time)
+		{
+			static_assert(N > 0);
+			typedef ScalarType<T> Scalar;
+
+			std::array<T, N> derivatives;
+			state.GetDerivatives(derivatives);
+
+			// Stage s is evaluated at estimates[s].  In the chained layout the rate of every entry below the nth is
+			// the next entry of the same estimate, so only the nth derivatives are stored and nothing is copied.
+			std::array<std::array<T, N>, Tableau::numStages> estimates;
+			std::array<T, Tableau::numStages> nthDerivatives;
+			const auto rate = [&](auto stage, unsigned int i) -> const T&
+			{
+				constexpr unsigned int s = decltype(stage)::value;
+				if (i == N - 1)
+					return nthDerivatives[s];
+				if constexpr (s == 0)
+					return derivatives[i + 1];
+				else
+					return estimates[s][i + 1];
+			};
+
+			Unroll<Tableau::numStages>([&](auto stage)
+			{
+				constexpr unsigned int s = decltype(stage)::value;
+				if constexpr (s == 0)
+				{
+					nthDerivatives[0] = state.GetNthDerivative(derivatives);
+					if constexpr (IsRecording)
+					{
+						std::array<T, N> rates;
+						for (unsigned int i = 0; i < N; ++i)
+							rates[i] = rate(stage, i);
+						pDenseOutput->AddNode(time, derivatives, rates);
+					}
+				}
+				else if constexpr (IsStageUsed<Tableau>(s))
+				{
+					std::array<T, N>& estimate = estimates[s];
+					Unroll<s>([&](auto previous)
+					{
+						constexpr unsigned int j = decltype(previous)::value;
+						if constexpr (Tableau::a[s][j] != 0)
+						{
+							const Scalar scale = static_cast<Scalar>(Tableau::a[s][j]) * stepSize;
+							for (unsigned int i = 0; i < N; ++i)
+							{
+								if constexpr (j == GetFirstDependency<Tableau>(s))
+									estimate[i] = derivatives[i] + rate(previous, i) * scale;
+								else
+									estimate[i] = estimate[i] + rate(previous, i) * scale;
+							}
+						}
+					});
+					nthDerivatives[s] = state.GetNthDerivative(estimate);
+				}
+			});
+
+			for (unsigned int i = 0; i < N; ++i)
+			{
+				if constexpr (Tableau::weightScale == 1)
+					derivatives[i] += WeightedSum<Tableau, T>(rate, i) * stepSize;
+				else
+					derivatives[i] += WeightedSum<Tableau, T>(rate, i) * static_cast<Scalar>(Tableau::weightScale) * stepSize;
+			}
+
+			state.SetDerivatives(derivatives);
+		}
+	};
+
+
+	// Explicit Runge-Kutta step for any tableau above.  Every stage and coefficient loop is unrolled at
+	// compile time so the generated code matches a hand written method for the same tableau.
+	template<typename Tableau, typename T, unsigned int N, typename State = IState<T, N>>
+	void ExplicitRungeKutta(State& state, ScalarType<T> stepSize)
+	{
+		Detail::ExplicitRungeKuttaStep<Tableau, T, N, false>(state, stepSize, nullptr, ScalarType<T>(0));
+	}
+
+
+	// as above but also adds the state at the start of the step to the dense output, reusing the first stage as its rates
+	template<typename Tableau, typename T, unsigned int N, typename State = IState<T, N>>
+	void ExplicitRungeKuttaDense(State& state, ScalarType<T> stepSize, DenseOutput<T, N>& denseOutput, ScalarType<T> time)
+	{
+		Detail::ExplicitRungeKuttaStep<Tableau, T, N, true>(state, stepSize, &denseOutput, time);
+	}
+
+
+	template<typename Tableau, typename T, typename State = IState<T, 2>>
+	void RungeKuttaNystrom(State& state, ScalarType<T> stepSize)
+	{
+		typedef ScalarType<T> Scalar;
+
+		std::array<T, 2> derivatives;
+		state.GetDerivatives(derivatives);
+
+		const Scalar stepSizeSquared = stepSize * stepSize;
+
+		std::array<T, Tableau::numStages> k;
+		Detail::Unroll<Tableau::numStages>([&](auto stage)
+		{
+			constexpr unsigned int s = decltype(stage)::value;
+			if constexpr (s == 0)
+			{
+				k[0] = state.GetNthDerivative(derivatives);
+			}
+			else
+			{
+				std::array<T, 2> estimate;
+				estimate[0] = derivatives[0] + derivatives[1] * (static_cast<Scalar>(Tableau::c[s]) * stepSize);
+				estimate[1] = derivatives[1];
+				Detail::Unroll<s>([&](auto previous)
+				{
+					constexpr unsigned int j = decltype(previous)::value;
+					if constexpr (Tableau::aBar[s][j] != 0)
+						estimate[0] = estimate[0] + k[j] * (static_cast<Scalar>(Tableau::aBar[s][j]) * stepSizeSquared);
+					if constexpr (Tableau::a[s][j] != 0)
+						estimate[1] = estimate[1] + k[j] * (static_cast<Scalar>(Tableau::a[s][j]) * stepSize);
+				});
+				k[s] = state.GetNthDerivative(estimate);
+			}
+		});
+
+		T position = derivatives[0] + derivatives[1] * stepSize;
+		T speed = derivatives[1];
+		Detail::Unroll<Tableau::numStages>([&](auto stage)
+		{
+			constexpr unsigned int s = decltype(stage)::value;
+			if constexpr (Tableau::bBar[s] != 0)
+				position = position + k[s] * (static_cast<Scalar>(Tableau::bBar[s]) * stepSizeSquared);
+			if constexpr (Tableau::b[s] != 0)
+				speed = speed + k[s] * (static_cast<Scalar>(Tableau::b[s]) * stepSize);
+		});
+
+		derivatives[0] = position;
+		derivatives[1] = speed;
+		state.SetDerivatives(derivatives);
+	}
+};
\ No newline at end of file
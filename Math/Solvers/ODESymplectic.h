@@ -0,0 +1,144 @@
+#pragma once
+
+
+#include "Solvers/ODE.h"
+#include "Solvers/ODERungeKutta.h"
+#include <array>
+
+
+
+namespace ODE
+{
+	// Splitting methods for 2nd order systems whose force only depends on position.  A step alternates
+	// drifts, which move the position with the current speed, and kicks, which change the speed by the force
+	// at the current position.  Each drift and kick is an exact symplectic map on its own, so any sequence of
+	// them is symplectic and energy errors stay bounded rather than drifting over long runs.  Every step
+	// starts and ends with a drift so drift has one more coefficient than kick, and zero drifts are skipped
+	// at compile time.  Like the Butcher tableaus the coefficients are rounded once to the scalar type.
+
+	// Forest-Ruth, the same method as Ruth4 in ODE.h expressed as a splitting table
+	struct ForestRuth4
+	{
+		static constexpr unsigned int numKicks = 3;
+		static constexpr long double theta = 1.0L / (2.0L - 1.2599210498948731647672106L);
+		static constexpr long double drift[numKicks + 1] = { 0.5L * theta, 0.5L * (1.0L - theta), 0.5L * (1.0L - theta), 0.5L * theta };
+		static constexpr long double kick[numKicks] = { theta, 1.0L - 2.0L * theta, theta };
+	};
+
+
+	// position extended Forest-Ruth like method of Omelyan, Mryglod and Folk, one more force evaluation
+	// than Forest-Ruth buys an error constant around a hundred times smaller
+	struct PEFRL4
+	{
+		static constexpr unsigned int numKicks = 4;
+		static constexpr long double xi = 0.1786178958448091L;
+		static constexpr long double lambda = -0.2123418310626054L;
+		static constexpr long double chi = -0.06626458266981849L;
+		static constexpr long double drift[numKicks + 1] = { xi, chi, 1.0L - 2.0L * (chi + xi), chi, xi };
+		static constexpr long double kick[numKicks] = { 0.5L * (1.0L - 2.0L * lambda), lambda, lambda, 0.5L * (1.0L - 2.0L * lambda) };
+	};
+
+
+	// Blanes and Moan's optimised 6 stage 4th order partitioned method
+	struct BlanesMoan4
+	{
+		static constexpr unsigned int numKicks = 6;
+		static constexpr long double a1 = 0.0792036964311957L;
+		static constexpr long double a2 = 0.353172906049774L;
+		static constexpr long double a3 = -0.0420650803577195L;
+		static constexpr long double a4 = 1.0L - 2.0L * (a1 + a2 + a3);
+		static constexpr long double b1 = 0.209515106613362L;
+		static constexpr long double b2 = -0.143851773179818L;
+		static constexpr long double b3 = 0.5L - (b1 + b2);
+		static constexpr long double drift[numKicks + 1] = { a1, a2, a3, a4, a3, a2, a1 };
+		static constexpr long double kick[numKicks] = { b1, b2, b3, b3, b2, b1 };
+	};
+
+
+	// Symmetric compositions of the leapfrog step, where each leapfrog is taken with the step size scaled
+	// by the next weight.  Yoshida's solutions A (6th order) and D (8th order).
+	struct Yoshida6
+	{
+		static constexpr unsigned int numSubSteps = 7;
+		static constexpr long double w1 = -1.17767998417887L;
+		static constexpr long double w2 = 0.235573213359357L;
+		static constexpr long double w3 = 0.784513610477560L;
+		static constexpr long double w0 = 1.0L - 2.0L * (w1 + w2 + w3);
+		static constexpr long double weights[numSubSteps] = { w3, w2, w1, w0, w1, w2, w3 };
+	};
+
+
+	struct Yoshida8
+	{
+		static constexpr unsigned int numSubSteps = 15;
+		static constexpr long double w1 = 0.102799849391985L;
+		static constexpr long double w2 = -1.96061023297549L;
+		static constexpr long double w3 = 1.93813913762276L;
+		static constexpr long double w4 = -0.158240635368243L;
+		static constexpr long double w5 = -1.44485223686048L;
+		static constexpr long double w6 = 0.253693336566229L;
+		static constexpr long double w7 = 0.914844246229740L;
+		static constexpr long double w0 = 1.0L - 2.0L * (w1 + w2 + w3 + w4 + w5 + w6 + w7);
+		static constexpr long double weights[numSubSteps] = { w7, w6, w5, w4, w3, w2, w1, w0, w1, w2, w3, w4, w5, w6, w7 };
+	};
+
+
+	namespace Detail
+	{
+		template<typename Composition>
+		constexpr std::array<long double, Composition::numSubSteps + 1> MakeLeapfrogDrifts()
+		{
+			// the closing half drift of each leapfrog merges with the opening half drift of the next
+			std::array<long double, Composition::numSubSteps + 1> drift = {};
+			for (unsigned int i = 0; i < Composition::numSubSteps; ++i)
+			{
+				drift[i] += 0.5L * Composition::weights[i];
+				drift[i + 1] += 0.5L * Composition::weights[i];
+			}
+			return drift;
+		}
+
+		template<typename Composition>
+		constexpr std::array<long double, Composition::numSubSteps> MakeLeapfrogKicks()
+		{
+			std::array<long double, Composition::numSubSteps> kick = {};
+			for (unsigned int i = 0; i < Composition::numSubSteps; ++i)
+				kick[i] = Composition::weights[i];
+			return kick;
+		}
+	};
+
+
+	// turns a leapfrog composition into the splitting table the engine below runs, so a composition of s
+	// leapfrogs costs s force evaluations rather than 2s
+	template<typename Composition>
+	struct LeapfrogComposition
+	{
+		static constexpr unsigned int numKicks = Composition::numSubSteps;
+		static constexpr std::array<long double, numKicks + 1> drift = Detail::MakeLeapfrogDrifts<Composition>();
+		static constexpr std::array<long double, numKicks> kick = Detail::MakeLeapfrogKicks<Composition>();
+	};
+
+
+	template<typename Splitting, typename T, typename State = IState<T, 2>>
+	void SymplecticSplitting(State& state, ScalarType<T> stepSize)
+	{
+		typedef ScalarType<T> Scalar;
+
+		std::array<T, 2> derivatives;
+		state.GetDerivatives(derivatives);
+
+		if constexpr (Splitting::drift[0] != 0)
+			derivatives[0] += derivatives[1] * (static_cast<Scalar>(Splitting::drift[0]) * stepSize);
+
+		Detail::Unroll<Splitting::numKicks>([&](auto kick)
+		{
+			constexpr unsigned int i = decltype(kick)::value;
+			derivatives[1] += state.GetNthDerivative(derivatives) * (static_cast<Scalar>(Splitting::kick[i]) * stepSize);
+			if constexpr (Splitting::drift[i + 1] != 0)
+				derivatives[0] += derivatives[1] * (static_cast<Scalar>(Splitting::drift[i + 1]) * stepSize);
+		});
+
+		state.SetDerivatives(derivatives);
+	}
+};
\ No newline at end of file
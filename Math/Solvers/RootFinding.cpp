@@ -41,6 +41,44 @@ namespace RootFinding
 	}
 
 
+	Result<1> NewtonRaphson(float x, std::function<AutoDiff::Dual<float, 1>(const AutoDiff::Dual<float, 1>& value)> g, float errorTolerance, unsigned int maxIterations)
+	{
+		float y = x;
+		unsigned int numIterations = 0;
+
+		while (++numIterations <= maxIterations)
+		{
+			const float yPrev = y;
+			const AutoDiff::Dual<float, 1> gy = g(AutoDiff::Dual<float, 1>(y, 0));
+			const float divisor = gy.m_tangents[0];
+
+			constexpr float epsilon = 1.0e-7f;
+			if (fabsf(divisor) < epsilon)
+			{
+				Result<1> result;
+				result.AddError(EError::ZeroDivisor);
+				return result;
+			}
+
+			y -= gy.m_value / divisor;
+
+			if (fabsf(y - yPrev) < errorTolerance)
+			{
+				Result<1> result;
+				result.AddValue(y);
+				result.m_numValues = 1;
+				return result;
+			}
+		}
+
+		Result<1> result;
+		result.AddValue(y);
+		result.m_numValues = 1;
+		result.AddError(EError::MaxIterationsReached);
+		return result;
+	}
+
+
 	Result<1> Secant(float x0, float x1, std::function<float(const float& value)> g0, float errorTolerance, unsigned int maxIterations)
 	{
 		float y0 = x0;
@@ -118,21 +156,15 @@ namespace RootFinding
 	{
 		Result<3> result;
 
-		// find first root using iterative solver
-		const auto g0 = [a, b, c, d](const float& t) -> float
+		// find first root using iterative solver, the slope comes from evaluating on a dual number
+		const auto g = [a, b, c, d](const AutoDiff::Dual<float, 1>& t) -> AutoDiff::Dual<float, 1>
 		{
-			const float t2 = t * t;
-			const float t3 = t2 * t;
+			const AutoDiff::Dual<float, 1> t2 = t * t;
+			const AutoDiff::Dual<float, 1> t3 = t2 * t;
 			return a * t3 + b * t2 + c * t + d;
 		};
 
-		const auto g1 = [a, b, c](const float& t) -> float
-		{
-			const float t2 = t * t;
-			return 3.0f * a * t2 + 2.0f * b * t + c;
-		};
-
-		const Result<1> iterativeResult = NewtonRaphson(x, g0, g1, errorTolerance, maxIterations);
+		const Result<1> iterativeResult = NewtonRaphson(x, g, errorTolerance, maxIterations);
 		result.AddError(iterativeResult.m_errorMask);
 		if (iterativeResult.m_numValues == 0)
 		{
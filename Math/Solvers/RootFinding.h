@@ -1,6 +1,7 @@
 #pragma once
 
 
+#include "Functions/Dual.h"
 #include <math.h>
 #include <functional>
 #include <array>
@@ -43,6 +44,9 @@ namespace RootFinding
 
 
 	Result<1> NewtonRaphson(float x, std::function<float(const float& value)> g0, std::function<float(const float& value)> g1, float errorTolerance, unsigned int maxIterations);
+
+	// g is evaluated on a dual number so each iteration gets the value and the exact slope from one call
+	Result<1> NewtonRaphson(float x, std::function<AutoDiff::Dual<float, 1>(const AutoDiff::Dual<float, 1>& value)> g, float errorTolerance, unsigned int maxIterations);
 	Result<1> Secant(float x0, float x1, std::function<float(const float& value)> g0, float errorTolerance, unsigned int maxIterations);
 	Result<2> Quadratic(float a, float b, float c);
 	Result<3> Cubic(float a, float b, float c, float d, float x, float errorTolerance, unsigned int maxIterations);
@@ -0,0 +1,85 @@
+#pragma once
+
+
+#include "Solvers/ODEBatch.h"
+#include <array>
+
+
+
+namespace SDE
+{
+	// Batches of stochastic systems dy = f(y) dt + g(y) dW with a single Wiener process per system, driving
+	// the highest derivative like a random force would.  The drift f is the batch's nth derivative and the
+	// diffusion g is a scalar per system, given with its slope dg/dy over the highest derivative which only
+	// Milstein uses.  Systems whose noise doesn't depend on the highest derivative can leave it at zero, and
+	// Milstein then reduces to Euler-Maruyama.
+	template<typename T, unsigned int N>
+	class IState : public ODEBatch::IState<T, N>
+	{
+	public:
+		virtual void GetDiffusions(const std::array<const T*, N>& derivatives, T* diffusions, T* diffusionSlopes) const = 0;
+	};
+
+
+	// Both methods take the Wiener increment of every system over the step, normals scaled by the square
+	// root of the step size.  Convergence with the same Wiener path is order 0.5 for Euler-Maruyama and
+	// order 1 for Milstein, or order 1 for both when the noise is additive.
+	template<typename T, unsigned int N>
+	void EulerMaruyama(IState<T, N>& state, T stepSize, const T* __restrict wienerIncrements)
+	{
+		// scratch layout: nth derivative, diffusion, diffusion slope
+		const size_t size = state.GetSize();
+		T* scratch = state.GetScratch(3);
+		T* __restrict nthDerivatives = scratch;
+		T* __restrict diffusions = scratch + size;
+		T* __restrict diffusionSlopes = scratch + 2 * size;
+
+		const std::array<const T*, N> derivatives = state.GetAllDerivatives();
+		state.GetNthDerivatives(derivatives, nthDerivatives);
+		state.GetDiffusions(derivatives, diffusions, diffusionSlopes);
+
+		for (unsigned int i = 0; i < N - 1; ++i)
+		{
+			T* __restrict lowerDerivatives = state.GetDerivatives(i);
+			const T* __restrict nextDerivatives = state.GetDerivatives(i + 1);
+			for (size_t j = 0; j < size; ++j)
+				lowerDerivatives[j] += nextDerivatives[j] * stepSize;
+		}
+
+		T* __restrict lastDerivatives = state.GetDerivatives(N - 1);
+		for (size_t j = 0; j < size; ++j)
+			lastDerivatives[j] += nthDerivatives[j] * stepSize + diffusions[j] * wienerIncrements[j];
+	}
+
+
+	template<typename T, unsigned int N>
+	void Milstein(IState<T, N>& state, T stepSize, const T* __restrict wienerIncrements)
+	{
+		const size_t size = state.GetSize();
+		T* scratch = state.GetScratch(3);
+		T* __restrict nthDerivatives = scratch;
+		T* __restrict diffusions = scratch + size;
+		T* __restrict diffusionSlopes = scratch + 2 * size;
+
+		const std::array<const T*, N> derivatives = state.GetAllDerivatives();
+		state.GetNthDerivatives(derivatives, nthDerivatives);
+		state.GetDiffusions(derivatives, diffusions, diffusionSlopes);
+
+		for (unsigned int i = 0; i < N - 1; ++i)
+		{
+			T* __restrict lowerDerivatives = state.GetDerivatives(i);
+			const T* __restrict nextDerivatives = state.GetDerivatives(i + 1);
+			for (size_t j = 0; j < size; ++j)
+				lowerDerivatives[j] += nextDerivatives[j] * stepSize;
+		}
+
+		// the Ito correction 0.5 g g' (dW^2 - h)
+		T* __restrict lastDerivatives = state.GetDerivatives(N - 1);
+		for (size_t j = 0; j < size; ++j)
+		{
+			const T wienerIncrement = wienerIncrements[j];
+			const T correction = T(0.5) * diffusions[j] * diffusionSlopes[j] * (wienerIncrement * wienerIncrement - stepSize);
+			lastDerivatives[j] += nthDerivatives[j] * stepSize + diffusions[j] * wienerIncrement + correction;
+		}
+	}
+};
\ No newline at end of file
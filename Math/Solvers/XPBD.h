@@ -0,0 +1,233 @@
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+
+
+namespace XPBD
+{
+	// Particles as structure of arrays, each array holding every x followed by every y then every z like the
+	// n-body positions.  A zero inverse mass pins a particle in place.
+	struct ParticleStore
+	{
+		std::vector<float> m_positions;
+		std::vector<float> m_prevPositions;
+		std::vector<float> m_velocities;
+		std::vector<float> m_inverseMasses;
+
+		void Resize(size_t numParticles)
+		{
+			m_positions.resize(3 * numParticles);
+			m_prevPositions.resize(3 * numParticles);
+			m_velocities.resize(3 * numParticles);
+			m_inverseMasses.resize(numParticles);
+		}
+
+		size_t GetNumParticles() const { return m_inverseMasses.size(); }
+	};
+
+
+	// Distance constraints as structure of arrays.  Colouring sorts them so that no two constraints of the
+	// same colour share a particle, which lets every constraint of a colour be projected in parallel while
+	// the colours are still swept one after the other like Gauss-Seidel.
+	struct DistanceConstraints
+	{
+		std::vector<unsigned int> m_particles0;
+		std::vector<unsigned int> m_particles1;
+		std::vector<float> m_restLengths;
+		std::vector<float> m_compliances;			// inverse stiffness, zero is rigid
+		std::vector<float> m_lambdas;				// accumulated over the iterations of a step
+		std::vector<unsigned int> m_colourOffsets;	// colour c is [m_colourOffsets[c], m_colourOffsets[c + 1])
+
+		void Add(unsigned int particle0, unsigned int particle1, float restLength, float compliance)
+		{
+			m_particles0.push_back(particle0);
+			m_particles1.push_back(particle1);
+			m_restLengths.push_back(restLength);
+			m_compliances.push_back(compliance);
+			m_lambdas.push_back(0.0f);
+			m_colourOffsets.clear();
+		}
+
+		size_t GetNumConstraints() const { return m_restLengths.size(); }
+		unsigned int GetNumColours() const { return m_colourOffsets.empty() ? 0 : static_cast<unsigned int>(m_colourOffsets.size() - 1); }
+
+		// Greedy colouring, each constraint in order takes the first colour neither of its particles has yet.
+		// The colours come out close to the most constraints any particle has, which for a cloth is a handful.
+		unsigned int Colour(size_t numParticles)
+		{
+			const size_t numConstraints = GetNumConstraints();
+			std::vector<std::vector<uint8_t>> isParticleUsed;
+			std::vector<unsigned int> colours(numConstraints);
+			std::vector<unsigned int> numColourConstraints;
+			for (size_t i = 0; i < numConstraints; ++i)
+			{
+				unsigned int colour = 0;
+				while (colour < isParticleUsed.size() && (isParticleUsed[colour][m_particles0[i]] || isParticleUsed[colour][m_particles1[i]]))
+					++colour;
+
+				if (colour == isParticleUsed.size())
+				{
+					isParticleUsed.emplace_back(numParticles, uint8_t(0));
+					numColourConstraints.push_back(0);
+				}
+
+				isParticleUsed[colour][m_particles0[i]] = 1;
+				isParticleUsed[colour][m_particles1[i]] = 1;
+				colours[i] = colour;
+				++numColourConstraints[colour];
+			}
+
+			m_colourOffsets.assign(numColourConstraints.size() + 1, 0);
+			for (size_t colour = 0; colour < numColourConstraints.size(); ++colour)
+				m_colourOffsets[colour + 1] = m_colourOffsets[colour] + numColourConstraints[colour];
+
+			// a counting sort by colour keeps the order within each colour
+			std::vector<unsigned int> order(numConstraints);
+			std::vector<unsigned int> next(m_colourOffsets.begin(), m_colourOffsets.end() - 1);
+			for (size_t i = 0; i < numConstraints; ++i)
+				order[next[colours[i]]++] = static_cast<unsigned int>(i);
+
+			const auto permute = [&order](auto& values)
+			{
+				auto sorted = values;
+				for (size_t i = 0; i < order.size(); ++i)
+					sorted[i] = values[order[i]];
+				values.swap(sorted);
+			};
+			permute(m_particles0);
+			permute(m_particles1);
+			permute(m_restLengths);
+			permute(m_compliances);
+			permute(m_lambdas);
+
+			return GetNumColours();
+		}
+	};
+
+
+	struct Settings
+	{
+		unsigned int m_numSubSteps = 1;
+		unsigned int m_numIterations = 8;			// projections of every constraint per substep
+		std::array<float, 3> m_gravity = { 0.0f, -9.81f, 0.0f };
+		float m_damping = 0.0f;						// fraction of the velocity lost per second
+		unsigned int m_blockSize = 256;				// constraints of a colour given to the parallel loop at a time
+	};
+
+
+	// runs func for every index on the calling thread, for when there's no thread pool
+	struct SerialFor
+	{
+		template<typename Func>
+		void operator () (size_t count, const Func& func) const
+		{
+			for (size_t i = 0; i < count; ++i)
+				func(i);
+		}
+	};
+
+
+	// Projects one distance constraint with its compliance scaled by the squared step size, which is what
+	// makes the stiffness independent of the step and the iteration count.
+	inline void ProjectDistance(DistanceConstraints& constraints, size_t index, const float* __restrict inverseMasses, float* __restrict x, float* __restrict y,
+		float* __restrict z, float inverseStepSizeSquared)
+	{
+		const unsigned int particle0 = constraints.m_particles0[index];
+		const unsigned int particle1 = constraints.m_particles1[index];
+		const float weight0 = inverseMasses[particle0];
+		const float weight1 = inverseMasses[particle1];
+
+		const float dx = x[particle1] - x[particle0];
+		const float dy = y[particle1] - y[particle0];
+		const float dz = z[particle1] - z[particle0];
+		const float length = sqrtf(dx * dx + dy * dy + dz * dz);
+		const float scaledCompliance = constraints.m_compliances[index] * inverseStepSizeSquared;
+		const float weight = weight0 + weight1 + scaledCompliance;
+		if (length < 1.0e-9f || weight <= 0.0f)
+			return;
+
+		float& lambda = constraints.m_lambdas[index];
+		const float deltaLambda = (constraints.m_restLengths[index] - length - scaledCompliance * lambda) / weight;
+		lambda += deltaLambda;
+
+		const float scale = deltaLambda / length;
+		x[particle0] -= weight0 * scale * dx;
+		y[particle0] -= weight0 * scale * dy;
+		z[particle0] -= weight0 * scale * dz;
+		x[particle1] += weight1 * scale * dx;
+		y[particle1] += weight1 * scale * dy;
+		z[particle1] += weight1 * scale * dz;
+	}
+
+
+	// Extended position based dynamics, Macklin, Muller & Chentanez 2016.  Every substep predicts the
+	// positions from the velocities and gravity, projects the constraints onto them colour by colour and
+	// takes the velocities from how far the particles moved.  The projection is stable at any step size, a
+	// stiff constraint given too few iterations just stretches more.  Constraints added since they were last
+	// coloured are coloured here, which reorders them.  The parallel loop is called as
+	// parallelFor(count, func), running func(index) for every index in [0, count) before it returns.
+	template<typename ParallelFor>
+	void Step(ParticleStore& particles, DistanceConstraints& constraints, float stepSize, const Settings& settings, const ParallelFor& parallelFor)
+	{
+		const size_t numParticles = particles.GetNumParticles();
+		if (constraints.GetNumColours() == 0 && constraints.GetNumConstraints() > 0)
+			constraints.Colour(numParticles);
+
+		const unsigned int numSubSteps = std::max(settings.m_numSubSteps, 1u);
+		const float subStepSize = stepSize / numSubSteps;
+		const float inverseSubStepSize = 1.0f / subStepSize;
+		const float inverseStepSizeSquared = inverseSubStepSize * inverseSubStepSize;
+		const float dampingScale = std::max(1.0f - settings.m_damping * subStepSize, 0.0f);
+		const unsigned int blockSize = std::max(settings.m_blockSize, 1u);
+
+		const float* __restrict inverseMasses = particles.m_inverseMasses.data();
+		float* __restrict positions = particles.m_positions.data();
+		float* __restrict prevPositions = particles.m_prevPositions.data();
+		float* __restrict velocities = particles.m_velocities.data();
+		float* x = positions;
+		float* y = positions + numParticles;
+		float* z = positions + 2 * numParticles;
+
+		for (unsigned int subStep = 0; subStep < numSubSteps; ++subStep)
+		{
+			for (unsigned int axis = 0; axis < 3; ++axis)
+			{
+				const size_t offset = axis * numParticles;
+				const float gravity = settings.m_gravity[axis] * subStepSize;
+				for (size_t i = 0; i < numParticles; ++i)
+				{
+					const float velocity = (inverseMasses[i] > 0.0f) ? velocities[offset + i] + gravity : 0.0f;
+					velocities[offset + i] = velocity;
+					prevPositions[offset + i] = positions[offset + i];
+					positions[offset + i] += velocity * subStepSize;
+				}
+			}
+
+			std::fill(constraints.m_lambdas.begin(), constraints.m_lambdas.end(), 0.0f);
+			for (unsigned int iteration = 0; iteration < settings.m_numIterations; ++iteration)
+			{
+				for (unsigned int colour = 0; colour < constraints.GetNumColours(); ++colour)
+				{
+					const size_t begin = constraints.m_colourOffsets[colour];
+					const size_t end = constraints.m_colourOffsets[colour + 1];
+					parallelFor((end - begin + blockSize - 1) / blockSize, [&](size_t block)
+					{
+						const size_t blockEnd = std::min(begin + (block + 1) * blockSize, end);
+						for (size_t i = begin + block * blockSize; i < blockEnd; ++i)
+							ProjectDistance(constraints, i, inverseMasses, x, y, z, inverseStepSizeSquared);
+					});
+				}
+			}
+
+			for (size_t i = 0; i < 3 * numParticles; ++i)
+				velocities[i] = (positions[i] - prevPositions[i]) * inverseSubStepSize * dampingScale;
+		}
+	}
+};
\ No newline at end of file